@@ -47,6 +47,7 @@ set(COMMON_HEADERS
   ${COMMON_HEADERS_PATH}/emu_log.h
 
   ${COMMON_HEADERS_PATH}/emu_platform.h
+  ${COMMON_HEADERS_PATH}/emu_sched.h
 
 
   ${COMMON_HEADERS_PATH}/emu_cfg.h
@@ -77,9 +77,6 @@ void Param::addToRegistry() {
     getCfgParamsRegistry ().emplace_back(this);
 }
 
-constexpr bool kFibersEnabled =
-    false;
-
 #define CFG_PARAM(n,...)\
     GFX_EMU_API GfxEmu::Cfg::Param& n () { static auto& p_ = *(new GfxEmu::Cfg::Param {__VA_ARGS__}); return p_; }
 #include <emu_cfg_params.h>
@@ -19,6 +19,7 @@ SPDX-License-Identifier: MIT
 #include "emu_utils.h"
 #include "emu_api_export.h"
 #include "emu_cfg_platform.h"
+#include "emu_sched.h"
 
 namespace GfxEmu {
 
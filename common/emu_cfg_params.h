@@ -111,6 +111,102 @@ CFG_PARAM( ResidentGroups,
     "resident groups number must be > 0"
 );
 
+CFG_PARAM( PooledThreads,
+    "pooled work-item threads",
+    "in threads scheduling mode, take work-item OS threads from the process-wide worker pool "
+    "instead of starting a new thread for every work-item",
+    {"CM_RT_POOLED_THREADS","--emu-pooled-threads"},
+    false
+);
+
+CFG_PARAM( SchedMode,
+    "work-items scheduling mode",
+    "threads: every work-item is an OS thread; "
+    "fibers: work-items are user-mode fibers multiplexed over a fixed set of worker OS threads; "
+    "auto: work-items run as a parallel loop; a work-group reaching a group synchronization, SLM call "
+    "or yield is finished as fibers, with no work-item run twice",
+    {"CM_RT_SCHED_MODE","--emu-sched-mode"},
+    "threads",
+    [](auto& p) {
+        p.set(GfxEmu::Utils::toLower(p.getStr ()));
+        const auto it = GfxEmu::Sched::StaticData_nameToInt ().find(GfxEmu::Utils::toUpper(p.getStr ()));
+        if(it == GfxEmu::Sched::StaticData_nameToInt ().end ()) {
+            GFX_EMU_FAIL_WITH_MESSAGE(fCfg, "scheduling mode \"%s\" is not known.\n",
+                p.getStr().c_str()
+            );
+        }
+        p.setSubValue(it->second);
+        return true;
+    },
+    "specified scheduling mode is unknown"
+);
+
+CFG_PARAM( ParallelForKernels,
+    "parallel-for kernels",
+    "regex matching names of kernels to try in parallel-for mode in any scheduling mode",
+    {"CM_RT_PARALLEL_FOR_KERNELS","--emu-parallel-for-kernels"},
+    ""
+);
+
+CFG_PARAM( FiberStackSize,
+    "fiber stack size",
+    "stack size in bytes reserved for every work-item in fibers scheduling mode",
+    {"CM_RT_FIBER_STACK_SIZE","--emu-fiber-stack-size"},
+    8 << 20,
+    [](auto& p) {return p.getInt() >= (64 << 10);},
+    "fiber stack size must be >= 64K"
+);
+
+CFG_PARAM( AsyncQueue,
+    "asynchronous queue",
+    "return from kernel enqueue calls right away and run tasks on a per-queue executor thread",
+    {"CM_RT_ASYNC_QUEUE","--emu-async-queue"},
+    false
+);
+
+CFG_PARAM( SurfacePoolSize,
+    "surface memory pool size",
+    "how many bytes of host memory of destroyed surfaces shall be kept for reuse by new surfaces; "
+    "0 disables the reuse",
+    {"CM_RT_SURFACE_POOL_SIZE","--emu-surface-pool-size"},
+    256 << 20,
+    [](auto& p) {return p.getInt() >= 0;},
+    "surface pool size must be >= 0"
+);
+
+CFG_PARAM( HugePages,
+    "huge pages for surfaces",
+    "off: surfaces use default pages; "
+    "transparent: surfaces of the huge pages threshold size and more use transparent huge pages; "
+    "explicit: such surfaces use reserved huge pages, then transparent ones when none are available",
+    {"CM_RT_HUGE_PAGES","--emu-huge-pages"},
+    "off",
+    [](auto& p) {
+        p.set(GfxEmu::Utils::toLower(p.getStr ()));
+        return p.getStr () == "off" || p.getStr () == "transparent" || p.getStr () == "explicit";
+    },
+    "huge pages mode must be off, transparent or explicit"
+);
+
+CFG_PARAM( HugePagesThreshold,
+    "huge pages threshold",
+    "size in bytes from which surfaces use huge pages, at least 2MB",
+    {"CM_RT_HUGE_PAGES_THRESHOLD","--emu-huge-pages-threshold"},
+    32 << 20,
+    [](auto& p) {return p.getInt() >= 0;},
+    "huge pages threshold must be >= 0"
+);
+
+CFG_PARAM( SurfaceTableSize,
+    "surface table size",
+    "how many buffers, 2D surfaces, 3D surfaces and 2D UP surfaces each a device can hold; "
+    "0 keeps the hardware binding table sizes",
+    {"CM_RT_SURFACE_TABLE_SIZE","--emu-surface-table-size"},
+    0,
+    [](auto& p) {return p.getInt() >= 0 && p.getInt() <= (1 << 16);},
+    "surface table size must be in [0, 65536]"
+);
+
 CFG_PARAM( RetainTmpFiles,
     "retain tmp files",
     "retain tmp files",
@@ -117,6 +117,18 @@ public:
         return false;
     }
 
+    // Copy with its own value buffer, unaffected by later setValueFrom calls
+    // on this argument. Plain copies share the buffer.
+    KernelArg clone () const {
+        KernelArg copy {*this};
+        if (m_bufPtr) {
+            const auto size = m_unitCount * m_unitAlignedSize;
+            copy.m_bufPtr.reset (std::malloc(size), std::free);
+            std::memcpy(copy.m_bufPtr.get (), m_bufPtr.get (), size);
+        }
+        return copy;
+    }
+
     void annotate (const GfxEmu::DbgSymb::SymbDesc& s) {
         isClass = s.isClass;
         isFloat = s.isFloat;
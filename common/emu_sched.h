@@ -0,0 +1,35 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2021 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#pragma once
+#include <map>
+#include <string>
+
+namespace GfxEmu {
+namespace Sched {
+#define MAP(name, enumName) {#name, enumName :: name}
+
+// Work-items scheduling modes, see README_CONFIG.md.
+enum Mode {
+    THREADS = 0,
+    FIBERS = 1,
+    AUTO = 2, // Parallel-for with fall back to FIBERS on group synchronization.
+};
+
+inline std::map<std::string, int64_t>& StaticData_nameToInt() {
+    static std::map<std::string, int64_t> nameToInt = {{
+        MAP(THREADS, GfxEmu::Sched),
+        MAP(FIBERS, GfxEmu::Sched),
+        MAP(AUTO, GfxEmu::Sched)
+    }};
+    return nameToInt;
+};
+
+#undef MAP
+}; // namespace Sched
+}; // namespace GfxEmu
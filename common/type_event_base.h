@@ -32,8 +32,9 @@ public:
     //!             CM_STATUS_STARTED means hardware starts to execute the task.
     //!             CM_STATUS_FINISHED means hardware has finished the
     //!             execution of all kernels in the task. In Emulation
-    //!             mode since the Enqueue operation is a blocking call, this
-    //!             function always returns CM_STATUS_FINISHED.
+    //!             mode the Enqueue operation is a blocking call, and this
+    //!             function returns CM_STATUS_FINISHED, unless the queue is
+    //!             asynchronous (CM_RT_ASYNC_QUEUE).
     //! \retval     CM_SUCCESS if the status is successfully returned.
     //! \retval     CM_FAILURE if otherwise.
     //!
@@ -48,7 +49,7 @@ public:
     //!             CmEvent::WaitForTaskFinished in practice when you try to
     //!             get GPU HW execution time. This is a non-blocking call.
     //!             In Emulation
-    //!             mode this function always returns 100.
+    //!             mode this is the host time the task took to run.
     //! \param      [out] time
     //!             Reference to time.
     //! \retval     CM_SUCCESS if the execution time is successfully returned.
@@ -71,4 +71,5 @@ SPDX-License-Identifier: MIT
 #include "cm_slm_user.h"
 #include "cm_printf_device.h"
 #include "cm_color.h"
+#include "cm_kernel_invoker.h"
 #endif /* CM_H */
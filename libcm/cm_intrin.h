@@ -3966,10 +3966,10 @@ read_local(SurfaceIndex & buf_id, int x_pos, int y_pos, int block_width, int blo
     uint offset;
 
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-        CmEmulSys::search_buffer(buf_id.get_data() & 0xFF);
+        CmEmulSys::search_buffer(buf_id.get_data());
 
     if (buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data() & 0xFF, buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -3978,7 +3978,7 @@ read_local(SurfaceIndex & buf_id, int x_pos, int y_pos, int block_width, int blo
 
     int x_pos_a, y_pos_a;  /* Actual positions */
     int sizeofT = sizeof(T); /* Make this into a signed integer */
-    uint bpp = CM_genx_bytes_per_pixel(buff_iter->pixelFormat);
+    uint bpp = buff_iter->bpp;
     uint block_width_in_bytes = block_width * data_size * num_block;
     assert(((bpp - 1) & bpp) == 0); // Is power-of-2 number
     assert(bpp <= 4);
@@ -5564,7 +5564,6 @@ cm_svm_atomic_internal(CmAtomicOpType op, vector<uint64_t,N> &v_Addr,
 
     int    i;
     uint   *uintPtr;
-    int    *intPtr;
 
     // InitializeCriticalSection(&dataport_cs);
 
@@ -5573,47 +5572,26 @@ cm_svm_atomic_internal(CmAtomicOpType op, vector<uint64_t,N> &v_Addr,
         SIMDCF_ELEMENT_SKIP(i);
 
         uintPtr    = (uint *)v_Addr(i);
-        intPtr     = (int *)uintPtr;
-        v_Dst(i)   = *uintPtr;
 
         // To Do: How to handle out-of-bound accesses to SVM for atomic writes?
 
         switch (op) {
             case ATOMIC_AND:
-                *uintPtr = *uintPtr & v_Src0(i);
-                break;
             case ATOMIC_OR:
-                *uintPtr = *uintPtr | v_Src0(i);
-                break;
             case ATOMIC_XOR:
-                *uintPtr = *uintPtr ^ v_Src0(i);
-                break;
             case ATOMIC_INC:
-                *uintPtr = *uintPtr + 1;
-                break;
             case ATOMIC_DEC:
-                *uintPtr = *uintPtr - 1;
-                break;
             case ATOMIC_ADD:
-                *uintPtr = *uintPtr + (uint) v_Src0(i);
-                break;
             case ATOMIC_SUB:
-                *uintPtr = *uintPtr - (uint) v_Src0(i);
-                break;
             case ATOMIC_MAXSINT:
-                *intPtr = (*intPtr > (int) v_Src0(i)) ? *intPtr : (int) v_Src0(i);
-                break;
             case ATOMIC_MINSINT:
-                *intPtr = (*intPtr > (int) v_Src0(i)) ? (int) v_Src0(i) : *intPtr;
-                break;
             case ATOMIC_MAX:
-                *uintPtr = (*uintPtr > (uint) v_Src0(i)) ? *uintPtr : (uint) v_Src0(i);
-                break;
             case ATOMIC_MIN:
-                *uintPtr = (*uintPtr < (uint) v_Src0(i)) ? *uintPtr : (uint) v_Src0(i);
+                v_Dst(i) = CM_genx_atomic_apply(op, uintPtr, (uint) v_Src0(i), 0u, 0);
                 break;
             case ATOMIC_CMPXCHG:
-                *uintPtr = (*uintPtr == (uint) v_Src0(i)) ? (uint) v_Src1(i) : *uintPtr;
+                // SVM compares against src0 and writes src1
+                v_Dst(i) = CM_genx_atomic_apply(op, uintPtr, (uint) v_Src1(i), (uint) v_Src0(i), 0);
                 break;
             default:
                 GFX_EMU_ERROR_MESSAGE("writing SVM: invalid opcode for SVM atomic write!\n");
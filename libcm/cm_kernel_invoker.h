@@ -0,0 +1,75 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2021 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#pragma once
+#ifndef CM_KERNEL_INVOKER_H
+#define CM_KERNEL_INVOKER_H
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "cm_common_macros.h"
+
+// Statically typed kernel invokers. A kernel registered with
+// CM_EMU_REGISTER_KERNEL(kernel) is called by the emulator through a
+// compiler-generated trampoline instead of libffi:
+//
+//   _GENX_MAIN_ void my_kernel(SurfaceIndex in, SurfaceIndex out, int n) {...}
+//   CM_EMU_REGISTER_KERNEL(my_kernel)
+
+namespace cmrt
+{
+
+// Calls kernel with arguments unpacked from argValues[i], each pointing to
+// the value of i-th argument.
+using CmEmuKernelInvoker = void(*)(void(*kernel)(), void* const* argValues);
+
+CM_API void register_kernel_invoker(
+    void(*kernel)(),
+    CmEmuKernelInvoker invoker,
+    const size_t* argSizes,
+    size_t argsCount);
+
+namespace details
+{
+template<class... Args, size_t... I>
+CM_INLINE void invoke_kernel(void(*kernel)(Args...), void* const* argValues, std::index_sequence<I...>)
+{
+    kernel(*static_cast<std::remove_cv_t<std::remove_reference_t<Args>>*>(argValues[I])...);
+}
+
+template<class... Args>
+void kernel_invoker(void(*kernel)(), void* const* argValues)
+{
+    invoke_kernel(reinterpret_cast<void(*)(Args...)>(kernel), argValues, std::index_sequence_for<Args...>{});
+}
+}
+
+template<class... Args>
+bool register_kernel(void(*kernel)(Args...))
+{
+    static const size_t argSizes[] = {sizeof(std::remove_reference_t<Args>)..., 0};
+    register_kernel_invoker(
+        reinterpret_cast<void(*)()>(kernel),
+        &details::kernel_invoker<Args...>,
+        argSizes,
+        sizeof...(Args));
+    return true;
+}
+
+}  // namespace cmrt
+
+#define CM_EMU_KERNEL_INVOKER_CONCAT_(a, b) a##b
+#define CM_EMU_KERNEL_INVOKER_CONCAT(a, b) CM_EMU_KERNEL_INVOKER_CONCAT_(a, b)
+
+#define CM_EMU_REGISTER_KERNEL(kernel) \
+    static const bool CM_EMU_KERNEL_INVOKER_CONCAT(cm_emu_kernel_registered_, __LINE__) = \
+        cmrt::register_kernel(&kernel);
+
+#endif /* CM_KERNEL_INVOKER_H */
@@ -554,7 +554,7 @@ auto cm_emu_load(SurfaceIndex Idx,
   if constexpr(BFT == EmuBufferType::UGM)
   {
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-        CmEmulSys::search_buffer(Idx.get_data()&0xFF);
+        CmEmulSys::search_buffer(Idx.get_data());
     assert(buff_iter->height == 1);
     buff = (char*) buff_iter->p_volatile;
     bufByteWidth = buff_iter->width;
@@ -906,7 +906,7 @@ void cm_emu_store(SurfaceIndex Idx,
   if constexpr (BFT == EmuBufferType::UGM)
   {
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-        CmEmulSys::search_buffer(Idx.get_data() & 0xFF);
+        CmEmulSys::search_buffer(Idx.get_data());
     assert(buff_iter->height == 1);
     buff = (char*)buff_iter->p_volatile;
     bufByteWidth = buff_iter->width;
@@ -1943,7 +1943,7 @@ cm_emu_atomic_zero_src(SurfaceIndex Idx,
   if constexpr (BFT == EmuBufferType::UGM)
   {
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-        CmEmulSys::search_buffer(Idx.get_data() & 0xFF);
+        CmEmulSys::search_buffer(Idx.get_data());
     assert(buff_iter->height == 1);
     buff = (char*)buff_iter->p_volatile;
     bufByteWidth = buff_iter->width;
@@ -2041,7 +2041,7 @@ cm_emu_atomic_single_src(SurfaceIndex Idx,
   if constexpr (BFT == EmuBufferType::UGM)
   {
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-        CmEmulSys::search_buffer(Idx.get_data() & 0xFF);
+        CmEmulSys::search_buffer(Idx.get_data());
     assert(buff_iter->height == 1);
     buff = (char*)buff_iter->p_volatile;
     bufByteWidth = buff_iter->width;
@@ -2240,7 +2240,7 @@ cm_emu_atomic_binary_src(SurfaceIndex Idx,
   if constexpr (BFT == EmuBufferType::UGM)
   {
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-        CmEmulSys::search_buffer(Idx.get_data() & 0xFF);
+        CmEmulSys::search_buffer(Idx.get_data());
     assert(buff_iter->height == 1);
     buff = (char*)buff_iter->p_volatile;
     bufByteWidth = buff_iter->width;
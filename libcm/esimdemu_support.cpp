@@ -120,10 +120,10 @@ ESIMD_API
 char *get_surface_base_addr(int index)
 {
   cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-    CmEmulSys::search_buffer(index & 0xFF);
+    CmEmulSys::search_buffer(index);
   if(buff_iter == CmEmulSys::iobuffers.end()) {
     GFX_EMU_FAIL_WITH_MESSAGE("reading buffer %d: buffer %d is not registered!\n",
-                              index & 0xFF, index & 0xFF);
+                              index, index);
     exit(EXIT_FAILURE);
   }
 
@@ -15,6 +15,7 @@ class CmThreadSpace;
 #define NEW_CM_RT  // Defined for new CM Runtime APIs
 #endif
 
+#include <cstring>
 #include <mutex>
 
 #include "cm_list.h"
@@ -28,7 +29,8 @@ class CmThreadSpace;
 
 #pragma warning(disable : 4244)
 
-static std::mutex mutexForWrite;
+// Serializes block accesses; one instance shared by every translation unit.
+inline std::mutex mutexForWrite;
 
 typedef enum _CmBufferType_
 {
@@ -354,11 +356,20 @@ CM_API void CM_modify_buffer_emu(SurfaceIndex buf_id, CmBufferDescField field, i
 #define CONSTANT(A)                A, GENX_CONSTANT
 #define CONSTANT_DWALIGNED(A)      A, GENX_CONSTANT_DWALIGNED
 
+/* Pixel layouts dataport accessors are specialized for */
+enum CmBufferFormatClass {
+    GENX_FORMAT_LINEAR,         /* bpp-byte pixels one after another */
+    GENX_FORMAT_YCRCB_NORMAL,   /* packed YUY2 pixel pairs */
+    GENX_FORMAT_YCRCB_SWAPY     /* packed UYVY pixel pairs */
+};
+
 namespace CmEmulSys{
 struct iobuffer {
     int id;
     CmBufferType bclass;
     CmSurfaceFormatID pixelFormat;
+    CmBufferFormatClass formatClass;    /* derived from pixelFormat at registration */
+    uint bpp;                           /* bytes per pixel of pixelFormat */
     void *p;    /* i/o datas */
     void *p_volatile;
     int width;
@@ -400,6 +411,302 @@ inline uint CM_genx_bytes_per_pixel(CmSurfaceFormatID pixelFormat)
     }
 }
 
+/*
+ * Media block fast path. A block lying fully inside the surface needs no
+ * coordinate clamping, so its rows are moved whole instead of element by
+ * element. Rows of the block are y_step surface rows apart (2 for fields).
+ */
+template <typename T, uint R, uint C>
+inline bool CM_genx_block_inside(const CmEmulSys::iobuffer &buff, int x_pos, int y_first, int y_step)
+{
+    return x_pos >= 0 && x_pos + (int)(C * sizeof(T)) <= buff.width &&
+           y_first >= 0 && y_first + (int)(R - 1) * y_step < buff.height;
+}
+
+/* Returns the address of row i of a block matrix when its elements are contiguous, else NULL. */
+template <typename T, uint R, uint C>
+inline T *CM_genx_block_row(matrix<T,R,C> &m, uint i)
+{
+    return (T *)m.get_addr(i * C);
+}
+
+template <typename T, uint R, uint C>
+inline T *CM_genx_block_row(matrix_ref<T,R,C> &m, uint i)
+{
+    return m.is_contiguous(i * C, i * C + C - 1) ? (T *)m.get_addr(i * C) : NULL;
+}
+
+template <typename T, uint R, uint C, typename M>
+inline void CM_genx_read_block_rows(M &in, const char *src, int row_pitch)
+{
+    for (uint i = 0; i < R; i++, src += row_pitch) {
+        if (T *row = CM_genx_block_row(in, i)) {
+            memcpy(row, src, C * sizeof(T));
+        } else {
+            for (uint j = 0; j < C; j++) {
+                memcpy(in.get_addr(i * C + j), src + j * sizeof(T), sizeof(T));
+            }
+        }
+    }
+}
+
+template <typename T, uint R, uint C, typename M>
+inline void CM_genx_write_block_rows(M &out, char *dst, int row_pitch)
+{
+    for (uint i = 0; i < R; i++, dst += row_pitch) {
+        if (const T *row = CM_genx_block_row(out, i)) {
+            memcpy(dst, row, C * sizeof(T));
+        } else {
+            for (uint j = 0; j < C; j++) {
+                memcpy(dst + j * sizeof(T), out.get_addr(i * C + j), sizeof(T));
+            }
+        }
+    }
+}
+
+/*
+ * Media block read of a block crossing a surface edge, clamping coordinates
+ * element by element. Instantiated per format class, so the linear variant
+ * carries none of the packed YUV handling.
+ */
+template <CmBufferFormatClass Class, typename T, uint R, uint C, typename M>
+inline void CM_genx_read_block_clamped_as(M &in, const CmEmulSys::iobuffer &buff, const char *base,
+                                          int x_pos, int y_first, int y_step, uint buf_id)
+{
+    int i,j;
+    uint offset;
+    int width = buff.width;
+    int height = buff.height;
+    int x_pos_a, y_pos_a;  /* Actual positions */
+    int sizeofT = sizeof(T); /* Make this into a signed integer */
+    uint bpp = buff.bpp;
+    assert(((bpp - 1) & bpp) == 0); // Is power-of-2 number
+
+    for (i = 0; i < R; i++) {
+        for (j = 0; j < C; j++) {
+            x_pos_a = x_pos + j * sizeof(T);
+            y_pos_a = y_first + i * y_step;
+            // We should check the boundary condition based on sizeof(T), x_pos_a is 0-based
+            // Note: Use a signed variable; otherwise sizeof(T) is unsigned
+            if ((x_pos_a + sizeofT) > width) {
+                // If we're trying to read outside the boundary, limit the value of x_pos_a
+                // At most x_pos_a+sizeof(T) is exactly at the boundary.
+                x_pos_a = width;
+            }
+            if (y_pos_a > height - 1) {
+                y_pos_a = height - 1;
+            }
+            if (y_pos_a < 0) {
+                y_pos_a = 0;
+            }
+
+            // Surface width can be less than bpp and coordinates can be negative
+            if (Class != GENX_FORMAT_LINEAR && x_pos_a < 0) {
+                // Packed pixel pairs take 4 bytes of the matrix
+                if((j + (4/sizeofT)) > C) {
+                    printf("Invalid matrix width [%d] for Packed format!\n", buf_id);
+                    exit(EXIT_FAILURE);
+                }
+                const unsigned char *src = (const unsigned char*)base + y_pos_a * width;
+                unsigned char *dst = (unsigned char*)in.get_addr(i*C+j);
+                if (Class == GENX_FORMAT_YCRCB_NORMAL) {
+                    dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[0]; dst[3] = src[3];
+                } else {
+                    dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2]; dst[3] = src[1];
+                }
+                j += (4/sizeofT) - 1;
+                continue;
+            }
+            if (x_pos_a < 0) {
+                // Need to align x position to bbp
+                int align = x_pos % bpp;
+                x_pos_a -= align;
+            }
+            while (x_pos_a < 0) {
+                // If we're trying to read outside the left boundary, increase x_pos_a
+                x_pos_a += bpp;
+            }
+
+            if (x_pos_a >= width) {
+                if (Class != GENX_FORMAT_LINEAR) {
+                    if((j + (4/sizeofT)) > C) {
+                        printf("Invalid matrix width [%d] for Packed format!\n", buf_id);
+                        exit(EXIT_FAILURE);
+                    }
+                    // The last pixel pair of the row
+                    const unsigned char *src = (const unsigned char*)base + y_pos_a * width + width - 4;
+                    unsigned char *dst = (unsigned char*)in.get_addr(i*C+j);
+                    if (Class == GENX_FORMAT_YCRCB_NORMAL) {
+                        dst[0] = src[2]; dst[1] = src[1]; dst[2] = src[2]; dst[3] = src[3];
+                    } else {
+                        dst[0] = src[0]; dst[1] = src[3]; dst[2] = src[2]; dst[3] = src[3];
+                    }
+                    j += (4/sizeofT) - 1;
+                    continue;
+                }
+
+                x_pos_a = x_pos_a - bpp;
+                for (int byte_count = 0; byte_count < sizeofT; byte_count++)
+                {
+                    if (x_pos_a >= width) {
+                        x_pos_a = x_pos_a - bpp;
+                    }
+                    offset = y_pos_a * width + x_pos_a;
+
+                    /*
+                    If destination size per element is less then or equal pixel size of the surface
+                    move the pixel value accross the destination elements.
+                    If destination size per element is greater then pixel size of the surface
+                    replicate pixel value in the destination element.
+                    */
+                    if(sizeof(T) <= bpp)
+                    {
+                        for(uint bpp_count = 0; j<C&&bpp_count<bpp ;j++, bpp_count+=sizeof(T))
+                        {
+                            in(i,j) = *((T*)(base + offset + bpp_count));
+                        }
+                        j--;
+                        break;
+                    }
+                    else
+                    {
+                        ((unsigned char*)in.get_addr(i*C+j))[byte_count] = *((unsigned char*)(base + offset));
+                    }
+
+                    x_pos_a = x_pos_a + 1;
+                }
+            }
+            else {
+                offset = y_pos_a * width + x_pos_a;
+                in(i,j) = *((T*)(base + offset));
+            }
+        }
+    }
+}
+
+template <typename T, uint R, uint C, typename M>
+inline void CM_genx_read_block_clamped(M &in, const CmEmulSys::iobuffer &buff, const char *base,
+                                       int x_pos, int y_first, int y_step, uint buf_id)
+{
+    switch (buff.formatClass) {
+    case GENX_FORMAT_YCRCB_NORMAL:
+        CM_genx_read_block_clamped_as<GENX_FORMAT_YCRCB_NORMAL, T, R, C>(in, buff, base, x_pos, y_first, y_step, buf_id);
+        break;
+    case GENX_FORMAT_YCRCB_SWAPY:
+        CM_genx_read_block_clamped_as<GENX_FORMAT_YCRCB_SWAPY, T, R, C>(in, buff, base, x_pos, y_first, y_step, buf_id);
+        break;
+    default:
+        CM_genx_read_block_clamped_as<GENX_FORMAT_LINEAR, T, R, C>(in, buff, base, x_pos, y_first, y_step, buf_id);
+        break;
+    }
+}
+
+/*
+ * Value an atomic operation leaves in memory, given the value it found there.
+ * src0 is the operand and src1 the comparand of ATOMIC_CMPXCHG, for
+ * ATOMIC_FCMPWR src0 is the comparand and src1 the new value.
+ */
+template <typename T>
+inline T CM_genx_atomic_result(CmAtomicOpType op, T old, T src0, T src1, uint buf_id)
+{
+    // Integer min/max compare QWords in full, DWords and smaller as DWords.
+    using UInt = std::conditional_t<sizeof(T) == 8, uint64_t, uint>;
+    using SInt = std::make_signed_t<UInt>;
+
+    switch (op) {
+    case ATOMIC_ADD:
+        return old + src0;
+    case ATOMIC_SUB:
+        return old - src0;
+    case ATOMIC_INC:
+        return old + 1;
+    case ATOMIC_DEC:
+        return old - 1;
+    case ATOMIC_MIN:
+        if (is_fp_type<T>::value) return old;
+        return ((UInt)old <= (UInt)src0) ? old : src0;
+    case ATOMIC_MAX:
+        if (is_fp_type<T>::value) return old;
+        return ((UInt)old >= (UInt)src0) ? old : src0;
+    case ATOMIC_XCHG:
+        return src0;
+    case ATOMIC_CMPXCHG:
+        return (old == src1) ? src0 : old;
+    case ATOMIC_AND:
+    case ATOMIC_OR:
+    case ATOMIC_XOR:
+        if constexpr (std::is_same_v<T, uint> || std::is_same_v<T, int>) {
+            return (op == ATOMIC_AND) ? (old & src0) : (op == ATOMIC_OR) ? (old | src0) : (old ^ src0);
+        }
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id);
+        exit(EXIT_FAILURE);
+    case ATOMIC_MINSINT:
+        return ((SInt)old <= (SInt)src0) ? old : src0;
+    case ATOMIC_MAXSINT:
+        return ((SInt)old >= (SInt)src0) ? old : src0;
+    case ATOMIC_FADD:
+        return is_fp_type<T>::value ? (T)((float)old + (float)src0) : old;
+    case ATOMIC_FSUB:
+        return is_fp_type<T>::value ? (T)((float)old - (float)src0) : old;
+    case ATOMIC_FCMPWR:
+        return (is_fp_type<T>::value && old == src0) ? src1 : old;
+    case ATOMIC_FMIN:
+        if (!is_fp_type<T>::value) return old;
+        return ((float)old <= (float)src0) ? old : src0;
+    case ATOMIC_FMAX:
+        if (!is_fp_type<T>::value) return old;
+        return ((float)old >= (float)src0) ? old : src0;
+    default:
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*
+ * Performs one lane of a DWord/QWord atomic on addr with a host atomic
+ * instruction and returns the value found there. Operations the host has no
+ * instruction for retry a compare-exchange of CM_genx_atomic_result.
+ */
+template <typename T>
+inline T CM_genx_atomic_apply(CmAtomicOpType op, T *addr, T src0, T src1, uint buf_id)
+{
+    if constexpr (std::is_integral_v<T>) {
+        switch (op) {
+        case ATOMIC_ADD:
+            return __atomic_fetch_add(addr, src0, __ATOMIC_SEQ_CST);
+        case ATOMIC_SUB:
+            return __atomic_fetch_sub(addr, src0, __ATOMIC_SEQ_CST);
+        case ATOMIC_INC:
+            return __atomic_fetch_add(addr, 1, __ATOMIC_SEQ_CST);
+        case ATOMIC_DEC:
+            return __atomic_fetch_sub(addr, 1, __ATOMIC_SEQ_CST);
+        case ATOMIC_XCHG:
+            return __atomic_exchange_n(addr, src0, __ATOMIC_SEQ_CST);
+        case ATOMIC_AND:
+        case ATOMIC_OR:
+        case ATOMIC_XOR:
+            if constexpr (std::is_same_v<T, uint> || std::is_same_v<T, int>) {
+                if (op == ATOMIC_AND) return __atomic_fetch_and(addr, src0, __ATOMIC_SEQ_CST);
+                if (op == ATOMIC_OR) return __atomic_fetch_or(addr, src0, __ATOMIC_SEQ_CST);
+                return __atomic_fetch_xor(addr, src0, __ATOMIC_SEQ_CST);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    T old, desired;
+    __atomic_load(addr, &old, __ATOMIC_SEQ_CST);
+    do {
+        desired = CM_genx_atomic_result(op, old, src0, src1, buf_id);
+        if (std::memcmp(&desired, &old, sizeof(T)) == 0) {
+            break; // Nothing to store, e.g. a failed compare
+        }
+    } while (!__atomic_compare_exchange(addr, &old, &desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST));
+    return old;
+}
+
 #ifndef NEW_CM_RT
 
 /* This funtion reads Media Block data from genx dataport */
@@ -472,7 +779,7 @@ read(uint buf_id, int x_pos, int y_pos, matrix<T,R,C> &in)
                 case 3 matrix 4 byte per element
                 */
                 if((j + (4/sizeofT)) > C) {
-                    printf("Invalid matrix width for Packed format!\n", buf_id.get_data()&0xFF);
+                    printf("Invalid matrix width for Packed format!\n", buf_id.get_data());
                     exit(EXIT_FAILURE);
                 }
                 offset = y_pos_a * width;
@@ -520,7 +827,7 @@ read(uint buf_id, int x_pos, int y_pos, matrix<T,R,C> &in)
                     case 3 matrix 4 byte per element
                     */
                     if((j + (4/sizeofT)) > C) {
-                        printf("Invalid matrix width for Packed format!\n", buf_id.get_data()&0xFF);
+                        printf("Invalid matrix width for Packed format!\n", buf_id.get_data());
                         exit(EXIT_FAILURE);
                     }
                     //setting offset to width - 4 for row we are processing
@@ -661,7 +968,7 @@ read(uint buf_id, int x_pos, int y_pos, matrix_ref<T,R,C> in)
                 case 3 matrix 4 byte per element
                 */
                 if((j + (4/sizeofT)) > C) {
-                    printf("Invalid matrix width for Packed format!\n", buf_id.get_data()&0xFF);
+                    printf("Invalid matrix width for Packed format!\n", buf_id.get_data());
                     exit(EXIT_FAILURE);
                 }
                 offset = y_pos_a * width;
@@ -709,7 +1016,7 @@ read(uint buf_id, int x_pos, int y_pos, matrix_ref<T,R,C> in)
                     case 3 matrix 4 byte per element
                     */
                     if((j + (4/sizeofT)) > C) {
-                        printf("Invalid matrix width for Packed format!\n", buf_id.get_data()&0xFF);
+                        printf("Invalid matrix width for Packed format!\n", buf_id.get_data());
                         exit(EXIT_FAILURE);
                     }
                     //setting offset to width - 4 for row we are processing
@@ -880,7 +1187,7 @@ read(uint buf_id, CmBufferAttrib buf_attrib, int x_pos, int y_pos, matrix<T,R,C>
                 case 3 matrix 4 byte per element
                 */
                 if((j + (4/sizeofT)) > C) {
-                    printf("Invalid matrix width for Packed format!\n", buf_id.get_data()&0xFF);
+                    printf("Invalid matrix width for Packed format!\n", buf_id.get_data());
                     exit(EXIT_FAILURE);
                 }
                 offset = y_pos_a * width;
@@ -937,7 +1244,7 @@ read(uint buf_id, CmBufferAttrib buf_attrib, int x_pos, int y_pos, matrix<T,R,C>
                     case 3 matrix 4 byte per element
                     */
                     if((j + (4/sizeofT)) > C) {
-                        printf("Invalid matrix width for Packed format!\n", buf_id.get_data()&0xFF);
+                        printf("Invalid matrix width for Packed format!\n", buf_id.get_data());
                         exit(EXIT_FAILURE);
                     }
                     //setting offset to width - 4 for row we are processing
@@ -1111,7 +1418,7 @@ read(uint buf_id, CmBufferAttrib buf_attrib, int x_pos, int y_pos, matrix_ref<T,
                 case 3 matrix 4 byte per element
                 */
                 if((j + (4/sizeofT)) > C) {
-                    printf("Invalid matrix width for Packed format!\n", buf_id.get_data()&0xFF);
+                    printf("Invalid matrix width for Packed format!\n", buf_id.get_data());
                     exit(EXIT_FAILURE);
                 }
                 offset = y_pos_a * width;
@@ -1168,7 +1475,7 @@ read(uint buf_id, CmBufferAttrib buf_attrib, int x_pos, int y_pos, matrix_ref<T,
                     case 3 matrix 4 byte per element
                     */
                     if((j + (4/sizeofT)) > C) {
-                        printf("Invalid matrix width for Packed format!\n", buf_id.get_data()&0xFF);
+                        printf("Invalid matrix width for Packed format!\n", buf_id.get_data());
                         exit(EXIT_FAILURE);
                     }
                     //setting offset to width - 4 for row we are processing
@@ -4285,238 +4592,362 @@ read(SurfaceIndex & buf_id, int x_pos, int y_pos, matrix<T,R,C> &in)
 {
 	std::unique_lock<std::mutex> lock(mutexForWrite);
 
-    uint i,j;
-    uint offset;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     int width = buff_iter->width;
-    int height = buff_iter->height;
 
     {
         if((buff_iter->bclass != GEN4_INPUT_BUFFER) &&
             (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER)) {
-                GFX_EMU_ERROR_MESSAGE("reading buffer %d: the registered buffer type is not INPUT_BUFFER!\n", buf_id.get_data()&0xFF);
+                GFX_EMU_ERROR_MESSAGE("reading buffer %d: the registered buffer type is not INPUT_BUFFER!\n", buf_id.get_data());
                 exit(EXIT_FAILURE);
         }
     }
 
-    int x_pos_a, y_pos_a;  /* Actual positions */
-    int sizeofT = sizeof(T); /* Make this into a signed integer */
-    uint bpp = CM_genx_bytes_per_pixel(buff_iter->pixelFormat);
-    assert(((bpp - 1) & bpp) == 0); // Is power-of-2 number
+    if(buff_iter->formatClass == GENX_FORMAT_LINEAR &&
+       CM_genx_block_inside<T,R,C>(*buff_iter, x_pos, y_pos, 1)) {
+        CM_genx_read_block_rows<T,R,C>(in, (char*)buff_iter->p + y_pos * width + x_pos, width);
+        return true;
+    }
 
-    for (i = 0; i < R; i++) {
-        for (j = 0; j < C; j++) {
-            x_pos_a = x_pos + j * sizeof(T);
-            {
-                y_pos_a = y_pos + i;
-            }
-            // We should check the boundary condition based on sizeof(T), x_pos_a is 0-based
-            // Note: Use a signed variable; otherwise sizeof(T) is unsigned
-            if ((x_pos_a + sizeofT) > width) {
-                // If we're trying to read outside the boundary, limit the value of x_pos_a
-                // Assumption -- We don't this situation:
-                //         x_pos_a  width's boundary
-                //           |      |
-                //           <---type(T)--->
-                // At most x_pos_a+sizeof(T) is exactly at the boundary.
-                x_pos_a = width;
-            }
-            if (y_pos_a > height - 1) {
-                y_pos_a = height - 1;
-            }
+    CM_genx_read_block_clamped<T,R,C>(in, *buff_iter, (char*)buff_iter->p, x_pos, y_pos, 1, buf_id.get_data());
+    return true;
+}
 
-            if (y_pos_a < 0) {
-                y_pos_a = 0;
-            }
+/* This funtion reads Media Block data from genx dataport */
+template <typename T, uint R, uint C>
+CM_API bool
+read(SurfaceIndex & buf_id, int x_pos, int y_pos, matrix_ref<T,R,C> in)
+{
+    return read(buf_id, GENX_MODIFIED, x_pos, y_pos, in);
+}
 
-            // Surface width can be less than bpp and coordinates can be negative
-            if((buff_iter->pixelFormat == YCRCB_NORMAL ||
-                buff_iter->pixelFormat == YCRCB_SWAPY) &&
-                x_pos_a < 0)
-            {
-                // If we're trying to read outside the left boundary, increase x_pos_a
-                //sizeofT
-                /*
-                case 1 matrix 1 byte per element
-                case 2 matrix 2 byte per element
-                case 3 matrix 4 byte per element
-                */
-                if((j + (4/sizeofT)) > C) {
-                    printf("Invalid matrix width [%d]for Packed format!\n", buf_id.get_data()&0xFF);
-                    exit(EXIT_FAILURE);
-                }
-                offset = y_pos_a * width;
-                if(buff_iter->pixelFormat == YCRCB_NORMAL)
-                {
-                    ((unsigned char*)in.get_addr(i*C+j))[0] = *((unsigned char*)((char*)buff_iter->p + offset + 0));
-                    ((unsigned char*)in.get_addr(i*C+j))[1] = *((unsigned char*)((char*)buff_iter->p + offset + 1));
-                    ((unsigned char*)in.get_addr(i*C+j))[2] = *((unsigned char*)((char*)buff_iter->p + offset + 0));
-                    ((unsigned char*)in.get_addr(i*C+j))[3] = *((unsigned char*)((char*)buff_iter->p + offset + 3));
-                }else if(buff_iter->pixelFormat == YCRCB_SWAPY)
-                {
-                    ((unsigned char*)in.get_addr(i*C+j))[0] = *((unsigned char*)((char*)buff_iter->p + offset + 0));
-                    ((unsigned char*)in.get_addr(i*C+j))[1] = *((unsigned char*)((char*)buff_iter->p + offset + 1));
-                    ((unsigned char*)in.get_addr(i*C+j))[2] = *((unsigned char*)((char*)buff_iter->p + offset + 2));
-                    ((unsigned char*)in.get_addr(i*C+j))[3] = *((unsigned char*)((char*)buff_iter->p + offset + 1));
-                }
+template <typename T, uint R, uint C>
+CM_API bool
+read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, int x_pos, int y_pos, matrix<T,R,C> &in)
+{
+	std::unique_lock<std::mutex> lock(mutexForWrite);
 
-                j+= (4/sizeofT);
-                j--;
-                continue;
+    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
-            }else
-            {
-                if (x_pos_a < 0) {
-                    // Need to align x position to bbp
-                    int offset = x_pos % bpp;
-                    x_pos_a -= offset;
-                }
-                while (x_pos_a < 0) {
-                    // If we're trying to read outside the left boundary, increase x_pos_a
-                    x_pos_a += bpp;
-                }
-            }
+    if(buff_iter == CmEmulSys::iobuffers.end()) {
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
 
-            if (x_pos_a >= width) {
+    if((buf_attrib < GENX_TOP_FIELD) || (buf_attrib > GENX_MODIFIED_BOTTOM_FIELD)) {
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: incorrect buffer attribute %d!\n", buf_id.get_data(), buf_attrib);
+        exit(EXIT_FAILURE);
+    }
 
-                if((buff_iter->pixelFormat == YCRCB_NORMAL ||
-                    buff_iter->pixelFormat == YCRCB_SWAPY))
-                {
-                    // If we're trying to read outside the left boundary, increase x_pos_a
-                    //sizeofT
-                    /*
-                    case 1 matrix 1 byte per element
-                    case 2 matrix 2 byte per element
-                    case 3 matrix 4 byte per element
-                    */
-                    if((j + (4/sizeofT)) > C) {
-                        printf("Invalid matrix width [%d] for Packed format!\n", buf_id.get_data()&0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    //setting offset to width - 4 for row we are processing
-                    offset = y_pos_a * width + width - 4;
-                    if(buff_iter->pixelFormat == YCRCB_NORMAL)
-                    {
-                        ((unsigned char*)in.get_addr(i*C+j))[0] = *((unsigned char*)((char*)buff_iter->p + offset + 2));
-                        ((unsigned char*)in.get_addr(i*C+j))[1] = *((unsigned char*)((char*)buff_iter->p + offset + 1));
-                        ((unsigned char*)in.get_addr(i*C+j))[2] = *((unsigned char*)((char*)buff_iter->p + offset + 2));
-                        ((unsigned char*)in.get_addr(i*C+j))[3] = *((unsigned char*)((char*)buff_iter->p + offset + 3));
-                    }else if(buff_iter->pixelFormat == YCRCB_SWAPY)
-                    {
-                        ((unsigned char*)in.get_addr(i*C+j))[0] = *((unsigned char*)((char*)buff_iter->p + offset + 0));
-                        ((unsigned char*)in.get_addr(i*C+j))[1] = *((unsigned char*)((char*)buff_iter->p + offset + 3));
-                        ((unsigned char*)in.get_addr(i*C+j))[2] = *((unsigned char*)((char*)buff_iter->p + offset + 2));
-                        ((unsigned char*)in.get_addr(i*C+j))[3] = *((unsigned char*)((char*)buff_iter->p + offset + 3));
-                    }
-
-                    j+= (4/sizeofT);
-                    j--;
-                    continue;
+    int width = buff_iter->width;
 
-                }else
-                {
-                    x_pos_a = x_pos_a - bpp;
-                    for( uint byte_count =0; byte_count < sizeof(T); byte_count++)
-                    {
-                        if (x_pos_a >= width) {
-                            x_pos_a = x_pos_a - bpp;
-                        }
-                        offset = y_pos_a * width + x_pos_a;
+    if(buf_attrib >= GENX_MODIFIED) {
+        if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
+            GFX_EMU_ERROR_MESSAGE("reading buffer MODIFIED(%d): the registered buffer type is not INPUT_OUTPUT_BUFFER!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        if((buff_iter->bclass != GEN4_INPUT_BUFFER) &&
+            (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER)) {
+                GFX_EMU_ERROR_MESSAGE("reading buffer %d: the registered buffer type is not INPUT_BUFFER!\n", buf_id.get_data());
+                exit(EXIT_FAILURE);
+        }
+    }
 
-                        /*
-                        If destination size per element is less then or equal pixel size of the surface
-                        move the pixel value accross the destination elements.
-                        If destination size per element is greater then pixel size of the surface
-                        replicate pixel value in the destination element.
-                        */
-                        if(sizeof(T) <= bpp)
-                        {
-                            for(uint bpp_count = 0; j<C&&bpp_count<bpp ;j++, bpp_count+=sizeof(T))
-                            {
-                                in(i,j) = *((T*)((char*)buff_iter->p + offset + bpp_count));
-                            }
-                            j--;
-                            break;
-                        }
-                        else
-                        {
-                            ((unsigned char*)in.get_addr(i*C+j))[byte_count] = *((unsigned char*)((char*)buff_iter->p + offset));
-                        }
+    int y_first = y_pos;
+    int y_step = 1;
+    if ((buf_attrib == GENX_TOP_FIELD) || (buf_attrib == GENX_MODIFIED_TOP_FIELD)) {
+        y_first = y_pos << 1;
+        y_step = 2;
+    } else if ((buf_attrib == GENX_BOTTOM_FIELD) || (buf_attrib == GENX_MODIFIED_BOTTOM_FIELD)) {
+        y_first = 1 + (y_pos << 1);
+        y_step = 2;
+    }
+    char *base = (char*)((buf_attrib >= GENX_MODIFIED) ? buff_iter->p_volatile : buff_iter->p);
 
-                        x_pos_a = x_pos_a + 1;
-                    }
-                    x_pos_a = width;
-                }
-            }
-            else {
-                offset = y_pos_a * width + x_pos_a;
-                {
-                    in(i,j) = *((T*)((char*)buff_iter->p + offset));
-                }
-            }
-        }
+    if(buff_iter->formatClass == GENX_FORMAT_LINEAR &&
+       CM_genx_block_inside<T,R,C>(*buff_iter, x_pos, y_first, y_step)) {
+        CM_genx_read_block_rows<T,R,C>(in, base + y_first * width + x_pos, y_step * width);
+        return true;
     }
 
+    CM_genx_read_block_clamped<T,R,C>(in, *buff_iter, base, x_pos, y_first, y_step, buf_id.get_data());
     return true;
 }
 
 /* This funtion reads Media Block data from genx dataport */
 template <typename T, uint R, uint C>
 CM_API bool
-read(SurfaceIndex & buf_id, int x_pos, int y_pos, matrix_ref<T,R,C> in)
-{
-    return read(buf_id, GENX_MODIFIED, x_pos, y_pos, in);
-}
-
-template <typename T, uint R, uint C>
-CM_API bool
-read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, int x_pos, int y_pos, matrix<T,R,C> &in)
+read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, int x_pos, int y_pos, matrix_ref<T,R,C> in)
 {
 	std::unique_lock<std::mutex> lock(mutexForWrite);
 
-    int i,j;
-    uint offset;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if((buf_attrib < GENX_TOP_FIELD) || (buf_attrib > GENX_MODIFIED_BOTTOM_FIELD)) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: incorrect buffer attribute %d!\n", buf_id.get_data()&0xFF, buf_attrib);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: incorrect buffer attribute %d!\n", buf_id.get_data(), buf_attrib);
         exit(EXIT_FAILURE);
     }
 
     int width = buff_iter->width;
-    int height = buff_iter->height;
 
     if(buf_attrib >= GENX_MODIFIED) {
         if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("reading buffer MODIFIED(%d): the registered buffer type is not INPUT_OUTPUT_BUFFER!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("reading buffer MODIFIED(%d): the registered buffer type is not INPUT_OUTPUT_BUFFER!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     } else {
         if((buff_iter->bclass != GEN4_INPUT_BUFFER) &&
             (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER)) {
-                GFX_EMU_ERROR_MESSAGE("reading buffer %d: the registered buffer type is not INPUT_BUFFER!\n", buf_id.get_data()&0xFF);
+                GFX_EMU_ERROR_MESSAGE("reading buffer %d: the registered buffer type is not INPUT_BUFFER!\n", buf_id.get_data());
                 exit(EXIT_FAILURE);
         }
     }
 
-    int x_pos_a, y_pos_a;  /* Actual positions */
+    int y_first = y_pos;
+    int y_step = 1;
+    if ((buf_attrib == GENX_TOP_FIELD) || (buf_attrib == GENX_MODIFIED_TOP_FIELD)) {
+        y_first = y_pos << 1;
+        y_step = 2;
+    } else if ((buf_attrib == GENX_BOTTOM_FIELD) || (buf_attrib == GENX_MODIFIED_BOTTOM_FIELD)) {
+        y_first = 1 + (y_pos << 1);
+        y_step = 2;
+    }
+    char *base = (char*)((buf_attrib >= GENX_MODIFIED) ? buff_iter->p_volatile : buff_iter->p);
+
+    if(buff_iter->formatClass == GENX_FORMAT_LINEAR &&
+       CM_genx_block_inside<T,R,C>(*buff_iter, x_pos, y_first, y_step)) {
+        CM_genx_read_block_rows<T,R,C>(in, base + y_first * width + x_pos, y_step * width);
+        return true;
+    }
+
+    CM_genx_read_block_clamped<T,R,C>(in, *buff_iter, base, x_pos, y_first, y_step, buf_id.get_data());
+    return true;
+}
+
+/* This funtion writes Media Block data to genx dataport */
+template <typename T, uint R, uint C>
+CM_API bool
+write(SurfaceIndex & buf_id, int x_pos, int y_pos, const matrix<T,R,C> &out)
+{
+	std::unique_lock<std::mutex> lk(mutexForWrite);
+
+    uint i,j;
+    uint offset;
+    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
+                                    CmEmulSys::search_buffer(buf_id.get_data());
+
+    if(buff_iter == CmEmulSys::iobuffers.end()) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
+
+    int width = buff_iter->width;
+    int height = buff_iter->height;
+
+    if((x_pos % 4) != 0) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: X-coordinate must be 4-byte aligned!\n", buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
     int sizeofT = sizeof(T); /* Make this into a signed integer */
-    uint bpp = CM_genx_bytes_per_pixel(buff_iter->pixelFormat);
+    if(((C * sizeofT) % 4) != 0) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: input matrix width must be 4-byte aligned!\n", buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
+
+    if((buff_iter->bclass != GEN4_OUTPUT_BUFFER) &&
+        (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER)) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: incorrect buffer type!\n", buf_id.get_data());
+    }
+
+    uint x_pos_a, y_pos_a;  /* Actual positions */
+    uint bpp = buff_iter->bpp;
+    assert(((bpp - 1) & bpp) == 0); // Is power-of-2 number
+
+    if(CM_genx_block_inside<T,R,C>(*buff_iter, x_pos, y_pos, 1)) {
+        void *dst = (buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) ? buff_iter->p_volatile : buff_iter->p;
+        CM_genx_write_block_rows<T,R,C>(const_cast<matrix<T,R,C>&>(out), (char*)dst + y_pos * width + x_pos, width);
+        return true;
+    }
+
+    for (i = 0; i < R; i++) {
+        for (j = 0; j < C; j++) {
+            x_pos_a = x_pos + j * sizeofT;
+            {
+                y_pos_a = y_pos + i;
+            }
+            if ((int)x_pos_a < 0) {
+                continue;
+            }
+            if ((int)y_pos_a < 0) {
+                continue;
+            }
+            if ((int)(x_pos_a + sizeofT) > width) {
+                continue;
+            }
+            if ((int)y_pos_a > height - 1) {
+                continue;
+            }
+            offset = y_pos_a * width + x_pos_a;
+            if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
+                *((T*)( (char*)buff_iter->p_volatile + offset )) = out(i,j);
+            } else {
+                *((T*)( (char*)buff_iter->p + offset )) = out(i,j);
+            }
+        }
+    }
+
+    return true;
+}
+
+/* This funtion writes Media Block data to genx dataport */
+template <typename T, uint R, uint C>
+CM_API bool
+write(SurfaceIndex & buf_id, int x_pos, int y_pos, const matrix_ref<T,R,C> out)
+{
+	std::unique_lock<std::mutex> lk(mutexForWrite);
+
+    int i,j;
+    uint offset;
+    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
+                                    CmEmulSys::search_buffer(buf_id.get_data());
+
+    if(buff_iter == CmEmulSys::iobuffers.end()) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
+
+    int width = buff_iter->width;
+    int height = buff_iter->height;
+
+    if((x_pos % 4) != 0) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: X-coordinate must be 4-byte aligned!\n", buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
+    int sizeofT = sizeof(T); /* Make this into a signed integer */
+    if(((C * sizeofT) % 4) != 0) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: input matrix width must be 4-byte aligned!\n", buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
+
+    if((buff_iter->bclass != GEN4_OUTPUT_BUFFER) &&
+        (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER)) {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: incorrect buffer type!\n", buf_id.get_data());
+    }
+
+    uint x_pos_a, y_pos_a;  /* Actual positions */
+    uint bpp = buff_iter->bpp;
+    assert(((bpp - 1) & bpp) == 0); // Is power-of-2 number
+
+    if(CM_genx_block_inside<T,R,C>(*buff_iter, x_pos, y_pos, 1)) {
+        void *dst = (buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) ? buff_iter->p_volatile : buff_iter->p;
+        CM_genx_write_block_rows<T,R,C>(const_cast<matrix_ref<T,R,C>&>(out), (char*)dst + y_pos * width + x_pos, width);
+        return true;
+    }
+
+    for (i = 0; i < R; i++) {
+        for (j = 0; j < C; j++) {
+            x_pos_a = x_pos + j * sizeofT;
+            {
+                y_pos_a = y_pos + i;
+            }
+            if ((int)x_pos_a < 0) {
+                continue;
+            }
+            if ((int)y_pos_a < 0) {
+                continue;
+            }
+            if ((x_pos_a + sizeofT) > width) {
+                continue;
+            }
+            if (y_pos_a > height - 1) {
+                continue;
+            }
+            offset = y_pos_a * width + x_pos_a;
+            if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
+                *((T*)( (char*)buff_iter->p_volatile + offset )) = out(i,j);
+            } else {
+                *((T*)( (char*)buff_iter->p + offset )) = out(i,j);
+            }
+        }
+    }
+
+    return true;
+}
+
+/* This funtion writes Media Block data to genx dataport */
+template <typename T, uint R, uint C>
+CM_API bool
+write(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, int x_pos, int y_pos, const matrix<T,R,C> &out)
+{
+	std::unique_lock<std::mutex> lk(mutexForWrite);
+
+    int i,j;
+    uint offset;
+    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
+                                    CmEmulSys::search_buffer(buf_id.get_data());
+
+    if(buff_iter == CmEmulSys::iobuffers.end()) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
+
+    if((buf_attrib != GENX_TOP_FIELD) && (buf_attrib != GENX_BOTTOM_FIELD)) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: incorrect buffer attribute %d!\n", buf_id.get_data(), buf_attrib);
+        exit(EXIT_FAILURE);
+    }
+
+    int width = buff_iter->width;
+    int height = buff_iter->height;
+
+    if((x_pos % 4) != 0) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: X-coordinate must be 4-byte aligned!\n", buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
+    int sizeofT = sizeof(T); /* Make this into a signed integer */
+    if(((C * sizeofT) % 4) != 0) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: input matrix width must be 4-byte aligned!\n", buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
+
+    if((buff_iter->bclass != GEN4_OUTPUT_BUFFER) &&
+        (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER)) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: incorrect buffer type!\n", buf_id.get_data());
+    }
+
+    uint x_pos_a, y_pos_a;  /* Actual positions */
+    uint bpp = buff_iter->bpp;
     assert(((bpp - 1) & bpp) == 0); // Is power-of-2 number
 
+    int y_first = y_pos;
+    int y_step = 1;
+    if ((buf_attrib == GENX_TOP_FIELD) || (buf_attrib == GENX_MODIFIED_TOP_FIELD)) {
+        y_first = y_pos << 1;
+        y_step = 2;
+    } else if ((buf_attrib == GENX_BOTTOM_FIELD) || (buf_attrib == GENX_MODIFIED_BOTTOM_FIELD)) {
+        y_first = 1 + (y_pos << 1);
+        y_step = 2;
+    }
+    if(CM_genx_block_inside<T,R,C>(*buff_iter, x_pos, y_first, y_step)) {
+        void *dst = (buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) ? buff_iter->p_volatile : buff_iter->p;
+        CM_genx_write_block_rows<T,R,C>(const_cast<matrix<T,R,C>&>(out), (char*)dst + y_first * width + x_pos, y_step * width);
+        return true;
+    }
+
     for (i = 0; i < R; i++) {
         for (j = 0; j < C; j++) {
             x_pos_a = x_pos + j * sizeof(T);
@@ -4537,169 +4968,24 @@ read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, int x_pos, int y_pos, mat
                 {
                     y_pos_a = y_pos + i;
                 }
-            // We should check the boundary condition based on sizeof(T), x_pos_a is 0-based
-            // Note: Use a signed variable; otherwise sizeof(T) is unsigned
+
+            if ((int)x_pos_a < 0) {
+                continue;
+            }
+            if ((int)y_pos_a < 0) {
+                continue;
+            }
             if ((x_pos_a + sizeofT) > width) {
-                // If we're trying to read outside the boundary, limit the value of x_pos_a
-                // Assumption -- We don't this situation:
-                //         x_pos_a  width's boundary
-                //           |      |
-                //           <---type(T)--->
-                // At most x_pos_a+sizeof(T) is exactly at the boundary.
-                x_pos_a = width;
+                continue;
             }
             if (y_pos_a > height - 1) {
-                y_pos_a = height - 1;
-            }
-            // Surface width can be less than bpp and coordinates can be negative
-            if (y_pos_a < 0) {
-                y_pos_a = 0;
-            }
-
-            // Surface width can be less than bpp and coordinates can be negative
-            if((buff_iter->pixelFormat == YCRCB_NORMAL ||
-                buff_iter->pixelFormat == YCRCB_SWAPY) &&
-                x_pos_a < 0)
-            {
-                void * temp_buffer_pointer = NULL;
-                if(buf_attrib >= GENX_MODIFIED)
-                {
-                    temp_buffer_pointer = buff_iter->p_volatile;
-                }else
-                {
-                    temp_buffer_pointer = buff_iter->p;
-                }
-                // If we're trying to read outside the left boundary, increase x_pos_a
-                //sizeofT
-                /*
-                case 1 matrix 1 byte per element
-                case 2 matrix 2 byte per element
-                case 3 matrix 4 byte per element
-                */
-                if((j + (4/sizeofT)) > C) {
-                    printf("Invalid matrix width[%d] for Packed format!\n", buf_id.get_data()&0xFF);
-                    exit(EXIT_FAILURE);
-                }
-                offset = y_pos_a * width;
-                if(buff_iter->pixelFormat == YCRCB_NORMAL)
-                {
-                    ((unsigned char*)in.get_addr(i*C+j))[0] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 0));
-                    ((unsigned char*)in.get_addr(i*C+j))[1] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 1));
-                    ((unsigned char*)in.get_addr(i*C+j))[2] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 0));
-                    ((unsigned char*)in.get_addr(i*C+j))[3] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 3));
-                }else if(buff_iter->pixelFormat == YCRCB_SWAPY)
-                {
-                    ((unsigned char*)in.get_addr(i*C+j))[0] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 0));
-                    ((unsigned char*)in.get_addr(i*C+j))[1] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 1));
-                    ((unsigned char*)in.get_addr(i*C+j))[2] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 2));
-                    ((unsigned char*)in.get_addr(i*C+j))[3] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 1));
-                }
-
-                j+= (4/sizeofT);
-                j--;
                 continue;
-
-            }else
-            {
-                if (x_pos_a < 0) {
-                    // Need to align x position to bbp
-                    int offset = x_pos % bpp;
-                    x_pos_a -= offset;
-                }
-                while (x_pos_a < 0) {
-                    // If we're trying to read outside the left boundary, increase x_pos_a
-                    x_pos_a += bpp;
-                }
-            }
-
-            if (x_pos_a >= width) {
-
-                void * temp_buffer_pointer = NULL;
-                if(buf_attrib >= GENX_MODIFIED)
-                {
-                    temp_buffer_pointer = buff_iter->p_volatile;
-                }else
-                {
-                    temp_buffer_pointer = buff_iter->p;
-                }
-                if((buff_iter->pixelFormat == YCRCB_NORMAL ||
-                    buff_iter->pixelFormat == YCRCB_SWAPY))
-                {
-
-                    // If we're trying to read outside the left boundary, increase x_pos_a
-                    //sizeofT
-                    /*
-                    case 1 matrix 1 byte per element
-                    case 2 matrix 2 byte per element
-                    case 3 matrix 4 byte per element
-                    */
-                    if((j + (4/sizeofT)) > C) {
-                        printf("Invalid matrix width[%d] for Packed format!\n", buf_id.get_data()&0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    //setting offset to width - 4 for row we are processing
-                    offset = y_pos_a * width + width - 4;
-                    if(buff_iter->pixelFormat == YCRCB_NORMAL)
-                    {
-                        ((unsigned char*)in.get_addr(i*C+j))[0] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 2));
-                        ((unsigned char*)in.get_addr(i*C+j))[1] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 1));
-                        ((unsigned char*)in.get_addr(i*C+j))[2] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 2));
-                        ((unsigned char*)in.get_addr(i*C+j))[3] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 3));
-                    }else if(buff_iter->pixelFormat == YCRCB_SWAPY)
-                    {
-                        ((unsigned char*)in.get_addr(i*C+j))[0] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 0));
-                        ((unsigned char*)in.get_addr(i*C+j))[1] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 3));
-                        ((unsigned char*)in.get_addr(i*C+j))[2] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 2));
-                        ((unsigned char*)in.get_addr(i*C+j))[3] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 3));
-                    }
-
-                    j+= (4/sizeofT);
-                    j--;
-                    continue;
-
-                }else
-                {
-
-                    x_pos_a = x_pos_a - bpp;
-                    for( int byte_count =0; byte_count < sizeof(T); byte_count++)
-                    {
-                        if (x_pos_a >= width) {
-                            x_pos_a = x_pos_a - bpp;
-                        }
-                        offset = y_pos_a * width + x_pos_a;
-
-                        /*
-                        If destination size per element is less then or equal pixel size of the surface
-                        move the pixel value accross the destination elements.
-                        If destination size per element is greater then pixel size of the surface
-                        replicate pixel value in the destination element.
-                        */
-                        if(sizeof(T) <= bpp)
-                        {
-                            for(int bpp_count = 0; j<C&&bpp_count<bpp ;j++, bpp_count+=sizeof(T))
-                            {
-                                in(i,j) = *((T*)((char*)temp_buffer_pointer + offset + bpp_count));
-                            }
-                            j--;
-                            break;
-                        }
-                        else
-                        {
-                            ((unsigned char*)in.get_addr(i*C+j))[byte_count] = *((unsigned char*)((char*)temp_buffer_pointer + offset));
-                        }
-
-                        x_pos_a = x_pos_a + 1;
-                    }
-                    x_pos_a = width;
-                }
             }
-            else {
-                offset = y_pos_a * width + x_pos_a;
-                if(buf_attrib >= GENX_MODIFIED) {
-                    in(i,j) = *((T*)((char*)buff_iter->p_volatile + offset));
-                } else {
-                    in(i,j) = *((T*)((char*)buff_iter->p + offset));
-                }
+            offset = y_pos_a * width + x_pos_a;
+            if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
+                *((T*)( (char*)buff_iter->p_volatile + offset )) = out(i,j);
+            } else {
+                *((T*)( (char*)buff_iter->p + offset )) = out(i,j);
             }
         }
     }
@@ -4707,49 +4993,65 @@ read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, int x_pos, int y_pos, mat
     return true;
 }
 
-/* This funtion reads Media Block data from genx dataport */
+/* This funtion writes Media Block data to genx dataport */
 template <typename T, uint R, uint C>
 CM_API bool
-read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, int x_pos, int y_pos, matrix_ref<T,R,C> in)
+write(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, int x_pos, int y_pos, const matrix_ref<T,R,C> out)
 {
-	std::unique_lock<std::mutex> lock(mutexForWrite);
+	std::unique_lock<std::mutex> lk(mutexForWrite);
 
     int i,j;
     uint offset;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
-    if((buf_attrib < GENX_TOP_FIELD) || (buf_attrib > GENX_MODIFIED_BOTTOM_FIELD)) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: incorrect buffer attribute %d!\n", buf_id.get_data()&0xFF, buf_attrib);
+    if((buf_attrib != GENX_TOP_FIELD) && (buf_attrib != GENX_BOTTOM_FIELD)) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: incorrect buffer attribute %d!\n", buf_id.get_data(), buf_attrib);
         exit(EXIT_FAILURE);
     }
 
     int width = buff_iter->width;
     int height = buff_iter->height;
 
-    if(buf_attrib >= GENX_MODIFIED) {
-        if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("reading buffer MODIFIED(%d): the registered buffer type is not INPUT_OUTPUT_BUFFER!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-        }
-    } else {
-        if((buff_iter->bclass != GEN4_INPUT_BUFFER) &&
-            (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER)) {
-                GFX_EMU_ERROR_MESSAGE("reading buffer %d: the registered buffer type is not INPUT_BUFFER!\n", buf_id.get_data()&0xFF);
-                exit(EXIT_FAILURE);
-        }
+    if((x_pos % 4) != 0) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: X-coordinate must be 4-byte aligned!\n", buf_id.get_data());
+        exit(EXIT_FAILURE);
     }
-
-    int x_pos_a, y_pos_a;  /* Actual positions */
     int sizeofT = sizeof(T); /* Make this into a signed integer */
-    uint bpp = CM_genx_bytes_per_pixel(buff_iter->pixelFormat);
+    if(((C * sizeofT) % 4) != 0) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: input matrix width must be 4-byte aligned!\n", buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
+
+    if((buff_iter->bclass != GEN4_OUTPUT_BUFFER) &&
+        (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER)) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: incorrect buffer type!\n", buf_id.get_data());
+    }
+
+    uint x_pos_a, y_pos_a;  /* Actual positions */
+    uint bpp = buff_iter->bpp;
     assert(((bpp - 1) & bpp) == 0); // Is power-of-2 number
 
+    int y_first = y_pos;
+    int y_step = 1;
+    if ((buf_attrib == GENX_TOP_FIELD) || (buf_attrib == GENX_MODIFIED_TOP_FIELD)) {
+        y_first = y_pos << 1;
+        y_step = 2;
+    } else if ((buf_attrib == GENX_BOTTOM_FIELD) || (buf_attrib == GENX_MODIFIED_BOTTOM_FIELD)) {
+        y_first = 1 + (y_pos << 1);
+        y_step = 2;
+    }
+    if(CM_genx_block_inside<T,R,C>(*buff_iter, x_pos, y_first, y_step)) {
+        void *dst = (buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) ? buff_iter->p_volatile : buff_iter->p;
+        CM_genx_write_block_rows<T,R,C>(const_cast<matrix_ref<T,R,C>&>(out), (char*)dst + y_first * width + x_pos, y_step * width);
+        return true;
+    }
+
     for (i = 0; i < R; i++) {
         for (j = 0; j < C; j++) {
             x_pos_a = x_pos + j * sizeof(T);
@@ -4771,309 +5073,194 @@ read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, int x_pos, int y_pos, mat
                     y_pos_a = y_pos + i;
                 }
 
-            // We should check the boundary condition based on sizeof(T), x_pos_a is 0-based
-            // Note: Use a signed variable; otherwise sizeof(T) is unsigned
+            if ((int)x_pos_a < 0) {
+                continue;
+            }
+            if ((int)y_pos_a < 0) {
+                continue;
+            }
             if ((x_pos_a + sizeofT) > width) {
-                // If we're trying to read outside the boundary, limit the value of x_pos_a
-                // Assumption -- We don't this situation:
-                //         x_pos_a  width's boundary
-                //           |      |
-                //           <---type(T)--->
-                // At most x_pos_a+sizeof(T) is exactly at the boundary.
-                x_pos_a = width;
+                continue;
             }
             if (y_pos_a > height - 1) {
-                y_pos_a = height - 1;
+                continue;
             }
-            // Surface width can be less than bpp and coordinates can be negative
-            if (y_pos_a < 0) {
-                y_pos_a = 0;
+            offset = y_pos_a * width + x_pos_a;
+            if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
+                *((T*)( (char*)buff_iter->p_volatile + offset )) = out(i,j);
+            } else {
+                *((T*)( (char*)buff_iter->p + offset )) = out(i,j);
             }
+        }
+    }
 
-            // Surface width can be less than bpp and coordinates can be negative
-            if((buff_iter->pixelFormat == YCRCB_NORMAL ||
-                buff_iter->pixelFormat == YCRCB_SWAPY) &&
-                x_pos_a < 0)
-            {
+    return true;
+}
 
-                void * temp_buffer_pointer = NULL;
-                if(buf_attrib >= GENX_MODIFIED)
-                {
-                    temp_buffer_pointer = buff_iter->p_volatile;
-                }else
-                {
-                    temp_buffer_pointer = buff_iter->p;
-                }
-                // If we're trying to read outside the left boundary, increase x_pos_a
-                //sizeofT
-                /*
-                case 1 matrix 1 byte per element
-                case 2 matrix 2 byte per element
-                case 3 matrix 4 byte per element
-                */
-                if((j + (4/sizeofT)) > C) {
-                    printf("Invalid matrix width[%d] for Packed format!\n", buf_id.get_data()&0xFF);
-                    exit(EXIT_FAILURE);
-                }
-                offset = y_pos_a * width;
+template <typename T, uint R, uint C>
+CM_API bool
+read_plane(SurfaceIndex  buf_id, CmSurfacePlaneIndex plane_id, int x_pos, int y_pos, matrix<T,R,C> &in)
+{
+    return read_plane(buf_id, GENX_MODIFIED, plane_id, x_pos, y_pos, in);
+}
 
-                if(buff_iter->pixelFormat == YCRCB_NORMAL)
-                {
-                    ((unsigned char*)in.get_addr(i*C+j))[0] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 0));
-                    ((unsigned char*)in.get_addr(i*C+j))[1] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 1));
-                    ((unsigned char*)in.get_addr(i*C+j))[2] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 0));
-                    ((unsigned char*)in.get_addr(i*C+j))[3] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 3));
-                }else if(buff_iter->pixelFormat == YCRCB_SWAPY)
-                {
-                    ((unsigned char*)in.get_addr(i*C+j))[0] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 0));
-                    ((unsigned char*)in.get_addr(i*C+j))[1] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 1));
-                    ((unsigned char*)in.get_addr(i*C+j))[2] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 2));
-                    ((unsigned char*)in.get_addr(i*C+j))[3] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 1));
-                }
-
-                j+= (4/sizeofT);
-                j--;
-                continue;
-
-            }else
-            {
-                if (x_pos_a < 0) {
-                    // Need to align x position to bbp
-                    int offset = x_pos % bpp;
-                    x_pos_a -= offset;
-                }
-                while (x_pos_a < 0) {
-                    // If we're trying to read outside the left boundary, increase x_pos_a
-                    x_pos_a += bpp;
-                }
-            }
-
-            if (x_pos_a >= width) {
-
-                void * temp_buffer_pointer = NULL;
-                if(buf_attrib >= GENX_MODIFIED)
-                {
-                    temp_buffer_pointer = buff_iter->p_volatile;
-                }else
-                {
-                    temp_buffer_pointer = buff_iter->p;
-                }
-                if((buff_iter->pixelFormat == YCRCB_NORMAL ||
-                    buff_iter->pixelFormat == YCRCB_SWAPY))
-                {
-
-                    // If we're trying to read outside the left boundary, increase x_pos_a
-                    //sizeofT
-                    /*
-                    case 1 matrix 1 byte per element
-                    case 2 matrix 2 byte per element
-                    case 3 matrix 4 byte per element
-                    */
-                    if((j + (4/sizeofT)) > C) {
-                        printf("Invalid matrix width[%d] for Packed format!\n", buf_id.get_data()&0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    //setting offset to width - 4 for row we are processing
-                    offset = y_pos_a * width + width - 4;
-                    if(buff_iter->pixelFormat == YCRCB_NORMAL)
-                    {
-                        ((unsigned char*)in.get_addr(i*C+j))[0] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 2));
-                        ((unsigned char*)in.get_addr(i*C+j))[1] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 1));
-                        ((unsigned char*)in.get_addr(i*C+j))[2] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 2));
-                        ((unsigned char*)in.get_addr(i*C+j))[3] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 3));
-                    }else if(buff_iter->pixelFormat == YCRCB_SWAPY)
-                    {
-                        ((unsigned char*)in.get_addr(i*C+j))[0] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 0));
-                        ((unsigned char*)in.get_addr(i*C+j))[1] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 3));
-                        ((unsigned char*)in.get_addr(i*C+j))[2] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 2));
-                        ((unsigned char*)in.get_addr(i*C+j))[3] = *((unsigned char*)((char*)temp_buffer_pointer + offset + 3));
-                    }
-
-                    j+= (4/sizeofT);
-                    j--;
-                    continue;
-
-                }else
-                {
-
-                    x_pos_a = x_pos_a - bpp;
-                    for( int byte_count =0; byte_count < sizeof(T); byte_count++)
-                    {
-                        if (x_pos_a >= width) {
-                            x_pos_a = x_pos_a - bpp;
-                        }
-                        offset = y_pos_a * width + x_pos_a;
-
-                        /*
-                        If destination size per element is less then or equal pixel size of the surface
-                        move the pixel value accross the destination elements.
-                        If destination size per element is greater then pixel size of the surface
-                        replicate pixel value in the destination element.
-                        */
-                        if(sizeof(T) <= bpp)
-                        {
-                            for(int bpp_count = 0; j<C&&bpp_count<bpp ;j++, bpp_count+=sizeof(T))
-                            {
-                                in(i,j) = *((T*)((char*)temp_buffer_pointer + offset + bpp_count));
-                            }
-                            j--;
-                            break;
-                        }
-                        else
-                        {
-                            ((unsigned char*)in.get_addr(i*C+j))[byte_count] = *((unsigned char*)((char*)temp_buffer_pointer + offset));
-                        }
+template <typename T, uint R, uint C>
+CM_API bool
+read_plane(SurfaceIndex  buf_id, CmSurfacePlaneIndex plane_id, int x_pos, int y_pos, matrix_ref<T,R,C> in)
+{
+    return read_plane(buf_id, GENX_MODIFIED, plane_id, x_pos, y_pos, in);
+}
 
-                        x_pos_a = x_pos_a + 1;
-                    }
-                    x_pos_a = width;
-                }
-            }
-            else {
-                offset = y_pos_a * width + x_pos_a;
-                if(buf_attrib >= GENX_MODIFIED) {
-                    in(i,j) = *((T*)((char*)buff_iter->p_volatile + offset));
-                } else {
-                    in(i,j) = *((T*)((char*)buff_iter->p + offset));
-                }
-            }
-        }
+template <typename T, uint R, uint C>
+CM_API bool
+read_plane(SurfaceIndex  buf_id, CmBufferAttrib buf_attrib, CmSurfacePlaneIndex plane_id, int x_pos, int y_pos, matrix<T,R,C> &in)
+{
+    if(plane_id < GENX_SURFACE_Y_PLANE || plane_id > GENX_SURFACE_V_PLANE) {
+        printf("Invalid plane index for surface %d!\n", buf_id.get_data());
+        exit(EXIT_FAILURE);
     }
-
-    return true;
+    return read<T, R, C>(buf_id + plane_id, buf_attrib, x_pos, y_pos, in);
 }
 
-/* This funtion writes Media Block data to genx dataport */
 template <typename T, uint R, uint C>
 CM_API bool
-write(SurfaceIndex & buf_id, int x_pos, int y_pos, const matrix<T,R,C> &out)
+read_plane(SurfaceIndex  buf_id, CmBufferAttrib buf_attrib, CmSurfacePlaneIndex plane_id, int x_pos, int y_pos, matrix_ref<T,R,C> in)
 {
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
-    uint i,j;
-    uint offset;
-    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
-
-    if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+    if(plane_id < GENX_SURFACE_Y_PLANE || plane_id > GENX_SURFACE_V_PLANE) {
+        printf("Invalid plane index for surface %d!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
+    return read<T, R, C>(buf_id + plane_id, buf_attrib, x_pos, y_pos, in);
+}
 
-    int width = buff_iter->width;
-    int height = buff_iter->height;
-
-    if((x_pos % 4) != 0) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: X-coordinate must be 4-byte aligned!\n", buf_id.get_data()&0xFF);
+template <typename T, uint R, uint C>
+CM_API bool
+write_plane(SurfaceIndex  buf_id, CmSurfacePlaneIndex plane_id, int x_pos, int y_pos, const matrix<T,R,C> &out)
+{
+    if(plane_id < GENX_SURFACE_Y_PLANE || plane_id > GENX_SURFACE_V_PLANE) {
+        printf("Invalid plane index for surface %d!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
-    int sizeofT = sizeof(T); /* Make this into a signed integer */
-    if(((C * sizeofT) % 4) != 0) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: input matrix width must be 4-byte aligned!\n", buf_id.get_data()&0xFF);
+    return write<T, R, C>(buf_id + plane_id, x_pos, y_pos, out);
+}
+
+template <typename T, uint R, uint C>
+CM_API bool
+write_plane(SurfaceIndex  buf_id, CmSurfacePlaneIndex plane_id, int x_pos, int y_pos, const matrix_ref<T,R,C> out)
+{
+    if(plane_id < GENX_SURFACE_Y_PLANE || plane_id > GENX_SURFACE_V_PLANE) {
+        printf("Invalid plane index for surface %d!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
+    return write<T, R, C>(buf_id + plane_id, x_pos, y_pos, out);
+}
 
-    if((buff_iter->bclass != GEN4_OUTPUT_BUFFER) &&
-        (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER)) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: incorrect buffer type!\n", buf_id.get_data()&0xFF);
+template <typename T, uint R, uint C>
+CM_API bool
+write_plane(SurfaceIndex  buf_id, CmBufferAttrib buf_attrib, CmSurfacePlaneIndex plane_id, int x_pos, int y_pos, const matrix<T,R,C> &out)
+{
+    if(plane_id < GENX_SURFACE_Y_PLANE || plane_id > GENX_SURFACE_V_PLANE) {
+        printf("Invalid plane index for surface %d!\n", buf_id.get_data());
+        exit(EXIT_FAILURE);
     }
+    return write<T, R, C>(buf_id + plane_id, buf_attrib, x_pos, y_pos, out);
+}
 
-    uint x_pos_a, y_pos_a;  /* Actual positions */
-    uint bpp = CM_genx_bytes_per_pixel(buff_iter->pixelFormat);
-    assert(((bpp - 1) & bpp) == 0); // Is power-of-2 number
-
-    for (i = 0; i < R; i++) {
-        for (j = 0; j < C; j++) {
-            x_pos_a = x_pos + j * sizeofT;
-            {
-                y_pos_a = y_pos + i;
-            }
-            if ((int)x_pos_a < 0) {
-                continue;
-            }
-            if ((int)y_pos_a < 0) {
-                continue;
-            }
-            if ((int)(x_pos_a + sizeofT) > width) {
-                continue;
-            }
-            if ((int)y_pos_a > height - 1) {
-                continue;
-            }
-            offset = y_pos_a * width + x_pos_a;
-            if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-                *((T*)( (char*)buff_iter->p_volatile + offset )) = out(i,j);
-            } else {
-                *((T*)( (char*)buff_iter->p + offset )) = out(i,j);
-            }
-        }
+template <typename T, uint R, uint C>
+CM_API bool
+write_plane(SurfaceIndex  buf_id, CmBufferAttrib buf_attrib, CmSurfacePlaneIndex plane_id, int x_pos, int y_pos, const matrix_ref<T,R,C> out)
+{
+    if(plane_id < GENX_SURFACE_Y_PLANE || plane_id > GENX_SURFACE_V_PLANE) {
+        printf("Invalid plane index for surface %d!\n", buf_id.get_data());
+        exit(EXIT_FAILURE);
     }
+    return write<T, R, C>(buf_id + plane_id, buf_attrib, x_pos, y_pos, out);
+}
 
-    return true;
+/* This funtion reads OWord Block data from genx dataport */
+template <typename T, uint S>
+CM_API bool
+read(SurfaceIndex & buf_id, int offset, vector<T,S> &in)
+{
+    return read(buf_id, GENX_MODIFIED, offset, in);
 }
 
-/* This funtion writes Media Block data to genx dataport */
-template <typename T, uint R, uint C>
+/* This funtion reads OWord Block data from genx dataport */
+template <typename T, uint S>
 CM_API bool
-write(SurfaceIndex & buf_id, int x_pos, int y_pos, const matrix_ref<T,R,C> out)
+read(SurfaceIndex & buf_id, int offset, vector_ref<T,S> in)
 {
-	std::unique_lock<std::mutex> lk(mutexForWrite);
+    return read(buf_id, GENX_MODIFIED, offset, in);
+}
 
-    int i,j;
-    uint offset;
+/* This funtion reads OWord Block data from genx dataport */
+
+template <typename T, uint S>
+CM_API bool
+read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, int offset, vector<T,S> &in)
+{
+    std::unique_lock<std::mutex> lock(mutexForWrite);
+
+    int i;
+    uint pos;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+        CmEmulSys::search_buffer(buf_id.get_data());
 
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
-    int width = buff_iter->width;
-    int height = buff_iter->height;
-
-    if((x_pos % 4) != 0) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: X-coordinate must be 4-byte aligned!\n", buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
-    }
-    int sizeofT = sizeof(T); /* Make this into a signed integer */
-    if(((C * sizeofT) % 4) != 0) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: input matrix width must be 4-byte aligned!\n", buf_id.get_data()&0xFF);
+    if(buf_attrib != GENX_MODIFIED && buf_attrib != GENX_DWALIGNED &&
+       buf_attrib != GENX_MODIFIED_DWALIGNED && buf_attrib != GENX_CONSTANT &&
+       buf_attrib != GENX_CONSTANT_DWALIGNED) {
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: incorrect buffer attribute %d!\n", buf_id.get_data(), buf_attrib);
         exit(EXIT_FAILURE);
     }
 
-    if((buff_iter->bclass != GEN4_OUTPUT_BUFFER) &&
-        (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER)) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: incorrect buffer type!\n", buf_id.get_data()&0xFF);
-    }
+    int width = buff_iter->width;
+    int height = buff_iter->height;
 
-    uint x_pos_a, y_pos_a;  /* Actual positions */
-    uint bpp = CM_genx_bytes_per_pixel(buff_iter->pixelFormat);
-    assert(((bpp - 1) & bpp) == 0); // Is power-of-2 number
+    if(buf_attrib != GENX_DWALIGNED && buf_attrib != GENX_MODIFIED_DWALIGNED &&
+       buf_attrib != GENX_CONSTANT_DWALIGNED) {
+        if((offset % 16) != 0) {
+            GFX_EMU_ERROR_MESSAGE("reading buffer %d: offset must be 16-byte aligned!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+        }
+    }
+    else {
+        if((offset % 4) != 0) {
+            GFX_EMU_ERROR_MESSAGE("reading buffer %d: offset must be 4-byte aligned!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+        }
+    }
 
-    for (i = 0; i < R; i++) {
-        for (j = 0; j < C; j++) {
-            x_pos_a = x_pos + j * sizeofT;
+    assert(height == 1);
+
+    char* buff;
+
+    if(buf_attrib == GENX_MODIFIED || buf_attrib == GENX_MODIFIED_DWALIGNED)
+    {
+        if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
+            GFX_EMU_ERROR_MESSAGE("reading buffer MODIFIED(%d): the registered buffer type is not INPUT_OUTPUT_BUFFER!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+        }
+
+        buff = (char*) buff_iter->p_volatile;
+    }
+    else
+    {
+        buff = (char*) buff_iter->p;
+    }
+
+    int sizeofT = sizeof(T); /* Make this into a signed integer */
+    for (i = 0; i < S; i++) {
+        pos = offset + i * sizeofT;
+        if (pos >= width) {
+            in(i) = 0;
+        } else {
             {
-                y_pos_a = y_pos + i;
-            }
-            if ((int)x_pos_a < 0) {
-                continue;
-            }
-            if ((int)y_pos_a < 0) {
-                continue;
-            }
-            if ((x_pos_a + sizeofT) > width) {
-                continue;
-            }
-            if (y_pos_a > height - 1) {
-                continue;
-            }
-            offset = y_pos_a * width + x_pos_a;
-            if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-                *((T*)( (char*)buff_iter->p_volatile + offset )) = out(i,j);
-            } else {
-                *((T*)( (char*)buff_iter->p + offset )) = out(i,j);
+                in(i) = *((T*)(buff + pos));
             }
         }
     }
@@ -5081,88 +5268,72 @@ write(SurfaceIndex & buf_id, int x_pos, int y_pos, const matrix_ref<T,R,C> out)
     return true;
 }
 
-/* This funtion writes Media Block data to genx dataport */
-template <typename T, uint R, uint C>
+/* This funtion reads OWord Block data from genx dataport */
+template <typename T, uint S>
 CM_API bool
-write(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, int x_pos, int y_pos, const matrix<T,R,C> &out)
+read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, int offset, vector_ref<T,S> in)
 {
-	std::unique_lock<std::mutex> lk(mutexForWrite);
+	std::unique_lock<std::mutex> lock(mutexForWrite);
 
-    int i,j;
-    uint offset;
+    int i;
+    uint pos;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
-    if((buf_attrib != GENX_TOP_FIELD) && (buf_attrib != GENX_BOTTOM_FIELD)) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: incorrect buffer attribute %d!\n", buf_id.get_data()&0xFF, buf_attrib);
+    if(buf_attrib != GENX_MODIFIED && buf_attrib != GENX_DWALIGNED &&
+       buf_attrib != GENX_MODIFIED_DWALIGNED && buf_attrib != GENX_CONSTANT &&
+       buf_attrib != GENX_CONSTANT_DWALIGNED) {
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: incorrect buffer attribute %d!\n", buf_id.get_data(), buf_attrib);
         exit(EXIT_FAILURE);
     }
 
     int width = buff_iter->width;
     int height = buff_iter->height;
 
-    if((x_pos % 4) != 0) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: X-coordinate must be 4-byte aligned!\n", buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
+    if(buf_attrib != GENX_DWALIGNED && buf_attrib != GENX_MODIFIED_DWALIGNED &&
+       buf_attrib != GENX_CONSTANT_DWALIGNED) {
+        if((offset % 16) != 0) {
+            GFX_EMU_ERROR_MESSAGE("reading buffer %d: offset must be 16-byte aligned!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+        }
     }
-    int sizeofT = sizeof(T); /* Make this into a signed integer */
-    if(((C * sizeofT) % 4) != 0) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: input matrix width must be 4-byte aligned!\n", buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
+    else {
+        if((offset % 4) != 0) {
+            GFX_EMU_ERROR_MESSAGE("reading buffer %d: offset must be 4-byte aligned!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+        }
     }
 
-    if((buff_iter->bclass != GEN4_OUTPUT_BUFFER) &&
-        (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER)) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: incorrect buffer type!\n", buf_id.get_data()&0xFF);
-    }
+    assert(height == 1);
 
-    uint x_pos_a, y_pos_a;  /* Actual positions */
-    uint bpp = CM_genx_bytes_per_pixel(buff_iter->pixelFormat);
-    assert(((bpp - 1) & bpp) == 0); // Is power-of-2 number
+    char* buff;
 
-    for (i = 0; i < R; i++) {
-        for (j = 0; j < C; j++) {
-            x_pos_a = x_pos + j * sizeof(T);
-            if ((buf_attrib == GENX_TOP_FIELD) ||
-                (buf_attrib == GENX_MODIFIED_TOP_FIELD))
-            {
-                //y_pos_a = (y_pos + i) * 2;
-                y_pos_a = (y_pos + i) << 1;
-            }
-            else
-                if ((buf_attrib == GENX_BOTTOM_FIELD) ||
-                    (buf_attrib == GENX_MODIFIED_BOTTOM_FIELD))
-                {
-                    //y_pos_a = (y_pos + i) * 2  + 1;
-                    y_pos_a = 1 + ((y_pos + i) << 1);
-                }
-                else
-                {
-                    y_pos_a = y_pos + i;
-                }
+    if(buf_attrib == GENX_MODIFIED || buf_attrib == GENX_MODIFIED_DWALIGNED)
+    {
+        if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
+            GFX_EMU_ERROR_MESSAGE("reading buffer MODIFIED(%d): the registered buffer type is not INPUT_OUTPUT_BUFFER!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+        }
+        buff = (char*) buff_iter->p_volatile;
+    }
+    else
+    {
+        buff = (char*) buff_iter->p;
+    }
 
-            if ((int)x_pos_a < 0) {
-                continue;
-            }
-            if ((int)y_pos_a < 0) {
-                continue;
-            }
-            if ((x_pos_a + sizeofT) > width) {
-                continue;
-            }
-            if (y_pos_a > height - 1) {
-                continue;
-            }
-            offset = y_pos_a * width + x_pos_a;
-            if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-                *((T*)( (char*)buff_iter->p_volatile + offset )) = out(i,j);
-            } else {
-                *((T*)( (char*)buff_iter->p + offset )) = out(i,j);
+    int sizeofT = sizeof(T); /* Make this into a signed integer */
+    for (i = 0; i < S; i++) {
+        pos = offset + i * sizeofT;
+        if (pos >= width) {
+            in(i) = 0;
+        } else {
+            {
+                in(i) = *((T*)(buff + pos));
             }
         }
     }
@@ -5170,259 +5341,153 @@ write(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, int x_pos, int y_pos, co
     return true;
 }
 
-/* This funtion writes Media Block data to genx dataport */
-template <typename T, uint R, uint C>
+/* This funtion writes OWord Block data to genx dataport */
+template <typename T, uint S>
 CM_API bool
-write(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, int x_pos, int y_pos, const matrix_ref<T,R,C> out)
+write(SurfaceIndex & buf_id, int offset, const vector<T,S> &out)
 {
 	std::unique_lock<std::mutex> lk(mutexForWrite);
 
-    int i,j;
-    uint offset;
+    int i;
+    uint pos;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
-    }
-
-    if((buf_attrib != GENX_TOP_FIELD) && (buf_attrib != GENX_BOTTOM_FIELD)) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: incorrect buffer attribute %d!\n", buf_id.get_data()&0xFF, buf_attrib);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     int width = buff_iter->width;
     int height = buff_iter->height;
 
-    if((x_pos % 4) != 0) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: X-coordinate must be 4-byte aligned!\n", buf_id.get_data()&0xFF);
+    if((offset % 16) != 0) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: offset must be 16-byte aligned!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
     int sizeofT = sizeof(T); /* Make this into a signed integer */
-    if(((C * sizeofT) % 4) != 0) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: input matrix width must be 4-byte aligned!\n", buf_id.get_data()&0xFF);
+    if(((S * sizeofT) % 16) != 0) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: input vector size must be 16-byte aligned!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
+    assert(height == 1);
 
     if((buff_iter->bclass != GEN4_OUTPUT_BUFFER) &&
         (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER)) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: incorrect buffer type!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: incorrect buffer type!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
     }
 
-    uint x_pos_a, y_pos_a;  /* Actual positions */
-    uint bpp = CM_genx_bytes_per_pixel(buff_iter->pixelFormat);
-    assert(((bpp - 1) & bpp) == 0); // Is power-of-2 number
-
-    for (i = 0; i < R; i++) {
-        for (j = 0; j < C; j++) {
-            x_pos_a = x_pos + j * sizeof(T);
-            if ((buf_attrib == GENX_TOP_FIELD) ||
-                (buf_attrib == GENX_MODIFIED_TOP_FIELD))
-            {
-                //y_pos_a = (y_pos + i) * 2;
-                y_pos_a = (y_pos + i) << 1;
-            }
-            else
-                if ((buf_attrib == GENX_BOTTOM_FIELD) ||
-                    (buf_attrib == GENX_MODIFIED_BOTTOM_FIELD))
-                {
-                    //y_pos_a = (y_pos + i) * 2  + 1;
-                    y_pos_a = 1 + ((y_pos + i) << 1);
-                }
-                else
-                {
-                    y_pos_a = y_pos + i;
-                }
-
-            if ((int)x_pos_a < 0) {
-                continue;
-            }
-            if ((int)y_pos_a < 0) {
-                continue;
-            }
-            if ((x_pos_a + sizeofT) > width) {
-                continue;
-            }
-            if (y_pos_a > height - 1) {
-                continue;
-            }
-            offset = y_pos_a * width + x_pos_a;
-            if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-                *((T*)( (char*)buff_iter->p_volatile + offset )) = out(i,j);
-            } else {
-                *((T*)( (char*)buff_iter->p + offset )) = out(i,j);
-            }
+    for (i = 0; i < S; i++) {
+        pos = offset + i * sizeofT;
+        if (pos >= width) {
+            printf("Warning writing buffer %d: there is unexpected out-of-bound access for Oword block write!\n", buf_id.get_data());
+            break;
+        }
+        if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
+            *((T*)( (char*)buff_iter->p_volatile + pos )) = out(i);
+        } else {
+            *((T*)( (char*)buff_iter->p + pos )) = out(i);
         }
     }
 
     return true;
 }
 
-template <typename T, uint R, uint C>
+/* This funtion writes OWord Block data to genx dataport */
+template <typename T, uint S>
 CM_API bool
-read_plane(SurfaceIndex  buf_id, CmSurfacePlaneIndex plane_id, int x_pos, int y_pos, matrix<T,R,C> &in)
+write(SurfaceIndex & buf_id, int offset, const vector_ref<T, S> out)
 {
-    return read_plane(buf_id, GENX_MODIFIED, plane_id, x_pos, y_pos, in);
-}
+	std::unique_lock<std::mutex> lk(mutexForWrite);
 
-template <typename T, uint R, uint C>
-CM_API bool
-read_plane(SurfaceIndex  buf_id, CmSurfacePlaneIndex plane_id, int x_pos, int y_pos, matrix_ref<T,R,C> in)
-{
-    return read_plane(buf_id, GENX_MODIFIED, plane_id, x_pos, y_pos, in);
-}
+    uint i;
+    int pos;
+    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
-template <typename T, uint R, uint C>
-CM_API bool
-read_plane(SurfaceIndex  buf_id, CmBufferAttrib buf_attrib, CmSurfacePlaneIndex plane_id, int x_pos, int y_pos, matrix<T,R,C> &in)
-{
-    if(plane_id < GENX_SURFACE_Y_PLANE || plane_id > GENX_SURFACE_V_PLANE) {
-        printf("Invalid plane index for surface %d!\n", buf_id.get_data()&0xFF);
+    if(buff_iter == CmEmulSys::iobuffers.end()) {
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
-    return read<T, R, C>(buf_id + plane_id, buf_attrib, x_pos, y_pos, in);
-}
 
-template <typename T, uint R, uint C>
-CM_API bool
-read_plane(SurfaceIndex  buf_id, CmBufferAttrib buf_attrib, CmSurfacePlaneIndex plane_id, int x_pos, int y_pos, matrix_ref<T,R,C> in)
-{
-    if(plane_id < GENX_SURFACE_Y_PLANE || plane_id > GENX_SURFACE_V_PLANE) {
-        printf("Invalid plane index for surface %d!\n", buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
-    }
-    return read<T, R, C>(buf_id + plane_id, buf_attrib, x_pos, y_pos, in);
-}
+    int width = buff_iter->width;
+    int height = buff_iter->height;
 
-template <typename T, uint R, uint C>
-CM_API bool
-write_plane(SurfaceIndex  buf_id, CmSurfacePlaneIndex plane_id, int x_pos, int y_pos, const matrix<T,R,C> &out)
-{
-    if(plane_id < GENX_SURFACE_Y_PLANE || plane_id > GENX_SURFACE_V_PLANE) {
-        printf("Invalid plane index for surface %d!\n", buf_id.get_data()&0xFF);
+    if((offset % 16) != 0) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: offset must be 16-byte aligned!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
-    return write<T, R, C>(buf_id + plane_id, x_pos, y_pos, out);
-}
-
-template <typename T, uint R, uint C>
-CM_API bool
-write_plane(SurfaceIndex  buf_id, CmSurfacePlaneIndex plane_id, int x_pos, int y_pos, const matrix_ref<T,R,C> out)
-{
-    if(plane_id < GENX_SURFACE_Y_PLANE || plane_id > GENX_SURFACE_V_PLANE) {
-        printf("Invalid plane index for surface %d!\n", buf_id.get_data()&0xFF);
+    int sizeofT = sizeof(T); /* Make this into a signed integer */
+    if(((S * sizeofT) % 16) != 0) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: input vector size must be 16-byte aligned!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
-    return write<T, R, C>(buf_id + plane_id, x_pos, y_pos, out);
-}
+    assert(height == 1);
 
-template <typename T, uint R, uint C>
-CM_API bool
-write_plane(SurfaceIndex  buf_id, CmBufferAttrib buf_attrib, CmSurfacePlaneIndex plane_id, int x_pos, int y_pos, const matrix<T,R,C> &out)
-{
-    if(plane_id < GENX_SURFACE_Y_PLANE || plane_id > GENX_SURFACE_V_PLANE) {
-        printf("Invalid plane index for surface %d!\n", buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
+    if((buff_iter->bclass != GEN4_OUTPUT_BUFFER) &&
+        (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER)) {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: incorrect buffer type!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
     }
-    return write<T, R, C>(buf_id + plane_id, buf_attrib, x_pos, y_pos, out);
-}
 
-template <typename T, uint R, uint C>
-CM_API bool
-write_plane(SurfaceIndex  buf_id, CmBufferAttrib buf_attrib, CmSurfacePlaneIndex plane_id, int x_pos, int y_pos, const matrix_ref<T,R,C> out)
-{
-    if(plane_id < GENX_SURFACE_Y_PLANE || plane_id > GENX_SURFACE_V_PLANE) {
-        printf("Invalid plane index for surface %d!\n", buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
+    for (i = 0; i < S; i++) {
+        pos = offset + i * sizeofT;
+        if (pos >= width) {
+            break;
+        }
+        if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
+            *((T*)( (char*)buff_iter->p_volatile + pos )) = out(i);
+        } else {
+            *((T*)( (char*)buff_iter->p + pos )) = out(i);
+        }
     }
-    return write<T, R, C>(buf_id + plane_id, buf_attrib, x_pos, y_pos, out);
-}
-
-/* This funtion reads OWord Block data from genx dataport */
-template <typename T, uint S>
-CM_API bool
-read(SurfaceIndex & buf_id, int offset, vector<T,S> &in)
-{
-    return read(buf_id, GENX_MODIFIED, offset, in);
-}
 
-/* This funtion reads OWord Block data from genx dataport */
-template <typename T, uint S>
-CM_API bool
-read(SurfaceIndex & buf_id, int offset, vector_ref<T,S> in)
-{
-    return read(buf_id, GENX_MODIFIED, offset, in);
+    return true;
 }
 
-/* This funtion reads OWord Block data from genx dataport */
-
-template <typename T, uint S>
+/* This funtion reads scattered DWords from genx dataport */
+template <typename T, uint N>
 CM_API bool
-read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, int offset, vector<T,S> &in)
+read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, uint global_offset, vector_ref<uint, N> element_offset, vector_ref<T, N> in)
 {
-    std::unique_lock<std::mutex> lock(mutexForWrite);
+	std::unique_lock<std::mutex> lock(mutexForWrite);
 
-    int i;
+    static const bool conformable1 = is_fp_or_dword_type<T>::value;
+    uint i;
     uint pos;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-        CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
-    if(buf_attrib != GENX_MODIFIED && buf_attrib != GENX_DWALIGNED &&
-       buf_attrib != GENX_MODIFIED_DWALIGNED && buf_attrib != GENX_CONSTANT &&
-       buf_attrib != GENX_CONSTANT_DWALIGNED) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: incorrect buffer attribute %d!\n", buf_id.get_data()&0xFF, buf_attrib);
+    if(buf_attrib != GENX_MODIFIED && buf_attrib != GENX_CONSTANT) {
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: incorrect buffer attribute %d!\n", buf_id.get_data(), buf_attrib);
         exit(EXIT_FAILURE);
     }
 
     int width = buff_iter->width;
     int height = buff_iter->height;
 
-    if(buf_attrib != GENX_DWALIGNED && buf_attrib != GENX_MODIFIED_DWALIGNED &&
-       buf_attrib != GENX_CONSTANT_DWALIGNED) {
-        if((offset % 16) != 0) {
-            GFX_EMU_ERROR_MESSAGE("reading buffer %d: offset must be 16-byte aligned!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-        }
-    }
-    else {
-        if((offset % 4) != 0) {
-            GFX_EMU_ERROR_MESSAGE("reading buffer %d: offset must be 4-byte aligned!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-        }
-    }
-
-    assert(height == 1);
-
-    char* buff;
-
-    if(buf_attrib == GENX_MODIFIED || buf_attrib == GENX_MODIFIED_DWALIGNED)
     {
         if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("reading buffer MODIFIED(%d): the registered buffer type is not INPUT_OUTPUT_BUFFER!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("reading buffer MODIFIED(%d): the registered buffer type is not INPUT_OUTPUT_BUFFER!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
-
-        buff = (char*) buff_iter->p_volatile;
-    }
-    else
-    {
-        buff = (char*) buff_iter->p;
     }
 
-    int sizeofT = sizeof(T); /* Make this into a signed integer */
-    for (i = 0; i < S; i++) {
-        pos = offset + i * sizeofT;
-        if (pos >= width) {
-            in(i) = 0;
+    size_t sizeOfT = sizeof(T);
+    for (i = 0; i < N; i++) {
+        SIMDCF_ELEMENT_SKIP(i);
+        pos = (global_offset + element_offset(i))*sizeOfT;
+        if (pos >= width*height) {
+            in(i) = width*height - 1;
         } else {
             {
-                in(i) = *((T*)(buff + pos));
+                in(i) = *((T*)((char*)buff_iter->p_volatile + pos));
             }
         }
     }
@@ -5430,55 +5495,136 @@ read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, int offset, vector<T,S> &
     return true;
 }
 
-/* This funtion reads OWord Block data from genx dataport */
+template <typename T, uint N>
+CM_API bool
+read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, uint global_offset, vector<uint, N> &element_offset, vector<T, N> &in)
+{
+    return read(buf_id, buf_attrib, global_offset, element_offset.template select<N, 1>(), in.template select<N, 1>());
+}
+
+template <typename T, uint N>
+CM_API bool
+read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, uint global_offset, vector<uint, N> &element_offset, vector_ref<T, N> in)
+{
+    return read(buf_id, buf_attrib, global_offset, element_offset.template select<N, 1>(), in);
+}
+
+template <typename T, uint N>
+CM_API bool
+read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, uint global_offset, vector_ref<uint, N> element_offset, vector<T, N> &in)
+{
+    return read(buf_id, buf_attrib, global_offset, element_offset, in.template select<N, 1>());
+}
+
+template <typename T, uint N>
+CM_API bool
+read(SurfaceIndex & buf_id, uint global_offset, vector_ref<uint, N> element_offset, vector_ref<T, N> in)
+{
+    return read(buf_id, GENX_MODIFIED, global_offset, element_offset, in);
+}
+
+template <typename T, uint N>
+CM_API bool
+read(SurfaceIndex & buf_id, uint global_offset, vector<uint, N> &element_offset, vector<T, N> &in)
+{
+    return read(buf_id, GENX_MODIFIED, global_offset, element_offset, in);
+}
+
+template <typename T, uint N>
+CM_API bool
+read(SurfaceIndex & buf_id, uint global_offset, vector<uint, N> &element_offset, vector_ref<T, N> in)
+{
+    return read(buf_id, GENX_MODIFIED, global_offset, element_offset, in);
+}
+
+template <typename T, uint N>
+CM_API bool
+read(SurfaceIndex & buf_id, uint global_offset, vector_ref<uint, N> element_offset, vector<T, N> &in)
+{
+    return read(buf_id, GENX_MODIFIED, global_offset, element_offset, in);
+}
+
+/* This funtion reads HWord Block data from genx dataport */
 template <typename T, uint S>
 CM_API bool
-read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, int offset, vector_ref<T,S> in)
+cm_hword_read(SurfaceIndex & buf_id, int offset, vector<T,S> &in)
 {
-	std::unique_lock<std::mutex> lock(mutexForWrite);
+    return cm_hword_read(buf_id, GENX_MODIFIED, offset, in);
+}
 
-    int i;
-    uint pos;
+/* This funtion reads HWord Block data from genx dataport */
+template <typename T, uint S>
+CM_API bool
+cm_hword_read(SurfaceIndex & buf_id, int offset, vector_ref<T,S> in)
+{
+    return cm_hword_read(buf_id, GENX_MODIFIED, offset, in);
+}
+
+/* This funtion reads HWord Block data from genx dataport */
+template <typename T, uint S>
+CM_API bool
+cm_hword_read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, int offset, vector<T,S> &in)
+{
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+        CmEmulSys::search_buffer(buf_id.get_data());
 
-    if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+    if(buff_iter == CmEmulSys::iobuffers.end())
+    {
+        printf("%s:%d - Error reading buffer %d: buffer %d is not registered!\n",
+               __FUNCTION__,
+               __LINE__,
+               buf_id.get_data(),
+               buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
-    if(buf_attrib != GENX_MODIFIED && buf_attrib != GENX_DWALIGNED &&
-       buf_attrib != GENX_MODIFIED_DWALIGNED && buf_attrib != GENX_CONSTANT &&
-       buf_attrib != GENX_CONSTANT_DWALIGNED) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: incorrect buffer attribute %d!\n", buf_id.get_data()&0xFF, buf_attrib);
+    if ((offset & 0x1f) != 0) /// 0x1f = 011111B = 31
+    {
+        printf("%s:%d - Error reading buffer %d: offset must be 32-byte aligned! offset = %d\n",
+               __FUNCTION__,
+               __LINE__,
+               buf_id.get_data(),
+               offset);
         exit(EXIT_FAILURE);
     }
 
-    int width = buff_iter->width;
-    int height = buff_iter->height;
+    int sizeofT = sizeof(T);
+    int numbytes = sizeofT * S;
 
-    if(buf_attrib != GENX_DWALIGNED && buf_attrib != GENX_MODIFIED_DWALIGNED &&
-       buf_attrib != GENX_CONSTANT_DWALIGNED) {
-        if((offset % 16) != 0) {
-            GFX_EMU_ERROR_MESSAGE("reading buffer %d: offset must be 16-byte aligned!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-        }
-    }
-    else {
-        if((offset % 4) != 0) {
-            GFX_EMU_ERROR_MESSAGE("reading buffer %d: offset must be 4-byte aligned!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-        }
+    /// VMIT-6506
+    if (numbytes != 32         // 1-HWORD
+        && numbytes != 32 * 2  // 2-HWORD
+        && numbytes != 32 * 4  // 4-HWORD
+        && numbytes != 32 * 8) // 8-HWORD
+    {
+        printf("%s:%d - Error reading buffer %d: read size must be 1/2/4/8-HWORD (32/64/128/256 Bytes)!! numbytes = %d\n",
+               __FUNCTION__,
+               __LINE__,
+               buf_id.get_data(),
+               numbytes);
+        exit(EXIT_FAILURE);
     }
 
-    assert(height == 1);
+    if (buff_iter->height != 1)
+    {
+        printf("%s:%d - Height of read-surface is not 1!! (height = %d)\n",
+               __FUNCTION__,
+               __LINE__,
+               buff_iter->height);
+        exit(EXIT_FAILURE);
+    }
 
     char* buff;
 
-    if(buf_attrib == GENX_MODIFIED || buf_attrib == GENX_MODIFIED_DWALIGNED)
+    if(buf_attrib == GENX_MODIFIED
+       || buf_attrib == GENX_MODIFIED_DWALIGNED
+        )
     {
         if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("reading buffer MODIFIED(%d): the registered buffer type is not INPUT_OUTPUT_BUFFER!\n", buf_id.get_data()&0xFF);
+            printf("%s:%d - Error reading buffer MODIFIED(%d): the registered buffer type is not INPUT_OUTPUT_BUFFER!\n",
+                   __FUNCTION__,
+                   __LINE__,
+                   buf_id.get_data());
             exit(EXIT_FAILURE);
         }
         buff = (char*) buff_iter->p_volatile;
@@ -5488,1349 +5634,270 @@ read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, int offset, vector_ref<T,
         buff = (char*) buff_iter->p;
     }
 
-    int sizeofT = sizeof(T); /* Make this into a signed integer */
-    for (i = 0; i < S; i++) {
-        pos = offset + i * sizeofT;
-        if (pos >= width) {
-            in(i) = 0;
-        } else {
-            {
-                in(i) = *((T*)(buff + pos));
-            }
-        }
-    }
-
-    return true;
-}
-
-/* This funtion writes OWord Block data to genx dataport */
-template <typename T, uint S>
-CM_API bool
-write(SurfaceIndex & buf_id, int offset, const vector<T,S> &out)
-{
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
-    int i;
-    uint pos;
-    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
-
-    if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
-    }
-
-    int width = buff_iter->width;
-    int height = buff_iter->height;
-
-    if((offset % 16) != 0) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: offset must be 16-byte aligned!\n", buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
-    }
-    int sizeofT = sizeof(T); /* Make this into a signed integer */
-    if(((S * sizeofT) % 16) != 0) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: input vector size must be 16-byte aligned!\n", buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
-    }
-    assert(height == 1);
-
-    if((buff_iter->bclass != GEN4_OUTPUT_BUFFER) &&
-        (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER)) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: incorrect buffer type!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-    }
-
-    for (i = 0; i < S; i++) {
-        pos = offset + i * sizeofT;
-        if (pos >= width) {
-            printf("Warning writing buffer %d: there is unexpected out-of-bound access for Oword block write!\n", buf_id.get_data() & 0xFF);
-            break;
-        }
-        if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            *((T*)( (char*)buff_iter->p_volatile + pos )) = out(i);
-        } else {
-            *((T*)( (char*)buff_iter->p + pos )) = out(i);
-        }
-    }
-
-    return true;
-}
-
-/* This funtion writes OWord Block data to genx dataport */
-template <typename T, uint S>
-CM_API bool
-write(SurfaceIndex & buf_id, int offset, const vector_ref<T, S> out)
-{
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
-    uint i;
-    int pos;
-    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
-
-    if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
-    }
-
-    int width = buff_iter->width;
-    int height = buff_iter->height;
-
-    if((offset % 16) != 0) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: offset must be 16-byte aligned!\n", buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
-    }
-    int sizeofT = sizeof(T); /* Make this into a signed integer */
-    if(((S * sizeofT) % 16) != 0) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: input vector size must be 16-byte aligned!\n", buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
-    }
-    assert(height == 1);
-
-    if((buff_iter->bclass != GEN4_OUTPUT_BUFFER) &&
-        (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER)) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: incorrect buffer type!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-    }
-
-    for (i = 0; i < S; i++) {
-        pos = offset + i * sizeofT;
-        if (pos >= width) {
-            break;
-        }
-        if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            *((T*)( (char*)buff_iter->p_volatile + pos )) = out(i);
-        } else {
-            *((T*)( (char*)buff_iter->p + pos )) = out(i);
-        }
-    }
-
-    return true;
-}
-
-/* This funtion reads scattered DWords from genx dataport */
-template <typename T, uint N>
-CM_API bool
-read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, uint global_offset, vector_ref<uint, N> element_offset, vector_ref<T, N> in)
-{
-	std::unique_lock<std::mutex> lock(mutexForWrite);
-
-    static const bool conformable1 = is_fp_or_dword_type<T>::value;
-    uint i;
-    uint pos;
-    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
-
-    if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
-    }
-
-    if(buf_attrib != GENX_MODIFIED && buf_attrib != GENX_CONSTANT) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: incorrect buffer attribute %d!\n", buf_id.get_data()&0xFF, buf_attrib);
-        exit(EXIT_FAILURE);
-    }
-
-    int width = buff_iter->width;
-    int height = buff_iter->height;
+    uint pos = offset;
 
+    for (int i = 0; i < S; i++)
     {
-        if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("reading buffer MODIFIED(%d): the registered buffer type is not INPUT_OUTPUT_BUFFER!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
+        if (pos >= buff_iter->width)
+        {
+            in(i) = 0;
         }
-    }
-
-    size_t sizeOfT = sizeof(T);
-    for (i = 0; i < N; i++) {
-        SIMDCF_ELEMENT_SKIP(i);
-        pos = (global_offset + element_offset(i))*sizeOfT;
-        if (pos >= width*height) {
-            in(i) = width*height - 1;
-        } else {
-            {
-                in(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-            }
+        else
+        {
+            in(i) = *((T*)(buff + pos));
         }
-    }
-
-    return true;
-}
-
-template <typename T, uint N>
-CM_API bool
-read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, uint global_offset, vector<uint, N> &element_offset, vector<T, N> &in)
-{
-    return read(buf_id, buf_attrib, global_offset, element_offset.template select<N, 1>(), in.template select<N, 1>());
-}
-
-template <typename T, uint N>
-CM_API bool
-read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, uint global_offset, vector<uint, N> &element_offset, vector_ref<T, N> in)
-{
-    return read(buf_id, buf_attrib, global_offset, element_offset.template select<N, 1>(), in);
-}
-
-template <typename T, uint N>
-CM_API bool
-read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, uint global_offset, vector_ref<uint, N> element_offset, vector<T, N> &in)
-{
-    return read(buf_id, buf_attrib, global_offset, element_offset, in.template select<N, 1>());
-}
-
-template <typename T, uint N>
-CM_API bool
-read(SurfaceIndex & buf_id, uint global_offset, vector_ref<uint, N> element_offset, vector_ref<T, N> in)
-{
-    return read(buf_id, GENX_MODIFIED, global_offset, element_offset, in);
-}
-
-template <typename T, uint N>
-CM_API bool
-read(SurfaceIndex & buf_id, uint global_offset, vector<uint, N> &element_offset, vector<T, N> &in)
-{
-    return read(buf_id, GENX_MODIFIED, global_offset, element_offset, in);
-}
-
-template <typename T, uint N>
-CM_API bool
-read(SurfaceIndex & buf_id, uint global_offset, vector<uint, N> &element_offset, vector_ref<T, N> in)
-{
-    return read(buf_id, GENX_MODIFIED, global_offset, element_offset, in);
-}
-
-template <typename T, uint N>
-CM_API bool
-read(SurfaceIndex & buf_id, uint global_offset, vector_ref<uint, N> element_offset, vector<T, N> &in)
-{
-    return read(buf_id, GENX_MODIFIED, global_offset, element_offset, in);
-}
-
-/* This funtion reads HWord Block data from genx dataport */
-template <typename T, uint S>
-CM_API bool
-cm_hword_read(SurfaceIndex & buf_id, int offset, vector<T,S> &in)
-{
-    return cm_hword_read(buf_id, GENX_MODIFIED, offset, in);
-}
-
-/* This funtion reads HWord Block data from genx dataport */
-template <typename T, uint S>
-CM_API bool
-cm_hword_read(SurfaceIndex & buf_id, int offset, vector_ref<T,S> in)
-{
-    return cm_hword_read(buf_id, GENX_MODIFIED, offset, in);
-}
-
-/* This funtion reads HWord Block data from genx dataport */
-template <typename T, uint S>
-CM_API bool
-cm_hword_read(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, int offset, vector<T,S> &in)
-{
-    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-        CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
-
-    if(buff_iter == CmEmulSys::iobuffers.end())
-    {
-        printf("%s:%d - Error reading buffer %d: buffer %d is not registered!\n",
-               __FUNCTION__,
-               __LINE__,
-               buf_id.get_data()&0xFF,
-               buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
-    }
-
-    if ((offset & 0x1f) != 0) /// 0x1f = 011111B = 31
-    {
-        printf("%s:%d - Error reading buffer %d: offset must be 32-byte aligned! offset = %d\n",
-               __FUNCTION__,
-               __LINE__,
-               buf_id.get_data()&0xFF,
-               offset);
-        exit(EXIT_FAILURE);
-    }
-
-    int sizeofT = sizeof(T);
-    int numbytes = sizeofT * S;
-
-    /// VMIT-6506
-    if (numbytes != 32         // 1-HWORD
-        && numbytes != 32 * 2  // 2-HWORD
-        && numbytes != 32 * 4  // 4-HWORD
-        && numbytes != 32 * 8) // 8-HWORD
-    {
-        printf("%s:%d - Error reading buffer %d: read size must be 1/2/4/8-HWORD (32/64/128/256 Bytes)!! numbytes = %d\n",
-               __FUNCTION__,
-               __LINE__,
-               buf_id.get_data()&0xFF,
-               numbytes);
-        exit(EXIT_FAILURE);
-    }
 
-    if (buff_iter->height != 1)
-    {
-        printf("%s:%d - Height of read-surface is not 1!! (height = %d)\n",
-               __FUNCTION__,
-               __LINE__,
-               buff_iter->height);
-        exit(EXIT_FAILURE);
-    }
-
-    char* buff;
-
-    if(buf_attrib == GENX_MODIFIED
-       || buf_attrib == GENX_MODIFIED_DWALIGNED
-        )
-    {
-        if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            printf("%s:%d - Error reading buffer MODIFIED(%d): the registered buffer type is not INPUT_OUTPUT_BUFFER!\n",
-                   __FUNCTION__,
-                   __LINE__,
-                   buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-        }
-        buff = (char*) buff_iter->p_volatile;
-    }
-    else
-    {
-        buff = (char*) buff_iter->p;
-    }
-
-    uint pos = offset;
-
-    for (int i = 0; i < S; i++)
-    {
-        if (pos >= buff_iter->width)
-        {
-            in(i) = 0;
-        }
-        else
-        {
-            in(i) = *((T*)(buff + pos));
-        }
-
-        pos += sizeofT;
-        numbytes -= sizeofT;
-    }
-
-    if (numbytes != 0)
-    {
-        printf("%s:%d - Number of Bytes mismatch!!\n",
-               __FUNCTION__,
-               __LINE__);
-        exit(EXIT_FAILURE);
-    }
-
-    return true;
-}
-
-/* This funtion reads scattered DWords from genx dataport */
-template <typename T, uint N>
-CM_API bool
-read_scaled(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, uint global_offset, vector_ref<uint, N> element_offset, vector_ref<T, N> in)
-{
-    static const bool conformable1 = is_fp_or_dword_type<T>::value;
-    uint i;
-    uint pos;
-    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-        CmEmulSys::search_buffer(buf_id.get_data() & 0xFF);
-
-    if (buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data() & 0xFF, buf_id.get_data() & 0xFF);
-        exit(EXIT_FAILURE);
-    }
-
-    if (buf_attrib != GENX_MODIFIED && buf_attrib != GENX_CONSTANT) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: incorrect buffer attribute %d!\n", buf_id.get_data() & 0xFF, buf_attrib);
-        exit(EXIT_FAILURE);
-    }
-
-    int width = buff_iter->width;
-    int height = buff_iter->height;
-
-    {
-        if (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("reading buffer MODIFIED(%d): the registered buffer type is not INPUT_OUTPUT_BUFFER!\n", buf_id.get_data() & 0xFF);
-            exit(EXIT_FAILURE);
-        }
-    }
-
-    for (i = 0; i < N; i++) {
-        SIMDCF_ELEMENT_SKIP(i);
-        pos = global_offset + element_offset(i);
-        if (pos >= width * height) {
-            in(i) = width * height - 1;
-        }
-        else {
-            {
-                in(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-            }
-        }
-    }
-
-    return true;
-}
-
-template <typename T, uint N>
-CM_API bool
-read_scaled(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, uint global_offset, vector<uint, N> &element_offset, vector<T, N> &in)
-{
-    return read_scaled(buf_id, buf_attrib, global_offset, element_offset.template select<N, 1>(), in.template select<N, 1>());
-}
-
-template <typename T, uint N>
-CM_API bool
-read_scaled(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, uint global_offset, vector<uint, N> &element_offset, vector_ref<T, N> in)
-{
-    return read_scaled(buf_id, buf_attrib, global_offset, element_offset.template select<N, 1>(), in);
-}
-
-template <typename T, uint N>
-CM_API bool
-read_scaled(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, uint global_offset, vector_ref<uint, N> element_offset, vector<T, N> &in)
-{
-    return read_scaled(buf_id, buf_attrib, global_offset, element_offset, in.template select<N, 1>());
-}
-
-template <typename T, uint N>
-CM_API bool
-read_scaled(SurfaceIndex & buf_id, uint global_offset, vector_ref<uint, N> element_offset, vector_ref<T, N> in)
-{
-    return read_scaled(buf_id, GENX_MODIFIED, global_offset, element_offset, in);
-}
-
-template <typename T, uint N>
-CM_API bool
-read_scaled(SurfaceIndex & buf_id, uint global_offset, vector<uint, N> &element_offset, vector<T, N> &in)
-{
-    return read_scaled(buf_id, GENX_MODIFIED, global_offset, element_offset, in);
-}
-
-template <typename T, uint N>
-CM_API bool
-read_scaled(SurfaceIndex & buf_id, uint global_offset, vector<uint, N> &element_offset, vector_ref<T, N> in)
-{
-    return read_scaled(buf_id, GENX_MODIFIED, global_offset, element_offset, in);
-}
-
-template <typename T, uint N>
-CM_API bool
-read_scaled(SurfaceIndex & buf_id, uint global_offset, vector_ref<uint, N> element_offset, vector<T, N> &in)
-{
-    return read_scaled(buf_id, GENX_MODIFIED, global_offset, element_offset, in);
-}
-
-/* This funtion writes scattered DWords to genx dataport */
-template <typename T, uint N>
-CM_API bool
-write(SurfaceIndex & buf_id, uint global_offset, const vector_ref<uint, N> element_offset, const vector_ref<T, N> out)
-{
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
-    static const bool conformable1 = is_fp_or_dword_type<T>::value;
-    uint i;
-    uint pos;
-    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
-
-    if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
-    }
-
-    int width = buff_iter->width;
-    int height = buff_iter->height;
-
-    if((buff_iter->bclass != GEN4_OUTPUT_BUFFER) &&
-        (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER)) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: incorrect buffer type!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-    }
-
-    size_t sizeOfT = sizeof(T);
-    for (i = 0; i < N; i++) {
-        SIMDCF_ELEMENT_SKIP(i);
-        pos = (global_offset + element_offset(i))*sizeOfT;
-        if (pos >= width*height) {
-            continue;
-        }
-        if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            *((T*)( (char*)buff_iter->p_volatile + pos )) = out(i);
-        } else {
-            *((T*)( (char*)buff_iter->p + pos )) = out(i);
-        }
-    }
-
-    return true;
-}
-
-template <typename T, uint N>
-CM_API bool
-write(SurfaceIndex & buf_id, uint global_offset, const vector<uint, N> &element_offset, const vector<T, N> &out)
-{
-    return write(buf_id, global_offset, element_offset.template select<N,1>(), out.template select<N,1>());
-}
-
-template <typename T, uint N>
-CM_API bool
-write(SurfaceIndex & buf_id, uint global_offset, const vector<uint, N> &element_offset, const vector_ref<T, N> out)
-{
-    return write(buf_id, global_offset, element_offset.template select<N, 1>(), out);
-}
-
-template <typename T, uint N>
-CM_API bool
-write(SurfaceIndex & buf_id, uint global_offset, const vector_ref<uint, N> element_offset, const vector<T, N> &out)
-{
-    return write(buf_id, global_offset, element_offset, out.template select<N, 1>());
-}
-
-template <typename T, uint N>
-CM_API bool
-write_scaled(SurfaceIndex & buf_id, uint global_offset, vector_ref<uint, N> element_offset, vector_ref<T, N> out)
-{
-    static const bool conformable1 = is_fp_or_dword_type<T>::value;
-    uint i;
-    uint pos;
-    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-        CmEmulSys::search_buffer(buf_id.get_data() & 0xFF);
-
-    if (buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data() & 0xFF, buf_id.get_data() & 0xFF);
-        exit(EXIT_FAILURE);
-    }
-
-    int width = buff_iter->width;
-    int height = buff_iter->height;
-
-    if ((buff_iter->bclass != GEN4_OUTPUT_BUFFER) &&
-        (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER)) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: incorrect buffer type!\n", buf_id.get_data() & 0xFF);
-        exit(EXIT_FAILURE);
-    }
-
-    for (i = 0; i < N; i++) {
-        SIMDCF_ELEMENT_SKIP(i);
-        pos = global_offset + element_offset(i);
-        if (pos >= width * height) {
-            continue;
-        }
-        if (buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            *((T*)((char*)buff_iter->p_volatile + pos)) = out(i);
-        }
-        else {
-            *((T*)((char*)buff_iter->p + pos)) = out(i);
-        }
-    }
-
-    return true;
-}
-
-template <typename T, uint N>
-CM_API bool
-write_scaled(SurfaceIndex & buf_id, uint global_offset, vector<uint, N> &element_offset, vector<T, N> &out)
-{
-    return write_scaled(buf_id, global_offset, element_offset.template select<N, 1>(), out.template select<N, 1>());
-}
-
-template <typename T, uint N>
-CM_API bool
-write_scaled(SurfaceIndex & buf_id, uint global_offset, vector<uint, N> &element_offset, vector_ref<T, N> out)
-{
-    return write_scaled(buf_id, global_offset, element_offset.template select<N, 1>(), out);
-}
-
-template <typename T, uint N>
-CM_API bool
-write_scaled(SurfaceIndex & buf_id, uint global_offset, vector_ref<uint, N> element_offset, vector<T, N> &out)
-{
-    return write_scaled(buf_id, global_offset, element_offset, out.template select<N, 1>());
-}
-
-/* This funtion performs atomic scattered DWord write to genx dataport */
-template <typename T, uint N>
-CM_API bool
-write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint, 8> &element_offset, vector <T, N> &src, vector<T, 8> &v)
-{
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
-    static const bool conformable1 = is_dword_type<T>::value;
-    uint i;
-    uint pos;
-    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
-
-    if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
-    }
-
-    int width = buff_iter->width;
-    int height = buff_iter->height;
-
-    //assert(height == 1);
-
-    if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-    }
-
-    if(op > ATOMIC_FMAX) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
-    }
-
-    if(op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) {
-        if(N != 16) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-        }
-    } else {
-        if(N != 8) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-        }
-    }
-
-    // InitializeCriticalSection(&dataport_cs);
-
-    for (i = 0; i < 8; i++) {
-        SIMDCF_ELEMENT_SKIP(i);
-        pos = (global_offset + element_offset(i))*4;
-        if (pos >= width*height) {
-            continue;
-        }
-        if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            switch (op) {
-                case ATOMIC_ADD:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + src(i);
-                    break;
-                case ATOMIC_SUB:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - src(i);
-                    break;
-                case ATOMIC_INC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + 1;
-                    break;
-                case ATOMIC_DEC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - 1;
-                    break;
-                case ATOMIC_MIN:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v(i) <= (uint) src(i))? v(i): src(i));
-                    }
-                    break;
-                case ATOMIC_MAX:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v(i) >= (uint) src(i))? v(i): src(i));
-                    }
-                    break;
-                case ATOMIC_XCHG:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = src(i);
-                    break;
-                case ATOMIC_CMPXCHG:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = ((v(i) == src(i+8))? src(i): v(i));
-                    break;
-                case ATOMIC_AND:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) & (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) & (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_OR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) | (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) | (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_XOR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) ^ (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) ^ (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_MINSINT:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v(i) <= (int) src(i))? v(i): src(i));
-                    break;
-                case ATOMIC_MAXSINT:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v(i) >= (int) src(i))? v(i): src(i));
-                    break;
-                case ATOMIC_FADD:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v(i) + (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FSUB:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v(i) - (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FCMPWR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = ((v(i) == src(i)) ? src(i + 8) : v(i));
-                    }
-                    break;
-                case ATOMIC_FMIN:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v(i) <= (float)src(i)) ? v(i) : src(i));
-                    }
-                    break;
-                case ATOMIC_FMAX:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v(i) >= (float)src(i)) ? v(i) : src(i));
-                    }
-                    break;
-                default:
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-                    exit(EXIT_FAILURE);
-            }
-        } else {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-        }
-    }
-
-    // DeleteCriticalSection(&dataport_cs);
-
-    return true;
-}
-
-template <typename T, uint N>
-CM_API bool
-write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint, 8> &element_offset, vector <T, N> &src, vector_ref<T, 8> v)
-{
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
-    static const bool conformable1 = is_dword_type<T>::value;
-    uint i;
-    uint pos;
-    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
-
-    if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
-    }
-
-    int width = buff_iter->width;
-    int height = buff_iter->height;
-
-    //assert(height == 1);
-
-    if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-    }
-
-    if(op > ATOMIC_FMAX) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
-    }
-
-    if(op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) {
-        if(N != 16) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-        }
-    } else {
-        if(N != 8) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-        }
-    }
-
-    // InitializeCriticalSection(&dataport_cs);
-
-    for (i = 0; i < 8; i++) {
-        SIMDCF_ELEMENT_SKIP(i);
-        pos = (global_offset + element_offset(i))*4;
-        if (pos >= width*height) {
-            continue;
-        }
-        if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            switch (op) {
-                case ATOMIC_ADD:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + src(i);
-                    break;
-                case ATOMIC_SUB:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - src(i);
-                    break;
-                case ATOMIC_INC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + 1;
-                    break;
-                case ATOMIC_DEC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - 1;
-                    break;
-                case ATOMIC_MIN:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v(i) <= (uint) src(i))? v(i): src(i));
-                    }
-                    break;
-                case ATOMIC_MAX:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v(i) >= (uint) src(i))? v(i): src(i));
-                    }
-                    break;
-                case ATOMIC_XCHG:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = src(i);
-                    break;
-                case ATOMIC_CMPXCHG:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = ((v(i) == src(i+8))? src(i): v(i));
-                    break;
-                case ATOMIC_AND:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) & (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) & (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_OR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) | (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) | (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_XOR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) ^ (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) ^ (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_MINSINT:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v(i) <= (int) src(i))? v(i): src(i));
-                    break;
-                case ATOMIC_MAXSINT:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v(i) >= (int) src(i))? v(i): src(i));
-                    break;
-                case ATOMIC_FADD:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v(i) + (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FSUB:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v(i) - (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FCMPWR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = ((v(i) == src(i)) ? src(i + 8) : v(i));
-                    }
-                    break;
-                case ATOMIC_FMIN:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v(i) <= (float)src(i)) ? v(i) : src(i));
-                    }
-                    break;
-                case ATOMIC_FMAX:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v(i) >= (float)src(i)) ? v(i) : src(i));
-                    }
-                    break;
-                default:
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-                    exit(EXIT_FAILURE);
-            }
-        } else {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-        }
-    }
-
-    // DeleteCriticalSection(&dataport_cs);
-
-    return true;
-}
-
-template <typename T, uint N>
-CM_API bool
-write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint, 8> &element_offset, vector <T, N> &src, int not_used)
-{
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
-    static const bool conformable1 = is_dword_type<T>::value;
-    uint i;
-    uint pos;
-    T v;
-    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
-
-    if (not_used != 0) {
-        printf("write atomic passed destination vec as int but not NULL %x\n", not_used);
-        exit(EXIT_FAILURE);
-    }
-    if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
-    }
-
-    int width = buff_iter->width;
-    int height = buff_iter->height;
-
-    //assert(height == 1);
-
-    if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-    }
-
-    if(op > ATOMIC_FMAX) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
-    }
-
-    if(op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) {
-        if(N != 16) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-        }
-    } else {
-        if(N != 8) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-        }
-    }
-
-    // InitializeCriticalSection(&dataport_cs);
-
-    for (i = 0; i < 8; i++) {
-        SIMDCF_ELEMENT_SKIP(i);
-        pos = (global_offset + element_offset(i))*4;
-        if (pos >= width*height) {
-            continue;
-        }
-        if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            switch (op) {
-                case ATOMIC_ADD:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v + src(i);
-                    break;
-                case ATOMIC_SUB:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v - src(i);
-                    break;
-                case ATOMIC_INC:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v + 1;
-                    break;
-                case ATOMIC_DEC:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v - 1;
-                    break;
-                case ATOMIC_MIN:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v <= (uint) src(i))? v: src(i));
-                    }
-                    break;
-                case ATOMIC_MAX:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v >= (uint) src(i))? v: src(i));
-                    }
-                    break;
-                case ATOMIC_XCHG:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = src(i);
-                    break;
-                case ATOMIC_CMPXCHG:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = ((v == src(i+8))? src(i): v);
-                    break;
-                case ATOMIC_AND:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint) v & (uint) src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int) v & (int) src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_OR:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint) v | (uint) src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int) v | (int) src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_XOR:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint) v ^ (uint) src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int) v ^ (int) src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_MINSINT:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v <= (int) src(i))? v: src(i));
-                    break;
-                case ATOMIC_MAXSINT:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v >= (int) src(i))? v: src(i));
-                    break;
-                case ATOMIC_FADD:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v + (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FSUB:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v - (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FCMPWR:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = ((v == src(i)) ? src(i + 8) : v);
-                    }
-                    break;
-                case ATOMIC_FMIN:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v <= (float)src(i)) ? v : src(i));
-                    }
-                    break;
-                case ATOMIC_FMAX:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v >= (float)src(i)) ? v : src(i));
-                    }
-                    break;
-                default:
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-                    exit(EXIT_FAILURE);
-            }
-        } else {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-        }
+        pos += sizeofT;
+        numbytes -= sizeofT;
     }
 
-    // DeleteCriticalSection(&dataport_cs);
+    if (numbytes != 0)
+    {
+        printf("%s:%d - Number of Bytes mismatch!!\n",
+               __FUNCTION__,
+               __LINE__);
+        exit(EXIT_FAILURE);
+    }
 
     return true;
 }
 
+/* This funtion reads scattered DWords from genx dataport */
 template <typename T, uint N>
 CM_API bool
-write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint, 8> &element_offset, vector_ref <T, N> src, vector<T, 8> &v)
+read_scaled(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, uint global_offset, vector_ref<uint, N> element_offset, vector_ref<T, N> in)
 {
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
-    static const bool conformable1 = is_dword_type<T>::value;
+    static const bool conformable1 = is_fp_or_dword_type<T>::value;
     uint i;
     uint pos;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+        CmEmulSys::search_buffer(buf_id.get_data());
 
-    if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+    if (buff_iter == CmEmulSys::iobuffers.end()) {
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
+
+    if (buf_attrib != GENX_MODIFIED && buf_attrib != GENX_CONSTANT) {
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: incorrect buffer attribute %d!\n", buf_id.get_data(), buf_attrib);
         exit(EXIT_FAILURE);
     }
 
     int width = buff_iter->width;
     int height = buff_iter->height;
 
-    //assert(height == 1);
-
-    if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+    {
+        if (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
+            GFX_EMU_ERROR_MESSAGE("reading buffer MODIFIED(%d): the registered buffer type is not INPUT_OUTPUT_BUFFER!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
+        }
     }
 
-    if(op > ATOMIC_FMAX) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
+    for (i = 0; i < N; i++) {
+        SIMDCF_ELEMENT_SKIP(i);
+        pos = global_offset + element_offset(i);
+        if (pos >= width * height) {
+            in(i) = width * height - 1;
+        }
+        else {
+            {
+                in(i) = *((T*)((char*)buff_iter->p_volatile + pos));
+            }
+        }
+    }
+
+    return true;
+}
+
+template <typename T, uint N>
+CM_API bool
+read_scaled(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, uint global_offset, vector<uint, N> &element_offset, vector<T, N> &in)
+{
+    return read_scaled(buf_id, buf_attrib, global_offset, element_offset.template select<N, 1>(), in.template select<N, 1>());
+}
+
+template <typename T, uint N>
+CM_API bool
+read_scaled(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, uint global_offset, vector<uint, N> &element_offset, vector_ref<T, N> in)
+{
+    return read_scaled(buf_id, buf_attrib, global_offset, element_offset.template select<N, 1>(), in);
+}
+
+template <typename T, uint N>
+CM_API bool
+read_scaled(SurfaceIndex & buf_id, CmBufferAttrib buf_attrib, uint global_offset, vector_ref<uint, N> element_offset, vector<T, N> &in)
+{
+    return read_scaled(buf_id, buf_attrib, global_offset, element_offset, in.template select<N, 1>());
+}
+
+template <typename T, uint N>
+CM_API bool
+read_scaled(SurfaceIndex & buf_id, uint global_offset, vector_ref<uint, N> element_offset, vector_ref<T, N> in)
+{
+    return read_scaled(buf_id, GENX_MODIFIED, global_offset, element_offset, in);
+}
+
+template <typename T, uint N>
+CM_API bool
+read_scaled(SurfaceIndex & buf_id, uint global_offset, vector<uint, N> &element_offset, vector<T, N> &in)
+{
+    return read_scaled(buf_id, GENX_MODIFIED, global_offset, element_offset, in);
+}
+
+template <typename T, uint N>
+CM_API bool
+read_scaled(SurfaceIndex & buf_id, uint global_offset, vector<uint, N> &element_offset, vector_ref<T, N> in)
+{
+    return read_scaled(buf_id, GENX_MODIFIED, global_offset, element_offset, in);
+}
+
+template <typename T, uint N>
+CM_API bool
+read_scaled(SurfaceIndex & buf_id, uint global_offset, vector_ref<uint, N> element_offset, vector<T, N> &in)
+{
+    return read_scaled(buf_id, GENX_MODIFIED, global_offset, element_offset, in);
+}
+
+/* This funtion writes scattered DWords to genx dataport */
+template <typename T, uint N>
+CM_API bool
+write(SurfaceIndex & buf_id, uint global_offset, const vector_ref<uint, N> element_offset, const vector_ref<T, N> out)
+{
+	std::unique_lock<std::mutex> lk(mutexForWrite);
+
+    static const bool conformable1 = is_fp_or_dword_type<T>::value;
+    uint i;
+    uint pos;
+    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
+                                    CmEmulSys::search_buffer(buf_id.get_data());
+
+    if(buff_iter == CmEmulSys::iobuffers.end()) {
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
-    if(op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) {
-        if(N != 16) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-        }
-    } else {
-        if(N != 8) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
+    int width = buff_iter->width;
+    int height = buff_iter->height;
+
+    if((buff_iter->bclass != GEN4_OUTPUT_BUFFER) &&
+        (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER)) {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: incorrect buffer type!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
-        }
     }
 
-    // InitializeCriticalSection(&dataport_cs);
-
-    for (i = 0; i < 8; i++) {
+    size_t sizeOfT = sizeof(T);
+    for (i = 0; i < N; i++) {
         SIMDCF_ELEMENT_SKIP(i);
-        pos = (global_offset + element_offset(i))*4;
+        pos = (global_offset + element_offset(i))*sizeOfT;
         if (pos >= width*height) {
             continue;
         }
         if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            switch (op) {
-                case ATOMIC_ADD:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + src(i);
-                    break;
-                case ATOMIC_SUB:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - src(i);
-                    break;
-                case ATOMIC_INC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + 1;
-                    break;
-                case ATOMIC_DEC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - 1;
-                    break;
-                case ATOMIC_MIN:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v(i) <= (uint) src(i))? v(i): src(i));
-                    }
-                    break;
-                case ATOMIC_MAX:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v(i) >= (uint) src(i))? v(i): src(i));
-                    }
-                    break;
-                case ATOMIC_XCHG:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = src(i);
-                    break;
-                case ATOMIC_CMPXCHG:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = ((v(i) == src(i+8))? src(i): v(i));
-                    break;
-                case ATOMIC_AND:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) & (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) & (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_OR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) | (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) | (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_XOR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) ^ (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) ^ (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_MINSINT:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v(i) <= (int) src(i))? v(i): src(i));
-                    break;
-                case ATOMIC_MAXSINT:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v(i) >= (int) src(i))? v(i): src(i));
-                    break;
-                case ATOMIC_FADD:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v(i) + (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FSUB:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v(i) - (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FCMPWR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = ((v(i) == src(i)) ? src(i + 8) : v(i));
-                    }
-                    break;
-                case ATOMIC_FMIN:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v(i) <= (float)src(i)) ? v(i) : src(i));
-                    }
-                    break;
-                case ATOMIC_FMAX:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v(i) >= (float)src(i)) ? v(i) : src(i));
-                    }
-                    break;
-                default:
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-                    exit(EXIT_FAILURE);
-            }
+            *((T*)( (char*)buff_iter->p_volatile + pos )) = out(i);
         } else {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
+            *((T*)( (char*)buff_iter->p + pos )) = out(i);
         }
     }
 
-    // DeleteCriticalSection(&dataport_cs);
+    return true;
+}
+
+template <typename T, uint N>
+CM_API bool
+write(SurfaceIndex & buf_id, uint global_offset, const vector<uint, N> &element_offset, const vector<T, N> &out)
+{
+    return write(buf_id, global_offset, element_offset.template select<N,1>(), out.template select<N,1>());
+}
+
+template <typename T, uint N>
+CM_API bool
+write(SurfaceIndex & buf_id, uint global_offset, const vector<uint, N> &element_offset, const vector_ref<T, N> out)
+{
+    return write(buf_id, global_offset, element_offset.template select<N, 1>(), out);
+}
+
+template <typename T, uint N>
+CM_API bool
+write(SurfaceIndex & buf_id, uint global_offset, const vector_ref<uint, N> element_offset, const vector<T, N> &out)
+{
+    return write(buf_id, global_offset, element_offset, out.template select<N, 1>());
+}
+
+template <typename T, uint N>
+CM_API bool
+write_scaled(SurfaceIndex & buf_id, uint global_offset, vector_ref<uint, N> element_offset, vector_ref<T, N> out)
+{
+    static const bool conformable1 = is_fp_or_dword_type<T>::value;
+    uint i;
+    uint pos;
+    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
+        CmEmulSys::search_buffer(buf_id.get_data());
+
+    if (buff_iter == CmEmulSys::iobuffers.end()) {
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
+
+    int width = buff_iter->width;
+    int height = buff_iter->height;
+
+    if ((buff_iter->bclass != GEN4_OUTPUT_BUFFER) &&
+        (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER)) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: incorrect buffer type!\n", buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
+
+    for (i = 0; i < N; i++) {
+        SIMDCF_ELEMENT_SKIP(i);
+        pos = global_offset + element_offset(i);
+        if (pos >= width * height) {
+            continue;
+        }
+        if (buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
+            *((T*)((char*)buff_iter->p_volatile + pos)) = out(i);
+        }
+        else {
+            *((T*)((char*)buff_iter->p + pos)) = out(i);
+        }
+    }
 
     return true;
 }
 
 template <typename T, uint N>
 CM_API bool
-write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint, 8> &element_offset, vector_ref <T, N> src, vector_ref<T, 8> v)
+write_scaled(SurfaceIndex & buf_id, uint global_offset, vector<uint, N> &element_offset, vector<T, N> &out)
 {
-	std::unique_lock<std::mutex> lk(mutexForWrite);
+    return write_scaled(buf_id, global_offset, element_offset.template select<N, 1>(), out.template select<N, 1>());
+}
+
+template <typename T, uint N>
+CM_API bool
+write_scaled(SurfaceIndex & buf_id, uint global_offset, vector<uint, N> &element_offset, vector_ref<T, N> out)
+{
+    return write_scaled(buf_id, global_offset, element_offset.template select<N, 1>(), out);
+}
+
+template <typename T, uint N>
+CM_API bool
+write_scaled(SurfaceIndex & buf_id, uint global_offset, vector_ref<uint, N> element_offset, vector<T, N> &out)
+{
+    return write_scaled(buf_id, global_offset, element_offset, out.template select<N, 1>());
+}
 
+/* This funtion performs atomic scattered DWord write to genx dataport */
+template <typename T, uint N>
+CM_API bool
+write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint, 8> &element_offset, vector <T, N> &src, vector<T, 8> &v)
+{
     static const bool conformable1 = is_dword_type<T>::value;
     uint i;
     uint pos;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -6840,23 +5907,23 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint,
     //assert(height == 1);
 
     if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
     }
 
     if(op > ATOMIC_FMAX) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if(op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) {
         if(N != 16) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     } else {
         if(N != 8) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     }
@@ -6870,135 +5937,10 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint,
             continue;
         }
         if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            switch (op) {
-                case ATOMIC_ADD:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + src(i);
-                    break;
-                case ATOMIC_SUB:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - src(i);
-                    break;
-                case ATOMIC_INC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + 1;
-                    break;
-                case ATOMIC_DEC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - 1;
-                    break;
-                case ATOMIC_MIN:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v(i) <= (uint) src(i))? v(i): src(i));
-                    }
-                    break;
-                case ATOMIC_MAX:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v(i) >= (uint) src(i))? v(i): src(i));
-                    }
-                    break;
-                case ATOMIC_XCHG:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = src(i);
-                    break;
-                case ATOMIC_CMPXCHG:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = ((v(i) == src(i+8))? src(i): v(i));
-                    break;
-                case ATOMIC_AND:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) & (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) & (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_OR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) | (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) | (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_XOR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) ^ (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) ^ (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_MINSINT:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v(i) <= (int) src(i))? v(i): src(i));
-                    break;
-                case ATOMIC_MAXSINT:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v(i) >= (int) src(i))? v(i): src(i));
-                    break;
-                case ATOMIC_FADD:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v(i) + (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FSUB:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v(i) - (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FCMPWR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = ((v(i) == src(i)) ? src(i + 8) : v(i));
-                    }
-                    break;
-                case ATOMIC_FMIN:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v(i) <= (float)src(i)) ? v(i) : src(i));
-                    }
-                    break;
-                case ATOMIC_FMAX:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v(i) >= (float)src(i)) ? v(i) : src(i));
-                    }
-                    break;
-                default:
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-                    exit(EXIT_FAILURE);
-            }
+            v(i) = CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), (T)src(i),
+                                        (T)((op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) ? src(i + 8) : 0), buf_id.get_data());
         } else {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     }
@@ -7010,23 +5952,16 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint,
 
 template <typename T, uint N>
 CM_API bool
-write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint, 8> &element_offset, vector_ref <T, N> src, int not_used)
+write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint, 8> &element_offset, vector <T, N> &src, vector_ref<T, 8> v)
 {
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
     static const bool conformable1 = is_dword_type<T>::value;
     uint i;
     uint pos;
-    T v;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
-    if (not_used != 0) {
-        printf("write atomic passed destination vec as int but not NULL %x\n", not_used);
-        exit(EXIT_FAILURE);
-    }
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -7036,23 +5971,23 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint,
     //assert(height == 1);
 
     if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
     }
 
     if(op > ATOMIC_FMAX) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if(op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) {
         if(N != 16) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     } else {
         if(N != 8) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     }
@@ -7066,135 +6001,78 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint,
             continue;
         }
         if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            switch (op) {
-                case ATOMIC_ADD:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v + src(i);
-                    break;
-                case ATOMIC_SUB:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v - src(i);
-                    break;
-                case ATOMIC_INC:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v + 1;
-                    break;
-                case ATOMIC_DEC:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v - 1;
-                    break;
-                case ATOMIC_MIN:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v <= (uint) src(i))? v: src(i));
-                    }
-                    break;
-                case ATOMIC_MAX:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v >= (uint) src(i))? v: src(i));
-                    }
-                    break;
-                case ATOMIC_XCHG:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = src(i);
-                    break;
-                case ATOMIC_CMPXCHG:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = ((v == src(i+8))? src(i): v);
-                    break;
-                case ATOMIC_AND:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v & (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v & (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_OR:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v | (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v | (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_XOR:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v ^ (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v ^ (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_MINSINT:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v <= (int) src(i))? v: src(i));
-                    break;
-                case ATOMIC_MAXSINT:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v >= (int) src(i))? v: src(i));
-                    break;
-                case ATOMIC_FADD:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v + (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FSUB:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v - (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FCMPWR:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = ((v == src(i)) ? src(i + 8) : v);
-                    }
-                    break;
-                case ATOMIC_FMIN:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v <= (float)src(i)) ? v : src(i));
-                    }
-                    break;
-                case ATOMIC_FMAX:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v >= (float)src(i)) ? v : src(i));
-                    }
-                    break;
-                default:
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-                    exit(EXIT_FAILURE);
-            }
+            v(i) = CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), (T)src(i),
+                                        (T)((op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) ? src(i + 8) : 0), buf_id.get_data());
+        } else {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // DeleteCriticalSection(&dataport_cs);
+
+    return true;
+}
+
+template <typename T, uint N>
+CM_API bool
+write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint, 8> &element_offset, vector <T, N> &src, int not_used)
+{
+    static const bool conformable1 = is_dword_type<T>::value;
+    uint i;
+    uint pos;
+    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
+                                    CmEmulSys::search_buffer(buf_id.get_data());
+
+    if (not_used != 0) {
+        printf("write atomic passed destination vec as int but not NULL %x\n", not_used);
+        exit(EXIT_FAILURE);
+    }
+    if(buff_iter == CmEmulSys::iobuffers.end()) {
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
+
+    int width = buff_iter->width;
+    int height = buff_iter->height;
+
+    //assert(height == 1);
+
+    if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+    }
+
+    if(op > ATOMIC_FMAX) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
+
+    if(op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) {
+        if(N != 16) {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        if(N != 8) {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // InitializeCriticalSection(&dataport_cs);
+
+    for (i = 0; i < 8; i++) {
+        SIMDCF_ELEMENT_SKIP(i);
+        pos = (global_offset + element_offset(i))*4;
+        if (pos >= width*height) {
+            continue;
+        }
+        if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
+            CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), (T)src(i),
+                                 (T)((op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) ? src(i + 8) : 0), buf_id.get_data());
         } else {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     }
@@ -7206,18 +6084,16 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint,
 
 template <typename T, uint N>
 CM_API bool
-write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<uint, 8> element_offset, vector <T, N> &src, vector<T, 8> &v)
+write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint, 8> &element_offset, vector_ref <T, N> src, vector<T, 8> &v)
 {
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
     static const bool conformable1 = is_dword_type<T>::value;
     uint i;
     uint pos;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -7227,23 +6103,23 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<u
     //assert(height == 1);
 
     if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
     }
 
     if(op > ATOMIC_FMAX) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if(op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) {
         if(N != 16) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     } else {
         if(N != 8) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     }
@@ -7257,135 +6133,10 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<u
             continue;
         }
         if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            switch (op) {
-                case ATOMIC_ADD:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + src(i);
-                    break;
-                case ATOMIC_SUB:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - src(i);
-                    break;
-                case ATOMIC_INC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + 1;
-                    break;
-                case ATOMIC_DEC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - 1;
-                    break;
-                case ATOMIC_MIN:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v(i) <= (uint) src(i))? v(i): src(i));
-                    }
-                    break;
-                case ATOMIC_MAX:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v(i) >= (uint) src(i))? v(i): src(i));
-                    }
-                    break;
-                case ATOMIC_XCHG:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = src(i);
-                    break;
-                case ATOMIC_CMPXCHG:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = ((v(i) == src(i+8))? src(i): v(i));
-                    break;
-                case ATOMIC_AND:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) & (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) & (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_OR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) | (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) | (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_XOR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) ^ (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) ^ (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_MINSINT:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v(i) <= (int) src(i))? v(i): src(i));
-                    break;
-                case ATOMIC_MAXSINT:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v(i) >= (int) src(i))? v(i): src(i));
-                    break;
-                case ATOMIC_FADD:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v(i) + (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FSUB:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v(i) - (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FCMPWR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = ((v(i) == src(i)) ? src(i + 8) : v(i));
-                    }
-                    break;
-                case ATOMIC_FMIN:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v(i) <= (float)src(i)) ? v(i) : src(i));
-                    }
-                    break;
-                case ATOMIC_FMAX:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v(i) >= (float)src(i)) ? v(i) : src(i));
-                    }
-                    break;
-                default:
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-                    exit(EXIT_FAILURE);
-            }
+            v(i) = CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), (T)src(i),
+                                        (T)((op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) ? src(i + 8) : 0), buf_id.get_data());
         } else {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     }
@@ -7397,18 +6148,16 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<u
 
 template <typename T, uint N>
 CM_API bool
-write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<uint, 8> element_offset, vector <T, N> &src, vector_ref<T, 8> v)
+write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint, 8> &element_offset, vector_ref <T, N> src, vector_ref<T, 8> v)
 {
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
     static const bool conformable1 = is_dword_type<T>::value;
     uint i;
     uint pos;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -7418,23 +6167,23 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<u
     //assert(height == 1);
 
     if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
     }
 
     if(op > ATOMIC_FMAX) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if(op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) {
         if(N != 16) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     } else {
         if(N != 8) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     }
@@ -7448,135 +6197,78 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<u
             continue;
         }
         if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            switch (op) {
-                case ATOMIC_ADD:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + src(i);
-                    break;
-                case ATOMIC_SUB:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - src(i);
-                    break;
-                case ATOMIC_INC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + 1;
-                    break;
-                case ATOMIC_DEC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - 1;
-                    break;
-                case ATOMIC_MIN:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v(i) <= (uint) src(i))? v(i): src(i));
-                    }
-                    break;
-                case ATOMIC_MAX:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v(i) >= (uint) src(i))? v(i): src(i));
-                    }
-                    break;
-                case ATOMIC_XCHG:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = src(i);
-                    break;
-                case ATOMIC_CMPXCHG:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = ((v(i) == src(i+8))? src(i): v(i));
-                    break;
-                case ATOMIC_AND:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) & (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) & (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_OR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) | (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) | (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_XOR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) ^ (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) ^ (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_MINSINT:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v(i) <= (int) src(i))? v(i): src(i));
-                    break;
-                case ATOMIC_MAXSINT:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v(i) >= (int) src(i))? v(i): src(i));
-                    break;
-                case ATOMIC_FADD:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v(i) + (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FSUB:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v(i) - (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FCMPWR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = ((v(i) == src(i)) ? src(i + 8) : v(i));
-                    }
-                    break;
-                case ATOMIC_FMIN:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v(i) <= (float)src(i)) ? v(i) : src(i));
-                    }
-                    break;
-                case ATOMIC_FMAX:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v(i) >= (float)src(i)) ? v(i) : src(i));
-                    }
-                    break;
-                default:
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-                    exit(EXIT_FAILURE);
-            }
+            v(i) = CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), (T)src(i),
+                                        (T)((op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) ? src(i + 8) : 0), buf_id.get_data());
+        } else {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // DeleteCriticalSection(&dataport_cs);
+
+    return true;
+}
+
+template <typename T, uint N>
+CM_API bool
+write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint, 8> &element_offset, vector_ref <T, N> src, int not_used)
+{
+    static const bool conformable1 = is_dword_type<T>::value;
+    uint i;
+    uint pos;
+    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
+                                    CmEmulSys::search_buffer(buf_id.get_data());
+
+    if (not_used != 0) {
+        printf("write atomic passed destination vec as int but not NULL %x\n", not_used);
+        exit(EXIT_FAILURE);
+    }
+    if(buff_iter == CmEmulSys::iobuffers.end()) {
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
+
+    int width = buff_iter->width;
+    int height = buff_iter->height;
+
+    //assert(height == 1);
+
+    if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+    }
+
+    if(op > ATOMIC_FMAX) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
+
+    if(op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) {
+        if(N != 16) {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        if(N != 8) {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // InitializeCriticalSection(&dataport_cs);
+
+    for (i = 0; i < 8; i++) {
+        SIMDCF_ELEMENT_SKIP(i);
+        pos = (global_offset + element_offset(i))*4;
+        if (pos >= width*height) {
+            continue;
+        }
+        if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
+            CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), (T)src(i),
+                                 (T)((op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) ? src(i + 8) : 0), buf_id.get_data());
         } else {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     }
@@ -7588,23 +6280,16 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<u
 
 template <typename T, uint N>
 CM_API bool
-write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<uint, 8> element_offset, vector <T, N> &src, int not_used)
+write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<uint, 8> element_offset, vector <T, N> &src, vector<T, 8> &v)
 {
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
     static const bool conformable1 = is_dword_type<T>::value;
     uint i;
     uint pos;
-    T v;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
-    if (not_used != 0) {
-        printf("write atomic passed destination vec as int but not NULL %x\n", not_used);
-        exit(EXIT_FAILURE);
-    }
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -7614,23 +6299,23 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<u
     //assert(height == 1);
 
     if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
     }
 
     if(op > ATOMIC_FMAX) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if(op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) {
         if(N != 16) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     } else {
         if(N != 8) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     }
@@ -7644,135 +6329,10 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<u
             continue;
         }
         if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            switch (op) {
-                case ATOMIC_ADD:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v + src(i);
-                    break;
-                case ATOMIC_SUB:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v - src(i);
-                    break;
-                case ATOMIC_INC:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v + 1;
-                    break;
-                case ATOMIC_DEC:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v - 1;
-                    break;
-                case ATOMIC_MIN:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v <= (uint) src(i))? v: src(i));
-                    }
-                    break;
-                case ATOMIC_MAX:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v >= (uint) src(i))? v: src(i));
-                    }
-                    break;
-                case ATOMIC_XCHG:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = src(i);
-                    break;
-                case ATOMIC_CMPXCHG:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = ((v == src(i+8))? src(i): v);
-                    break;
-                case ATOMIC_AND:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v & (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v & (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_OR:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v | (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v | (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_XOR:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v ^ (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v ^ (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_MINSINT:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v <= (int) src(i))? v: src(i));
-                    break;
-                case ATOMIC_MAXSINT:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v >= (int) src(i))? v: src(i));
-                    break;
-                case ATOMIC_FADD:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v + (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FSUB:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v - (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FCMPWR:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = ((v == src(i)) ? src(i + 8) : v);
-                    }
-                    break;
-                case ATOMIC_FMIN:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v <= (float)src(i)) ? v : src(i));
-                    }
-                    break;
-                case ATOMIC_FMAX:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v >= (float)src(i)) ? v : src(i));
-                    }
-                    break;
-                default:
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-                    exit(EXIT_FAILURE);
-            }
+            v(i) = CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), (T)src(i),
+                                        (T)((op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) ? src(i + 8) : 0), buf_id.get_data());
         } else {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     }
@@ -7784,18 +6344,16 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<u
 
 template <typename T, uint N>
 CM_API bool
-write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<uint, 8> element_offset, vector_ref <T, N> src, vector<T, 8> &v)
+write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<uint, 8> element_offset, vector <T, N> &src, vector_ref<T, 8> v)
 {
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
     static const bool conformable1 = is_dword_type<T>::value;
     uint i;
     uint pos;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -7805,23 +6363,23 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<u
     //assert(height == 1);
 
     if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
     }
 
     if(op > ATOMIC_FMAX) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if(op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) {
         if(N != 16) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     } else {
         if(N != 8) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     }
@@ -7835,135 +6393,142 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<u
             continue;
         }
         if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            switch (op) {
-                case ATOMIC_ADD:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + src(i);
-                    break;
-                case ATOMIC_SUB:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - src(i);
-                    break;
-                case ATOMIC_INC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + 1;
-                    break;
-                case ATOMIC_DEC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - 1;
-                    break;
-                case ATOMIC_MIN:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v(i) <= (uint) src(i))? v(i): src(i));
-                    }
-                    break;
-                case ATOMIC_MAX:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v(i) >= (uint) src(i))? v(i): src(i));
-                    }
-                    break;
-                case ATOMIC_XCHG:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = src(i);
-                    break;
-                case ATOMIC_CMPXCHG:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = ((v(i) == src(i+8))? src(i): v(i));
-                    break;
-                case ATOMIC_AND:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) & (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) & (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_OR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) | (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) | (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_XOR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) ^ (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) ^ (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_MINSINT:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v(i) <= (int) src(i))? v(i): src(i));
-                    break;
-                case ATOMIC_MAXSINT:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v(i) >= (int) src(i))? v(i): src(i));
-                    break;
-                case ATOMIC_FADD:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v(i) + (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FSUB:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v(i) - (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FCMPWR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = ((v(i) == src(i)) ? src(i + 8) : v(i));
-                    }
-                    break;
-                case ATOMIC_FMIN:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v(i) <= (float)src(i)) ? v(i) : src(i));
-                    }
-                    break;
-                case ATOMIC_FMAX:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v(i) >= (float)src(i)) ? v(i) : src(i));
-                    }
-                    break;
-                default:
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-                    exit(EXIT_FAILURE);
-            }
+            v(i) = CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), (T)src(i),
+                                        (T)((op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) ? src(i + 8) : 0), buf_id.get_data());
+        } else {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // DeleteCriticalSection(&dataport_cs);
+
+    return true;
+}
+
+template <typename T, uint N>
+CM_API bool
+write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<uint, 8> element_offset, vector <T, N> &src, int not_used)
+{
+    static const bool conformable1 = is_dword_type<T>::value;
+    uint i;
+    uint pos;
+    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
+                                    CmEmulSys::search_buffer(buf_id.get_data());
+
+    if (not_used != 0) {
+        printf("write atomic passed destination vec as int but not NULL %x\n", not_used);
+        exit(EXIT_FAILURE);
+    }
+    if(buff_iter == CmEmulSys::iobuffers.end()) {
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
+
+    int width = buff_iter->width;
+    int height = buff_iter->height;
+
+    //assert(height == 1);
+
+    if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+    }
+
+    if(op > ATOMIC_FMAX) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
+
+    if(op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) {
+        if(N != 16) {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        if(N != 8) {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // InitializeCriticalSection(&dataport_cs);
+
+    for (i = 0; i < 8; i++) {
+        SIMDCF_ELEMENT_SKIP(i);
+        pos = (global_offset + element_offset(i))*4;
+        if (pos >= width*height) {
+            continue;
+        }
+        if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
+            CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), (T)src(i),
+                                 (T)((op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) ? src(i + 8) : 0), buf_id.get_data());
+        } else {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // DeleteCriticalSection(&dataport_cs);
+
+    return true;
+}
+
+template <typename T, uint N>
+CM_API bool
+write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<uint, 8> element_offset, vector_ref <T, N> src, vector<T, 8> &v)
+{
+    static const bool conformable1 = is_dword_type<T>::value;
+    uint i;
+    uint pos;
+    cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
+                                    CmEmulSys::search_buffer(buf_id.get_data());
+
+    if(buff_iter == CmEmulSys::iobuffers.end()) {
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
+
+    int width = buff_iter->width;
+    int height = buff_iter->height;
+
+    //assert(height == 1);
+
+    if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+    }
+
+    if(op > ATOMIC_FMAX) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
+
+    if(op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) {
+        if(N != 16) {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        if(N != 8) {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // InitializeCriticalSection(&dataport_cs);
+
+    for (i = 0; i < 8; i++) {
+        SIMDCF_ELEMENT_SKIP(i);
+        pos = (global_offset + element_offset(i))*4;
+        if (pos >= width*height) {
+            continue;
+        }
+        if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
+            v(i) = CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), (T)src(i),
+                                        (T)((op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) ? src(i + 8) : 0), buf_id.get_data());
         } else {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     }
@@ -7980,15 +6545,13 @@ __write_atomic_impl(vector<ushort, N> mask, SurfaceIndex &buf_id,
                     vector<T, N> src, vector<T, N> src1,
                     vector_ref<T, N> v)
 {
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data() & 0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
     if (buff_iter == CmEmulSys::iobuffers.end()) {
         GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n",
-                buf_id.get_data() & 0xFF,
-                buf_id.get_data() & 0xFF);
+                buf_id.get_data(),
+                buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -7998,16 +6561,17 @@ __write_atomic_impl(vector<ushort, N> mask, SurfaceIndex &buf_id,
     if (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
         GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must \
                 be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n",
-                buf_id.get_data() & 0xFF);
+                buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if (op > ATOMIC_FMAX) {
         GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n",
-                buf_id.get_data() & 0xFF);
+                buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
+    bool updated = false;
     for (int i = 0; i < N; i++) {
         SIMDCF_ELEMENT_SKIP(i);
         if (mask(i) == 0) {
@@ -8019,145 +6583,21 @@ __write_atomic_impl(vector<ushort, N> mask, SurfaceIndex &buf_id,
             continue;
         }
 
-        switch (op) {
-        case ATOMIC_ADD:
-            v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-            *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + src(i);
-            break;
-        case ATOMIC_SUB:
-            v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-            *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - src(i);
-            break;
-        case ATOMIC_INC:
-            v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-            *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + 1;
-            break;
-        case ATOMIC_DEC:
-            v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-            *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - 1;
-            break;
-        case ATOMIC_MIN:
-            v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-            if (!is_fp_type<T>::value) {
-                *((T*)((char*)buff_iter->p_volatile + pos)) =
-                    (((uint)v(i) <= (uint)src(i)) ? v(i) : src(i));
-            }
-            break;
-        case ATOMIC_MAX:
-            v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-            if (!is_fp_type<T>::value) {
-                *((T*)((char*)buff_iter->p_volatile + pos)) =
-                    (((uint)v(i) >= (uint)src(i)) ? v(i) : src(i));
-            }
-            break;
-        case ATOMIC_XCHG:
-            v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-            *((T*)((char*)buff_iter->p_volatile + pos)) = src(i);
-            break;
-        case ATOMIC_CMPXCHG:
-            v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-            *((T*)((char*)buff_iter->p_volatile + pos)) =
-                ((v(i) == src1(i)) ? src(i) : v(i));
-            break;
-        case ATOMIC_AND:
-            v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-            if (std::is_same_v <T, uint>)
-            {
-                *((T*)((char*)buff_iter->p_volatile + pos)) = (uint) v(i) & (uint) src(i);
-            }
-            else if (std::is_same_v <T, int>)
-            {
-                *((T*)((char*)buff_iter->p_volatile + pos)) = (int) v(i) & (int) src(i);
-            }
-            else
-            {
-                GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                exit(EXIT_FAILURE);
-            }
-            break;
-        case ATOMIC_OR:
-            v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-            if (std::is_same_v <T, uint>)
-            {
-                *((T*)((char*)buff_iter->p_volatile + pos)) = (uint) v(i) | (uint) src(i);
-            }
-            else if (std::is_same_v <T, int>)
-            {
-                *((T*)((char*)buff_iter->p_volatile + pos)) = (int) v(i) | (int) src(i);
-            }
-            else
-            {
-                GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                exit(EXIT_FAILURE);
-            }
-            break;
-        case ATOMIC_XOR:
-            v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-            if (std::is_same_v <T, uint>)
-            {
-                *((T*)((char*)buff_iter->p_volatile + pos)) = (uint) v(i) ^ (uint) src(i);
-            }
-            else if (std::is_same_v <T, int>)
-            {
-                *((T*)((char*)buff_iter->p_volatile + pos)) = (int) v(i) ^ (int) src(i);
-            }
-            else
-            {
-                GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                exit(EXIT_FAILURE);
-            }
-            break;
-        case ATOMIC_MINSINT:
-            v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-            *((T*)((char*)buff_iter->p_volatile + pos)) = (((int)v(i) <= (int)src(i)) ? v(i) : src(i));
-            break;
-        case ATOMIC_MAXSINT:
-            v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-            *((T*)((char*)buff_iter->p_volatile + pos)) = (((int)v(i) >= (int)src(i)) ? v(i) : src(i));
-            break;
-        case ATOMIC_FADD:
-            v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-            if (is_fp_type<T>::value) {
-                *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v(i) + (float)src(i);
-            }
-            break;
-        case ATOMIC_FSUB:
-            v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-            if (is_fp_type<T>::value) {
-                *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v(i) - (float)src(i);
-            }
-            break;
-        case ATOMIC_FCMPWR:
-            v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-            if (is_fp_type<T>::value) {
-                *((T*)((char*)buff_iter->p_volatile + pos)) =
-                    ((v(i) == src(i)) ? src1(i) : v(i));
-            }
-            break;
-        case ATOMIC_FMIN:
-            v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-            if (is_fp_type<T>::value) {
-                *((T*)((char*)buff_iter->p_volatile + pos)) =
-                    (((float)v(i) <= (float)src(i)) ? v(i) : src(i));
-            }
-            break;
-        case ATOMIC_FMAX:
-            v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-            if (is_fp_type<T>::value) {
-                *((T*)((char*)buff_iter->p_volatile + pos)) =
-                    (((float)v(i) >= (float)src(i)) ? v(i) : src(i));
-            }
-            break;
-        default:
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n",
-                    buf_id.get_data() & 0xFF);
-            exit(EXIT_FAILURE);
+        T *addr = (T*)((char*)buff_iter->p_volatile + pos);
+        T old = CM_genx_atomic_apply(op, addr, src(i), src1(i), buf_id.get_data());
+        T res = CM_genx_atomic_result(op, old, src(i), src1(i), buf_id.get_data());
+        v(i) = old;
+        // Bitwise so that a NaN left in place does not count as a write.
+        if (std::memcmp(&res, &old, sizeof(T)) != 0) {
+            updated = true;
         }
     }
 
-	lk.unlock();
-    cmrt::this_thread_yield();
-
+    // A call that changed nothing is likely a spin-wait poll, let the
+    // writer it waits for run.
+    if (!updated) {
+        cmrt::this_thread_yield();
+    }
 }
 
 // no return value, one source
@@ -8293,16 +6733,14 @@ template <typename T, uint N>
 CM_API bool
 write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<uint, 8> element_offset, vector_ref <T, N> src, vector_ref<T, 8> v)
 {
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
     static const bool conformable1 = is_dword_type<T>::value;
     int i;
     uint pos;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -8311,166 +6749,41 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<u
 
     //assert(height == 1);
 
-    if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-    }
-
-    if(op > ATOMIC_FMAX) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-        exit(EXIT_FAILURE);
-    }
-
-    if(op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) {
-        if(N != 16) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-        }
-    } else {
-        if(N != 8) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
-            exit(EXIT_FAILURE);
-        }
-    }
-
-    // InitializeCriticalSection(&dataport_cs);
-
-    for (i = 0; i < 8; i++) {
-        SIMDCF_ELEMENT_SKIP(i);
-        pos = (global_offset + element_offset(i))*4;
-        if (pos >= width*height) {
-            continue;
-        }
-        if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            switch (op) {
-                case ATOMIC_ADD:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + src(i);
-                    break;
-                case ATOMIC_SUB:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - src(i);
-                    break;
-                case ATOMIC_INC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + 1;
-                    break;
-                case ATOMIC_DEC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - 1;
-                    break;
-                case ATOMIC_MIN:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v(i) <= (uint) src(i))? v(i): src(i));
-                    }
-                    break;
-                case ATOMIC_MAX:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v(i) >= (uint) src(i))? v(i): src(i));
-                    }
-                    break;
-                case ATOMIC_XCHG:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = src(i);
-                    break;
-                case ATOMIC_CMPXCHG:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = ((v(i) == src(i+8))? src(i): v(i));
-                    break;
-                case ATOMIC_AND:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) & (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) & (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_OR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) | (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) | (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_XOR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v(i) ^ (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v(i) ^ (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_MINSINT:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v(i) <= (int) src(i))? v(i): src(i));
-                    break;
-                case ATOMIC_MAXSINT:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v(i) >= (int) src(i))? v(i): src(i));
-                    break;
-                case ATOMIC_FADD:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v(i) + (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FSUB:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v(i) - (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FCMPWR:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = ((v(i) == src(i)) ? src(i + 8) : v(i));
-                    }
-                    break;
-                case ATOMIC_FMIN:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v(i) <= (float)src(i)) ? v(i) : src(i));
-                    }
-                    break;
-                case ATOMIC_FMAX:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v(i) >= (float)src(i)) ? v(i) : src(i));
-                    }
-                    break;
-                default:
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-                    exit(EXIT_FAILURE);
-            }
+    if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+    }
+
+    if(op > ATOMIC_FMAX) {
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data());
+        exit(EXIT_FAILURE);
+    }
+
+    if(op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) {
+        if(N != 16) {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        if(N != 8) {
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // InitializeCriticalSection(&dataport_cs);
+
+    for (i = 0; i < 8; i++) {
+        SIMDCF_ELEMENT_SKIP(i);
+        pos = (global_offset + element_offset(i))*4;
+        if (pos >= width*height) {
+            continue;
+        }
+        if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
+            v(i) = CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), (T)src(i),
+                                        (T)((op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) ? src(i + 8) : 0), buf_id.get_data());
         } else {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     }
@@ -8484,21 +6797,18 @@ template <typename T, uint N>
 CM_API bool
 write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<uint, 8> element_offset, vector_ref <T, N> src, int not_used)
 {
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
     static const bool conformable1 = is_dword_type<T>::value;
     int i;
     uint pos;
-    T v;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
     if (not_used != 0) {
         printf("write atomic passed destination vec as int but not NULL %x\n", not_used);
         exit(EXIT_FAILURE);
     }
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -8508,23 +6818,23 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<u
     //assert(height == 1);
 
     if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
     }
 
     if(op > ATOMIC_FMAX) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if(op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) {
         if(N != 16) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 16 for DWord atomic write when op is ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     } else {
         if(N != 8) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 8 for DWord atomic write when op is not ATOMIC_CMPXCHG/ATOMIC_FCMPWR!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     }
@@ -8538,135 +6848,10 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<u
             continue;
         }
         if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            switch (op) {
-                case ATOMIC_ADD:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v + src(i);
-                    break;
-                case ATOMIC_SUB:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v - src(i);
-                    break;
-                case ATOMIC_INC:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v + 1;
-                    break;
-                case ATOMIC_DEC:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v - 1;
-                    break;
-                case ATOMIC_MIN:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v <= (uint) src(i))? v: src(i));
-                    }
-                    break;
-                case ATOMIC_MAX:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if(!is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint) v >= (uint) src(i))? v: src(i));
-                    }
-                    break;
-                case ATOMIC_XCHG:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = src(i);
-                    break;
-                case ATOMIC_CMPXCHG:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = ((v == src(i+8))? src(i): v);
-                    break;
-                case ATOMIC_AND:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v & (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v & (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_OR:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v | (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v | (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_XOR:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (std::is_same_v <T, uint>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)v ^ (uint)src(i);
-                    }
-                    else if (std::is_same_v <T, int>)
-                    {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (int)v ^ (int)src(i);
-                    }
-                    else
-                    {
-                        GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                case ATOMIC_MINSINT:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v <= (int) src(i))? v: src(i));
-                    break;
-                case ATOMIC_MAXSINT:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((int) v >= (int) src(i))? v: src(i));
-                    break;
-                case ATOMIC_FADD:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v + (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FSUB:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (float)v - (float)src(i);
-                    }
-                    break;
-                case ATOMIC_FCMPWR:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = ((v == src(i)) ? src(i + 8) : v);
-                    }
-                    break;
-                case ATOMIC_FMIN:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v <= (float)src(i)) ? v : src(i));
-                    }
-                    break;
-                case ATOMIC_FMAX:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    if (is_fp_type<T>::value) {
-                        *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)v >= (float)src(i)) ? v : src(i));
-                    }
-                    break;
-                default:
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-                    exit(EXIT_FAILURE);
-            }
+            CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), (T)src(i),
+                                 (T)((op == ATOMIC_CMPXCHG || op == ATOMIC_FCMPWR) ? src(i + 8) : 0), buf_id.get_data());
         } else {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     }
@@ -8680,16 +6865,14 @@ template <typename T>
 CM_API bool
 write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint, 8> &element_offset, int src, vector<T, 8> &v)
 {
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
     static const bool conformable1 = is_dword_type<T>::value;
     int i;
     uint pos;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -8699,12 +6882,12 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint,
     //assert(height == 1);
 
     if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
     }
 
     if((op != ATOMIC_INC) && (op != ATOMIC_DEC)) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: NULL src is only allowed for ATOMIC_INC or ATOMIC_DEC!\n", buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: NULL src is only allowed for ATOMIC_INC or ATOMIC_DEC!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -8717,21 +6900,9 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint,
             continue;
         }
         if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            switch (op) {
-                case ATOMIC_INC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + 1;
-                    break;
-                case ATOMIC_DEC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - 1;
-                    break;
-                default:
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-                    exit(EXIT_FAILURE);
-            }
+            v(i) = CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), (T)0, (T)0, buf_id.get_data());
         } else {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     }
@@ -8745,16 +6916,14 @@ template <typename T>
 CM_API bool
 write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint, 8> &element_offset, int src, vector_ref<T, 8> v)
 {
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
     static const bool conformable1 = is_dword_type<T>::value;
     int i;
     uint pos;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -8764,12 +6933,12 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint,
     //assert(height == 1);
 
     if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
     }
 
     if((op != ATOMIC_INC) && (op != ATOMIC_DEC)) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: NULL src is only allowed for ATOMIC_INC or ATOMIC_DEC!\n", buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: NULL src is only allowed for ATOMIC_INC or ATOMIC_DEC!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -8782,21 +6951,9 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint,
             continue;
         }
         if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            switch (op) {
-                case ATOMIC_INC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + 1;
-                    break;
-                case ATOMIC_DEC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - 1;
-                    break;
-                default:
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-                    exit(EXIT_FAILURE);
-            }
+            v(i) = CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), (T)0, (T)0, buf_id.get_data());
         } else {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     }
@@ -8810,21 +6967,18 @@ template <typename T>
 CM_API bool
 write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint, 8> &element_offset, int src, int not_used)
 {
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
     static const bool conformable1 = is_dword_type<T>::value;
     int i;
     uint pos;
-    T v;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
     if (not_used != 0) {
         printf("write atomic passed destination vec as int but not NULL %x\n", not_used);
         exit(EXIT_FAILURE);
     }
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -8834,12 +6988,12 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint,
     //assert(height == 1);
 
     if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
     }
 
     if((op != ATOMIC_INC) && (op != ATOMIC_DEC)) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: NULL src is only allowed for ATOMIC_INC or ATOMIC_DEC!\n", buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: NULL src is only allowed for ATOMIC_INC or ATOMIC_DEC!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -8852,21 +7006,9 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector<uint,
             continue;
         }
         if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            switch (op) {
-                case ATOMIC_INC:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v + 1;
-                    break;
-                case ATOMIC_DEC:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v - 1;
-                    break;
-                default:
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-                    exit(EXIT_FAILURE);
-            }
+            CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), (T)0, (T)0, buf_id.get_data());
         } else {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     }
@@ -8880,16 +7022,14 @@ template <typename T>
 CM_API bool
 write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<uint, 8> element_offset, int src, vector<T, 8> &v)
 {
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
     static const bool conformable1 = is_dword_type<T>::value;
     int i;
     uint pos;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -8899,12 +7039,12 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<u
     //assert(height == 1);
 
     if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
     }
 
     if((op != ATOMIC_INC) && (op != ATOMIC_DEC)) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: NULL src is only allowed for ATOMIC_INC or ATOMIC_DEC!\n", buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: NULL src is only allowed for ATOMIC_INC or ATOMIC_DEC!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -8917,21 +7057,9 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<u
             continue;
         }
         if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            switch (op) {
-                case ATOMIC_INC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + 1;
-                    break;
-                case ATOMIC_DEC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - 1;
-                    break;
-                default:
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-                    exit(EXIT_FAILURE);
-            }
+            v(i) = CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), (T)0, (T)0, buf_id.get_data());
         } else {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     }
@@ -8945,16 +7073,14 @@ template <typename T>
 CM_API bool
 write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<uint, 8> element_offset, int src, vector_ref<T, 8> v)
 {
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
     static const bool conformable1 = is_dword_type<T>::value;
     int i;
     uint pos;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -8964,12 +7090,12 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<u
     //assert(height == 1);
 
     if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
     }
 
     if((op != ATOMIC_INC) && (op != ATOMIC_DEC)) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: NULL src is only allowed for ATOMIC_INC or ATOMIC_DEC!\n", buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: NULL src is only allowed for ATOMIC_INC or ATOMIC_DEC!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -8982,21 +7108,9 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<u
             continue;
         }
         if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            switch (op) {
-                case ATOMIC_INC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) + 1;
-                    break;
-                case ATOMIC_DEC:
-                    v(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v(i) - 1;
-                    break;
-                default:
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-                    exit(EXIT_FAILURE);
-            }
+            v(i) = CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), (T)0, (T)0, buf_id.get_data());
         } else {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     }
@@ -9010,20 +7124,18 @@ template <typename T>
 CM_API bool
 write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<uint, 8> element_offset, int src, int not_used)
 {
-	std::unique_lock<std::mutex> lk(mutexForWrite);
-
     static const bool conformable1 = is_dword_type<T>::value;
     int i;
     uint pos;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
     if (not_used != 0) {
         printf("write atomic passed destination vec as int but not NULL %x\n", not_used);
         exit(EXIT_FAILURE);
     }
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -9033,18 +7145,17 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<u
     //assert(height == 1);
 
     if(buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
     }
 
     if((op != ATOMIC_INC) && (op != ATOMIC_DEC)) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: NULL src is only allowed for ATOMIC_INC or ATOMIC_DEC!\n", buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: NULL src is only allowed for ATOMIC_INC or ATOMIC_DEC!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     // InitializeCriticalSection(&dataport_cs);
 
-    T v;
     for (i = 0; i < 8; i++) {
         SIMDCF_ELEMENT_SKIP(i);
         pos = (global_offset + element_offset(i))*4;
@@ -9052,21 +7163,9 @@ write(SurfaceIndex & buf_id, CmAtomicOpType op, uint global_offset, vector_ref<u
             continue;
         }
         if(buff_iter->bclass == GEN4_INPUT_OUTPUT_BUFFER) {
-            switch (op) {
-                case ATOMIC_INC:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v + 1;
-                    break;
-                case ATOMIC_DEC:
-                    v = *((T*)((char*)buff_iter->p_volatile + pos));
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = v - 1;
-                    break;
-                default:
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for DWord atomic write!\n", buf_id.get_data()&0xFF);
-                    exit(EXIT_FAILURE);
-            }
+            CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), (T)0, (T)0, buf_id.get_data());
         } else {
-            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for DWord atomic write!\n", buf_id.get_data());
             exit(EXIT_FAILURE);
         }
     }
@@ -9086,10 +7185,10 @@ read_transpose(SurfaceIndex & buf_id, CM_READ_SIZE region_height, CM_READ_SIZE r
     int block_height = 0;
     uint offset;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -9099,7 +7198,7 @@ read_transpose(SurfaceIndex & buf_id, CM_READ_SIZE region_height, CM_READ_SIZE r
     {
         if((buff_iter->bclass != GEN4_INPUT_BUFFER) &&
             (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER)) {
-                GFX_EMU_ERROR_MESSAGE("reading buffer %d: the registered buffer type is not INPUT_BUFFER!\n", buf_id.get_data()&0xFF);
+                GFX_EMU_ERROR_MESSAGE("reading buffer %d: the registered buffer type is not INPUT_BUFFER!\n", buf_id.get_data());
                 exit(EXIT_FAILURE);
         }
     }
@@ -9128,7 +7227,7 @@ read_transpose(SurfaceIndex & buf_id, CM_READ_SIZE region_height, CM_READ_SIZE r
         }
     default:
         {
-            GFX_EMU_ERROR_MESSAGE("reading buffer %d: Invalid Block Height!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("reading buffer %d: Invalid Block Height!\n", buf_id.get_data());
                 exit(EXIT_FAILURE);
         }
     }
@@ -9157,7 +7256,7 @@ read_transpose(SurfaceIndex & buf_id, CM_READ_SIZE region_height, CM_READ_SIZE r
         }
     default:
         {
-            GFX_EMU_ERROR_MESSAGE("reading buffer %d: Invalid Block Width!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("reading buffer %d: Invalid Block Width!\n", buf_id.get_data());
                 exit(EXIT_FAILURE);
         }
     }
@@ -9171,18 +7270,18 @@ read_transpose(SurfaceIndex & buf_id, CM_READ_SIZE region_height, CM_READ_SIZE r
     y_pos = y_pos * block_height;
     if(C != block_height || R != block_width)
     {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: Block dimensions are not equal to matrix dimensions!\n", buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: Block dimensions are not equal to matrix dimensions!\n", buf_id.get_data());
                 exit(EXIT_FAILURE);
     }
 
     int x_pos_a, y_pos_a;  /* Actual positions */
     int sizeofT = sizeof(T); /* Make this into a signed integer */
-    uint bpp = CM_genx_bytes_per_pixel(buff_iter->pixelFormat);
+    uint bpp = buff_iter->bpp;
     assert(((bpp - 1) & bpp) == 0); // Is power-of-2 number
 
     if(sizeofT != 4)
     {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: Invalid matrix format!\n", buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: Invalid matrix format!\n", buf_id.get_data());
                 exit(EXIT_FAILURE);
     }
     for (i = 0; i < block_height; i++) {
@@ -9232,10 +7331,10 @@ read_transpose(SurfaceIndex & buf_id, CM_READ_SIZE region_height, CM_READ_SIZE r
     int block_height = 0;
     uint offset;
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-                                    CmEmulSys::search_buffer(buf_id.get_data()&0xFF);
+                                    CmEmulSys::search_buffer(buf_id.get_data());
 
     if(buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data()&0xFF, buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -9245,7 +7344,7 @@ read_transpose(SurfaceIndex & buf_id, CM_READ_SIZE region_height, CM_READ_SIZE r
     {
         if((buff_iter->bclass != GEN4_INPUT_BUFFER) &&
             (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER)) {
-                GFX_EMU_ERROR_MESSAGE("reading buffer %d: the registered buffer type is not INPUT_BUFFER!\n", buf_id.get_data()&0xFF);
+                GFX_EMU_ERROR_MESSAGE("reading buffer %d: the registered buffer type is not INPUT_BUFFER!\n", buf_id.get_data());
                 exit(EXIT_FAILURE);
         }
     }
@@ -9274,7 +7373,7 @@ read_transpose(SurfaceIndex & buf_id, CM_READ_SIZE region_height, CM_READ_SIZE r
         }
     default:
         {
-            GFX_EMU_ERROR_MESSAGE("reading buffer %d: Invalid Block Height!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("reading buffer %d: Invalid Block Height!\n", buf_id.get_data());
                 exit(EXIT_FAILURE);
         }
     }
@@ -9303,7 +7402,7 @@ read_transpose(SurfaceIndex & buf_id, CM_READ_SIZE region_height, CM_READ_SIZE r
         }
     default:
         {
-            GFX_EMU_ERROR_MESSAGE("reading buffer %d: Invalid Block Width!\n", buf_id.get_data()&0xFF);
+            GFX_EMU_ERROR_MESSAGE("reading buffer %d: Invalid Block Width!\n", buf_id.get_data());
                 exit(EXIT_FAILURE);
         }
     }
@@ -9317,18 +7416,18 @@ read_transpose(SurfaceIndex & buf_id, CM_READ_SIZE region_height, CM_READ_SIZE r
     y_pos = y_pos * block_height;
     if(C != block_height || R != block_width)
     {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: Block dimensions are not equal to matrix dimensions!\n", buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: Block dimensions are not equal to matrix dimensions!\n", buf_id.get_data());
                 exit(EXIT_FAILURE);
     }
 
     int x_pos_a, y_pos_a;  /* Actual positions */
     int sizeofT = sizeof(T); /* Make this into a signed integer */
-    uint bpp = CM_genx_bytes_per_pixel(buff_iter->pixelFormat);
+    uint bpp = buff_iter->bpp;
     assert(((bpp - 1) & bpp) == 0); // Is power-of-2 number
 
     if(sizeofT != 4)
     {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: Invalid matrix format!\n", buf_id.get_data()&0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: Invalid matrix format!\n", buf_id.get_data());
                 exit(EXIT_FAILURE);
     }
     for (i = 0; i < block_height; i++) {
@@ -9356,16 +7455,125 @@ read_transpose(SurfaceIndex & buf_id, CM_READ_SIZE region_height, CM_READ_SIZE r
                 x_pos_a >= width) {
                 in(j,i) = 0;
             }
-            else {
-                offset = y_pos_a * width + x_pos_a;
-                {
-                    in(j,i) = *((T*)((char*)buff_iter->p + offset));
+            else {
+                offset = y_pos_a * width + x_pos_a;
+                {
+                    in(j,i) = *((T*)((char*)buff_iter->p + offset));
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+/* Per-texel loops of read_typed/write_typed, instantiated once per texel
+   type and stride so the surface format is resolved before the lane loop.
+   data_size is the byte stride of the format, Texel the type loaded/stored. */
+template <typename Texel, uint data_size, typename RT, uint N1, uint N2>
+inline void CM_genx_read_typed_texels(matrix_ref<RT, N1, N2> &m, const uchar *color,
+     const uchar *baseOffset, uint width, uint height, uint depth,
+     const vector<uint, N2> &u, const vector<uint, N2> &v, const vector<uint, N2> &r)
+{
+    const uchar *byteOffset;
+    uchar colorNext = 0;
+
+    if ((height == 1) && (depth == 1)) {
+        for (uint channel =0; channel<4; channel++) {
+            if (color[channel] == 0) continue;
+            for (uint i=0; i<N2; i++) {
+                byteOffset = baseOffset +  (data_size * u(i) + data_size * channel);
+                if(data_size*(u(i) + channel) >= width) {
+                    m(colorNext, i) = 0;
+                } else {
+                    SIMDCF_WRAPPER(m(colorNext, i) = *( (const Texel *)byteOffset ), N2, i);
+                }
+            }
+            colorNext++;
+        }
+    } else if (depth == 1) {
+        for (uint channel =0; channel<4; channel++) {
+            if (color[channel] == 0) continue;
+            for (uint i=0; i<N2; i++) {
+                byteOffset = baseOffset +  (data_size * u(i) + v(i) * width + data_size * channel);
+                if(data_size*(u(i) + channel) >= width ||
+                   v(i) >= height) {
+                    m(colorNext, i) = 0;
+                } else {
+                    SIMDCF_WRAPPER(m(colorNext, i) = *( (const Texel *)byteOffset ), N2, i);
+                }
+            }
+            colorNext++;
+        }
+    } else {
+        for (uint channel =0; channel<4; channel++) {
+            if (color[channel] == 0) continue;
+            for (uint i=0; i<N2; i++) {
+                byteOffset = baseOffset +  (data_size * u(i) + v(i) * width + r(i) * width * height + data_size * channel);
+                if(data_size*(u(i) + channel) >= width ||
+                   v(i) >= height ||
+                   r(i) >= depth) {
+                    m(colorNext, i) = 0;
+                } else {
+                    SIMDCF_WRAPPER(m(colorNext, i) = *( (const Texel *)byteOffset ), N2, i);
+                }
+            }
+            colorNext++;
+        }
+    }
+}
+
+template <typename Texel, uint data_size, typename RT, uint N1, uint N2>
+inline void CM_genx_write_typed_texels(matrix_ref<RT, N1, N2> &m, const uchar *color,
+     uchar *baseOffset, uint width, uint height, uint depth,
+     const vector<uint, N2> &u, const vector<uint, N2> &v, const vector<uint, N2> &r)
+{
+    uchar *byteOffset;
+    uchar colorNext = 0;
+
+    if ((height == 1) && (depth == 1)) {
+        for (uint channel =0; channel<4; channel++) {
+            if (color[channel] == 0) continue;
+            for (uint i=0; i<N2; i++) {
+                byteOffset = baseOffset +  (data_size * u(i) + data_size * channel);
+                if(data_size*(u(i) + channel) >= width) {
+                    //break;
+                } else {
+                    SIMDCF_WRAPPER(*( (Texel *)byteOffset ) = m(colorNext, i), N2, i);
+                }
+            }
+            colorNext++;
+        }
+    } else if (depth == 1) {
+        for (uint channel =0; channel<4; channel++) {
+            if (color[channel] == 0) continue;
+            for (uint i=0; i<N2; i++) {
+                byteOffset = baseOffset +  (data_size * u(i) + v(i) * width + data_size * channel);
+                if(data_size*(u(i) + channel) >= width ||
+                   v(i) >= height) {
+                    break;
+                } else {
+                    SIMDCF_WRAPPER(*( (Texel *)byteOffset ) = m(colorNext, i), N2, i);
+                }
+            }
+            colorNext++;
+        }
+    } else {
+        for (uint channel =0; channel<4; channel++) {
+            if (color[channel] == 0) continue;
+            for (uint i=0; i<N2; i++) {
+                byteOffset = baseOffset +  (data_size * u(i) + v(i) * width + r(i) * width * height + data_size * channel);
+                if(data_size*(u(i) + channel) >= width ||
+                   v(i) >= height ||
+                   r(i) >= depth) {
+                    break;
+                } else {
+                    SIMDCF_WRAPPER(*( (Texel *)byteOffset ) = m(colorNext, i), N2, i);
                 }
             }
+            colorNext++;
         }
     }
-
-    return true;
 }
 
 /* Typed surface read */
@@ -9377,8 +7585,8 @@ read_typed(SurfaceIndex &surfIndex, ChannelMaskType channelMask,
 {
     static const bool conformable1 = check_true<is_fp_or_dword_type<RT>::value>::value;
 
-    uchar *baseOffset, *byteOffset;
-    uchar numColors=0, color[4]={0,0,0,0}, colorNext=0;
+    uchar *baseOffset;
+    uchar numColors=0, color[4]={0,0,0,0};
 
     if (channelMask & 0x1) {color[0]=1; numColors++;}
     if ((channelMask >> 1) & 0x1) {color[1]=1; numColors++;}
@@ -9411,7 +7619,7 @@ read_typed(SurfaceIndex &surfIndex, ChannelMaskType channelMask,
         exit(EXIT_FAILURE);
     }
 
-    uint width, height, depth, pitch, data_size;
+    uint width, height, depth;
     CmSurfaceFormatID surfFormat;
 
     surfFormat = buff_iter->pixelFormat;
@@ -9423,11 +7631,7 @@ read_typed(SurfaceIndex &surfIndex, ChannelMaskType channelMask,
             GFX_EMU_ERROR_MESSAGE("read_typed error: only CM_R_ENABLE is supported for R32_SINT/R32_UINT/R32_FLOAT surface format.\n");
             exit(EXIT_FAILURE);
         }
-
-        data_size = 4;
-    } else if (surfFormat == R8G8B8A8_UINT) {
-        data_size = 1;
-    } else {
+    } else if (surfFormat != R8G8B8A8_UINT) {
         GFX_EMU_ERROR_MESSAGE("read_typed error: only R32_SINT/R32_UINT/R32_FLOAT/R8G8B8A8_UINT surface formats are supported.\n");
         exit(EXIT_FAILURE);
     }
@@ -9435,67 +7639,12 @@ read_typed(SurfaceIndex &surfIndex, ChannelMaskType channelMask,
     width = buff_iter->width;
     height = buff_iter->height;
     depth = buff_iter->depth;
+    baseOffset = (uchar *) buff_iter->p_volatile;
 
-    if ((height == 1) && (depth == 1)) {
-        baseOffset = (uchar *) buff_iter->p_volatile;
-
-        for (uint channel =0; channel<4; channel++) {
-            if (color[channel] == 0) continue;
-            for (uint i=0; i<N2; i++) {
-                byteOffset = baseOffset +  (data_size * u(i) + data_size * channel);
-                if(data_size*(u(i) + channel) >= width) {
-                    m(colorNext, i) = 0;
-                } else {
-                    if(surfFormat == R8G8B8A8_UINT) {
-                        SIMDCF_WRAPPER(m(colorNext, i) = *( (unsigned char *)byteOffset ), N2, i);
-                    } else {
-                        SIMDCF_WRAPPER(m(colorNext, i) = *( (RT *)byteOffset ), N2, i);
-                    }
-                }
-            }
-            colorNext++;
-        }
-    } else if (depth == 1) {
-        baseOffset = (uchar *) buff_iter->p_volatile;
-
-        for (uint channel =0; channel<4; channel++) {
-            if (color[channel] == 0) continue;
-            for (uint i=0; i<N2; i++) {
-                byteOffset = baseOffset +  (data_size * u(i) + v(i) * width + data_size * channel);
-                if(data_size*(u(i) + channel) >= width ||
-                   v(i) >= height) {
-                    m(colorNext, i) = 0;
-                } else {
-                    if(surfFormat == R8G8B8A8_UINT) {
-                        SIMDCF_WRAPPER(m(colorNext, i) = *( (unsigned char *)byteOffset ), N2, i);
-                    } else {
-                        SIMDCF_WRAPPER(m(colorNext, i) = *( (RT *)byteOffset ), N2, i);
-                    }
-                }
-            }
-            colorNext++;
-        }
+    if (surfFormat == R8G8B8A8_UINT) {
+        CM_genx_read_typed_texels<uchar, 1>(m, color, baseOffset, width, height, depth, u, v, r);
     } else {
-        baseOffset = (uchar *) buff_iter->p_volatile;
-
-        for (uint channel =0; channel<4; channel++) {
-            if (color[channel] == 0) continue;
-            for (uint i=0; i<N2; i++) {
-                byteOffset = baseOffset +  (data_size * u(i) + v(i) * width + r(i) * width * height + data_size * channel);
-                if(data_size*(u(i) + channel) >= width ||
-                   v(i) >= height ||
-                   r(i) >= depth) {
-                    m(colorNext, i) = 0;
-                } else {
-                    if(surfFormat == R8G8B8A8_UINT) {
-                        SIMDCF_WRAPPER(m(colorNext, i) = *( (unsigned char *)byteOffset ), N2, i);
-                    } else {
-                        SIMDCF_WRAPPER(m(colorNext, i) = *( (RT *)byteOffset ), N2, i);
-                    }
-                }
-            }
-            colorNext++;
-        }
+        CM_genx_read_typed_texels<RT, 4>(m, color, baseOffset, width, height, depth, u, v, r);
     }
 
     return true;
@@ -9520,8 +7669,8 @@ write_typed(SurfaceIndex &surfIndex, ChannelMaskType channelMask,
 {
     static const bool conformable1 = check_true<is_fp_or_dword_type<RT>::value>::value;
 
-    uchar *baseOffset, *byteOffset;
-    uchar numColors=0, color[4]={0,0,0,0}, colorNext=0;
+    uchar *baseOffset;
+    uchar numColors=0, color[4]={0,0,0,0};
 
     if (channelMask & 0x1) {color[0]=1; numColors++;}
     if ((channelMask >> 1) & 0x1) {color[1]=1; numColors++;}
@@ -9554,7 +7703,7 @@ write_typed(SurfaceIndex &surfIndex, ChannelMaskType channelMask,
         exit(EXIT_FAILURE);
     }
 
-    uint width, height, depth, data_size;
+    uint width, height, depth;
     CmSurfaceFormatID surfFormat;
 
     surfFormat = buff_iter->pixelFormat;
@@ -9566,11 +7715,7 @@ write_typed(SurfaceIndex &surfIndex, ChannelMaskType channelMask,
             GFX_EMU_ERROR_MESSAGE("write_typed error: only CM_R_ENABLE is supported for R32_SINT/R32_UINT/R32_FLOAT surface format.\n");
             exit(EXIT_FAILURE);
         }
-
-        data_size = 4;
-    } else if (surfFormat == R8G8B8A8_UINT) {
-        data_size = 1;
-    } else {
+    } else if (surfFormat != R8G8B8A8_UINT) {
         GFX_EMU_ERROR_MESSAGE("write_typed error: only R32_SINT/R32_UINT/R32_FLOAT/R8G8B8A8_UINT surface formats are supported.\n");
         exit(EXIT_FAILURE);
     }
@@ -9578,67 +7723,12 @@ write_typed(SurfaceIndex &surfIndex, ChannelMaskType channelMask,
     width = buff_iter->width;
     height = buff_iter->height;
     depth = buff_iter->depth;
+    baseOffset = (uchar *) buff_iter->p_volatile;
 
-    if ((height == 1) && (depth == 1)) {
-        baseOffset = (uchar *) buff_iter->p_volatile;
-
-        for (uint channel =0; channel<4; channel++) {
-            if (color[channel] == 0) continue;
-            for (uint i=0; i<N2; i++) {
-                byteOffset = baseOffset +  (data_size * u(i) + data_size * channel);
-                if(data_size*(u(i) + channel) >= width) {
-                    //break;
-                } else {
-                    if(surfFormat == R8G8B8A8_UINT) {
-                        SIMDCF_WRAPPER(*( (unsigned char *)byteOffset ) = m(colorNext, i), N2, i);
-                    } else {
-                        SIMDCF_WRAPPER(*( (RT *)byteOffset ) = m(colorNext, i), N2, i);
-                    }
-                }
-            }
-            colorNext++;
-        }
-    } else if (depth == 1) {
-        baseOffset = (uchar *) buff_iter->p_volatile;
-
-        for (uint channel =0; channel<4; channel++) {
-            if (color[channel] == 0) continue;
-            for (uint i=0; i<N2; i++) {
-                byteOffset = baseOffset +  (data_size * u(i) + v(i) * width + data_size * channel);
-                if(data_size*(u(i) + channel) >= width ||
-                   v(i) >= height) {
-                    break;
-                } else {
-                    if(surfFormat == R8G8B8A8_UINT) {
-                        SIMDCF_WRAPPER(*( (unsigned char *)byteOffset ) = m(colorNext, i), N2, i);
-                    } else {
-                        SIMDCF_WRAPPER(*( (RT *)byteOffset ) = m(colorNext, i), N2, i);
-                    }
-                }
-            }
-            colorNext++;
-        }
+    if (surfFormat == R8G8B8A8_UINT) {
+        CM_genx_write_typed_texels<uchar, 1>(m, color, baseOffset, width, height, depth, u, v, r);
     } else {
-        baseOffset = (uchar *) buff_iter->p_volatile;
-
-        for (uint channel =0; channel<4; channel++) {
-            if (color[channel] == 0) continue;
-            for (uint i=0; i<N2; i++) {
-                byteOffset = baseOffset +  (data_size * u(i) + v(i) * width + r(i) * width * height + data_size * channel);
-                if(data_size*(u(i) + channel) >= width ||
-                   v(i) >= height ||
-                   r(i) >= depth) {
-                    break;
-                } else {
-                    if(surfFormat == R8G8B8A8_UINT) {
-                        SIMDCF_WRAPPER(*( (unsigned char *)byteOffset ) = m(colorNext, i), N2, i);
-                    } else {
-                        SIMDCF_WRAPPER(*( (RT *)byteOffset ) = m(colorNext, i), N2, i);
-                    }
-                }
-            }
-            colorNext++;
-        }
+        CM_genx_write_typed_texels<RT, 4>(m, color, baseOffset, width, height, depth, u, v, r);
     }
 
     return true;
@@ -9884,24 +7974,24 @@ CM_API void __write_typed_atomic_impl(SurfaceIndex & buf_id, CmAtomicOpType op,
     vector<uint, N> u, vector<uint, N> v, vector<uint, N> r, int LOD)
 {
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-        CmEmulSys::search_buffer(buf_id.get_data() & 0xFF);
+        CmEmulSys::search_buffer(buf_id.get_data());
 
     if (buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data() & 0xFF, buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if (op > ATOMIC_FMAX) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
     if (N != 1 && N != 2 && N != 4 && N != 8) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 1,2,4,8 for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 1,2,4,8 for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -9930,11 +8020,10 @@ CM_API void __write_typed_atomic_impl(SurfaceIndex & buf_id, CmAtomicOpType op,
         else {
             switch (op) {
             case ATOMIC_CMPXCHG:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = ((ret(i) == src1(i)) ? src0(i) : ret(i));
+                ret(i) = CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), src0(i), src1(i), buf_id.get_data());
                 break;
             default:
-                GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data() & 0xFF);
+                GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data());
                 exit(EXIT_FAILURE);
             }
         }
@@ -9947,24 +8036,24 @@ CM_API void __write_typed_atomic_impl(SurfaceIndex & buf_id, CmAtomicOpType op,
     vector<uint, N> u, vector<uint, N> v, vector<uint, N> r, int LOD)
 {
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-        CmEmulSys::search_buffer(buf_id.get_data() & 0xFF);
+        CmEmulSys::search_buffer(buf_id.get_data());
 
     if (buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data() & 0xFF, buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if (op > ATOMIC_FMAX) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
     if (N != 1 && N != 2 && N != 4 && N != 8) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 1,2,4,8 for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 1,2,4,8 for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -9993,111 +8082,23 @@ CM_API void __write_typed_atomic_impl(SurfaceIndex & buf_id, CmAtomicOpType op,
         else {
             switch (op) {
             case ATOMIC_ADD:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = ret(i) + src0(i);
-                break;
             case ATOMIC_SUB:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = ret(i) - src0(i);
-                break;
             case ATOMIC_MIN:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (!is_fp_type<T>::value) {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint)ret(i) <= (uint)src0(i)) ? ret(i) : src0(i));
-                }
-                break;
             case ATOMIC_MAX:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (!is_fp_type<T>::value) {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint)ret(i) >= (uint)src0(i)) ? ret(i) : src0(i));
-                }
-                break;
             case ATOMIC_XCHG:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = src0(i);
-                break;
             case ATOMIC_AND:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (std::is_same_v <T, uint>)
-                {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)ret(i)& (uint)src0(i);
-                }
-                else if (std::is_same_v <T, int>)
-                {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (int)ret(i)& (int)src0(i);
-                }
-                else
-                {
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                    exit(EXIT_FAILURE);
-                }
-                break;
             case ATOMIC_OR:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (std::is_same_v <T, uint>)
-                {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)ret(i) | (uint)src0(i);
-                }
-                else if (std::is_same_v <T, int>)
-                {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (int)ret(i) | (int)src0(i);
-                }
-                else
-                {
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                    exit(EXIT_FAILURE);
-                }
-                break;
             case ATOMIC_XOR:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (std::is_same_v <T, uint>)
-                {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)ret(i) ^ (uint)src0(i);
-                }
-                else if (std::is_same_v <T, int>)
-                {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (int)ret(i) ^ (int)src0(i);
-                }
-                else
-                {
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                    exit(EXIT_FAILURE);
-                }
-                break;
             case ATOMIC_MINSINT:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = (((int)ret(i) <= (int)src0(i)) ? ret(i) : src0(i));
-                break;
             case ATOMIC_MAXSINT:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = (((int)ret(i) >= (int)src0(i)) ? ret(i) : src0(i));
-                break;
             case ATOMIC_FADD:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (is_fp_type<T>::value) {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (float)ret(i) + (float)src0(i);
-                }
-                break;
             case ATOMIC_FSUB:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (is_fp_type<T>::value) {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (float)ret(i) - (float)src0(i);
-                }
-                break;
             case ATOMIC_FMIN:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (is_fp_type<T>::value) {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)ret(i) <= (float)src0(i)) ? ret(i) : src0(i));
-                }
-                break;
             case ATOMIC_FMAX:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (is_fp_type<T>::value) {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)ret(i) >= (float)src0(i)) ? ret(i) : src0(i));
-                }
+                ret(i) = CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), src0(i), (T)0, buf_id.get_data());
                 break;
             default:
-                GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data() & 0xFF);
+                GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data());
                 exit(EXIT_FAILURE);
             }
         }
@@ -10110,24 +8111,24 @@ CM_API void __write_typed_atomic_impl(SurfaceIndex & buf_id, CmAtomicOpType op,
     vector<uint, N> u, vector<uint, N> v, vector<uint, N> r, int LOD)
 {
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-        CmEmulSys::search_buffer(buf_id.get_data() & 0xFF);
+        CmEmulSys::search_buffer(buf_id.get_data());
 
     if (buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data() & 0xFF, buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if (op > ATOMIC_FMAX) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
     if (N != 1 && N != 2 && N != 4 && N != 8) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 1,2,4,8 for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 1,2,4,8 for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -10156,15 +8157,11 @@ CM_API void __write_typed_atomic_impl(SurfaceIndex & buf_id, CmAtomicOpType op,
         else {
             switch (op) {
             case ATOMIC_INC:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = ret(i) + 1;
-                break;
             case ATOMIC_DEC:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = ret(i) - 1;
+                ret(i) = CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), (T)0, (T)0, buf_id.get_data());
                 break;
             default:
-                GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data() & 0xFF);
+                GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data());
                 exit(EXIT_FAILURE);
             }
         }
@@ -10177,24 +8174,24 @@ CM_API void __write_typed_atomic_impl(SurfaceIndex & buf_id, CmAtomicOpType op,
     vector<uint, N> u, vector<uint, N> v, int r, int LOD)
 {
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-        CmEmulSys::search_buffer(buf_id.get_data() & 0xFF);
+        CmEmulSys::search_buffer(buf_id.get_data());
 
     if (buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data() & 0xFF, buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if (op > ATOMIC_FMAX) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
     if (N != 1 && N != 2 && N != 4 && N != 8) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 1,2,4,8 for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 1,2,4,8 for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -10223,11 +8220,10 @@ CM_API void __write_typed_atomic_impl(SurfaceIndex & buf_id, CmAtomicOpType op,
         else {
             switch (op) {
             case ATOMIC_CMPXCHG:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = ((ret(i) == src1(i)) ? src0(i) : ret(i));
+                ret(i) = CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), src0(i), src1(i), buf_id.get_data());
                 break;
             default:
-                GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data() & 0xFF);
+                GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data());
                 exit(EXIT_FAILURE);
             }
         }
@@ -10241,24 +8237,24 @@ CM_API void __write_typed_atomic_impl(SurfaceIndex & buf_id, CmAtomicOpType op,
     vector<uint, N> u, vector<uint, N> v, int r, int LOD)
 {
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-        CmEmulSys::search_buffer(buf_id.get_data() & 0xFF);
+        CmEmulSys::search_buffer(buf_id.get_data());
 
     if (buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data() & 0xFF, buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if (op > ATOMIC_FMAX) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
     if (N != 1 && N != 2 && N != 4 && N != 8) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 1,2,4,8 for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 1,2,4,8 for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -10287,111 +8283,23 @@ CM_API void __write_typed_atomic_impl(SurfaceIndex & buf_id, CmAtomicOpType op,
         else {
             switch (op) {
             case ATOMIC_ADD:
-               ret(i)= *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) =ret(i)+ src0(i);
-                break;
             case ATOMIC_SUB:
-               ret(i)= *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) =ret(i)- src0(i);
-                break;
             case ATOMIC_MIN:
-               ret(i)= *((T*)((char*)buff_iter->p_volatile + pos));
-                if (!is_fp_type<T>::value) {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint)ret(i) <= (uint)src0(i)) ?ret(i): src0(i));
-                }
-                break;
             case ATOMIC_MAX:
-               ret(i)= *((T*)((char*)buff_iter->p_volatile + pos));
-                if (!is_fp_type<T>::value) {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint)ret(i) >= (uint)src0(i)) ?ret(i): src0(i));
-                }
-                break;
             case ATOMIC_XCHG:
-               ret(i)= *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = src0(i);
-                break;
             case ATOMIC_AND:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (std::is_same_v <T, uint>)
-                {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)ret(i)& (uint)src0(i);
-                }
-                else if (std::is_same_v <T, int>)
-                {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (int)ret(i)& (int)src0(i);
-                }
-                else
-                {
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                    exit(EXIT_FAILURE);
-                }
-                break;
             case ATOMIC_OR:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (std::is_same_v <T, uint>)
-                {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)ret(i) | (uint)src0(i);
-                }
-                else if (std::is_same_v <T, int>)
-                {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (int)ret(i) | (int)src0(i);
-                }
-                else
-                {
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                    exit(EXIT_FAILURE);
-                }
-                break;
             case ATOMIC_XOR:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (std::is_same_v <T, uint>)
-                {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)ret(i) ^ (uint)src0(i);
-                }
-                else if (std::is_same_v <T, int>)
-                {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (int)ret(i) ^ (int)src0(i);
-                }
-                else
-                {
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                    exit(EXIT_FAILURE);
-                }
-                break;
             case ATOMIC_MINSINT:
-               ret(i)= *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = (((int)ret(i) <= (int)src0(i)) ?ret(i): src0(i));
-                break;
             case ATOMIC_MAXSINT:
-               ret(i)= *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = (((int)ret(i) >= (int)src0(i)) ?ret(i): src0(i));
-                break;
             case ATOMIC_FADD:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (is_fp_type<T>::value) {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (float)ret(i) + (float)src0(i);
-                }
-                break;
             case ATOMIC_FSUB:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (is_fp_type<T>::value) {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (float)ret(i) - (float)src0(i);
-                }
-                break;
             case ATOMIC_FMIN:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (is_fp_type<T>::value) {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)ret(i) <= (float)src0(i)) ? ret(i) : src0(i));
-                }
-                break;
             case ATOMIC_FMAX:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (is_fp_type<T>::value) {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)ret(i) >= (float)src0(i)) ? ret(i) : src0(i));
-                }
+                ret(i) = CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), src0(i), (T)0, buf_id.get_data());
                 break;
             default:
-                GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data() & 0xFF);
+                GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data());
                 exit(EXIT_FAILURE);
             }
         }
@@ -10405,24 +8313,24 @@ CM_API void __write_typed_atomic_impl(SurfaceIndex & buf_id, CmAtomicOpType op,
     vector<uint, N> u, vector<uint, N> v, int r, int LOD)
 {
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-        CmEmulSys::search_buffer(buf_id.get_data() & 0xFF);
+        CmEmulSys::search_buffer(buf_id.get_data());
 
     if (buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data() & 0xFF, buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if (op > ATOMIC_FMAX) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
     if (N != 1 && N != 2 && N != 4 && N != 8) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 1,2,4,8 for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 1,2,4,8 for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -10451,15 +8359,11 @@ CM_API void __write_typed_atomic_impl(SurfaceIndex & buf_id, CmAtomicOpType op,
         else {
             switch (op) {
             case ATOMIC_INC:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = ret(i) + 1;
-                break;
             case ATOMIC_DEC:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = ret(i) - 1;
+                ret(i) = CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), (T)0, (T)0, buf_id.get_data());
                 break;
             default:
-                GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data() & 0xFF);
+                GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data());
                 exit(EXIT_FAILURE);
             }
         }
@@ -10473,24 +8377,24 @@ CM_API void __write_typed_atomic_impl(SurfaceIndex & buf_id, CmAtomicOpType op,
     vector<uint, N> u, int v, int r, int LOD)
 {
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-        CmEmulSys::search_buffer(buf_id.get_data() & 0xFF);
+        CmEmulSys::search_buffer(buf_id.get_data());
 
     if (buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data() & 0xFF, buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if (op > ATOMIC_FMAX) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
     if (N != 1 && N != 2 && N != 4 && N != 8) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 1,2,4,8 for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 1,2,4,8 for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -10519,11 +8423,10 @@ CM_API void __write_typed_atomic_impl(SurfaceIndex & buf_id, CmAtomicOpType op,
         else {
             switch (op) {
             case ATOMIC_CMPXCHG:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = ((ret(i) == src1(i)) ? src0(i) : ret(i));
+                ret(i) = CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), src0(i), src1(i), buf_id.get_data());
                 break;
             default:
-                GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data() & 0xFF);
+                GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data());
                 exit(EXIT_FAILURE);
             }
         }
@@ -10536,24 +8439,24 @@ CM_API void __write_typed_atomic_impl(SurfaceIndex & buf_id, CmAtomicOpType op,
     vector<uint, N> u, int v, int r, int LOD)
 {
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-        CmEmulSys::search_buffer(buf_id.get_data() & 0xFF);
+        CmEmulSys::search_buffer(buf_id.get_data());
 
     if (buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data() & 0xFF, buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if (op > ATOMIC_FMAX) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
     if (N != 1 && N != 2 && N != 4 && N != 8) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 1,2,4,8 for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 1,2,4,8 for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -10582,111 +8485,23 @@ CM_API void __write_typed_atomic_impl(SurfaceIndex & buf_id, CmAtomicOpType op,
         else {
             switch (op) {
             case ATOMIC_ADD:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = ret(i) + src0(i);
-                break;
             case ATOMIC_SUB:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = ret(i) - src0(i);
-                break;
             case ATOMIC_MIN:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (!is_fp_type<T>::value) {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint)ret(i) <= (uint)src0(i)) ? ret(i) : src0(i));
-                }
-                break;
             case ATOMIC_MAX:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (!is_fp_type<T>::value) {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((uint)ret(i) >= (uint)src0(i)) ? ret(i) : src0(i));
-                }
-                break;
             case ATOMIC_XCHG:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = src0(i);
-                break;
             case ATOMIC_AND:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (std::is_same_v <T, uint>)
-                {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)ret(i)& (uint)src0(i);
-                }
-                else if (std::is_same_v <T, int>)
-                {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (int)ret(i)& (int)src0(i);
-                }
-                else
-                {
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                    exit(EXIT_FAILURE);
-                }
-                break;
             case ATOMIC_OR:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (std::is_same_v <T, uint>)
-                {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)ret(i) | (uint)src0(i);
-                }
-                else if (std::is_same_v <T, int>)
-                {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (int)ret(i) | (int)src0(i);
-                }
-                else
-                {
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                    exit(EXIT_FAILURE);
-                }
-                break;
             case ATOMIC_XOR:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (std::is_same_v <T, uint>)
-                {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (uint)ret(i) ^ (uint)src0(i);
-                }
-                else if (std::is_same_v <T, int>)
-                {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (int)ret(i) ^ (int)src0(i);
-                }
-                else
-                {
-                    GFX_EMU_ERROR_MESSAGE("writing buffer %d: unsupported opcode/type for DWord atomic write!\n", buf_id.get_data() & 0xFF);
-                    exit(EXIT_FAILURE);
-                }
-                break;
             case ATOMIC_MINSINT:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = (((int)ret(i) <= (int)src0(i)) ? ret(i) : src0(i));
-                break;
             case ATOMIC_MAXSINT:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = (((int)ret(i) >= (int)src0(i)) ? ret(i) : src0(i));
-                break;
             case ATOMIC_FADD:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (is_fp_type<T>::value) {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (float)ret(i) + (float)src0(i);
-                }
-                break;
             case ATOMIC_FSUB:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (is_fp_type<T>::value) {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (float)ret(i) - (float)src0(i);
-                }
-                break;
             case ATOMIC_FMIN:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (is_fp_type<T>::value) {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)ret(i) <= (float)src0(i)) ? ret(i) : src0(i));
-                }
-                break;
             case ATOMIC_FMAX:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                if (is_fp_type<T>::value) {
-                    *((T*)((char*)buff_iter->p_volatile + pos)) = (((float)ret(i) >= (float)src0(i)) ? ret(i) : src0(i));
-                }
+                ret(i) = CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), src0(i), (T)0, buf_id.get_data());
                 break;
             default:
-                GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data() & 0xFF);
+                GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data());
                 exit(EXIT_FAILURE);
             }
         }
@@ -10699,24 +8514,24 @@ CM_API void __write_typed_atomic_impl(SurfaceIndex & buf_id, CmAtomicOpType op,
     vector<uint, N> u, int v, int r, int LOD)
 {
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter =
-        CmEmulSys::search_buffer(buf_id.get_data() & 0xFF);
+        CmEmulSys::search_buffer(buf_id.get_data());
 
     if (buff_iter == CmEmulSys::iobuffers.end()) {
-        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data() & 0xFF, buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("reading buffer %d: buffer %d is not registered!\n", buf_id.get_data(), buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if (buff_iter->bclass != GEN4_INPUT_OUTPUT_BUFFER) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: the buffer type must be GEN4_INPUT_OUTPUT_BUFFER for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
     if (op > ATOMIC_FMAX) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
     if (N != 1 && N != 2 && N != 4 && N != 8) {
-        GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 1,2,4,8 for typed atomic write!\n", buf_id.get_data() & 0xFF);
+        GFX_EMU_ERROR_MESSAGE("writing buffer %d: src length must be 1,2,4,8 for typed atomic write!\n", buf_id.get_data());
         exit(EXIT_FAILURE);
     }
 
@@ -10745,15 +8560,11 @@ CM_API void __write_typed_atomic_impl(SurfaceIndex & buf_id, CmAtomicOpType op,
         else {
             switch (op) {
             case ATOMIC_INC:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = ret(i) + 1;
-                break;
             case ATOMIC_DEC:
-                ret(i) = *((T*)((char*)buff_iter->p_volatile + pos));
-                *((T*)((char*)buff_iter->p_volatile + pos)) = ret(i) - 1;
+                ret(i) = CM_genx_atomic_apply(op, (T*)((char*)buff_iter->p_volatile + pos), (T)0, (T)0, buf_id.get_data());
                 break;
             default:
-                GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data() & 0xFF);
+                GFX_EMU_ERROR_MESSAGE("writing buffer %d: invalid opcode for typed atomic write!\n", buf_id.get_data());
                 exit(EXIT_FAILURE);
             }
         }
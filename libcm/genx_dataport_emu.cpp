@@ -9,6 +9,8 @@ SPDX-License-Identifier: MIT
 #define CM_EMU
 
 #include <assert.h>
+#include <atomic>
+#include <unordered_map>
 
 #include "cm_lib.h"
 #include "genx_lib.h"
@@ -26,9 +28,137 @@ using namespace std;
 #endif /* _WIN32 */
 
 #define GLOBAL_SURFACE_INDEX_NUMBER 4
- const int maxbsize = 255;
+ const int maxbsize = 1 << 20;
 CMRT_LIBCM_API cm_list<CmEmulSys::iobuffer> CmEmulSys::iobuffers; /* List of allocated (loaded) genx i/o buffers */
 
+/* Direct-indexed view of iobuffers keyed by surface index. Only buffer
+ * registration and unregistration write it, under the dataport critical
+ * section; dataport accesses from running kernels read it without locking.
+ * A slot is cleared before its list node is released and set only once the
+ * node is fully built, so a reader sees either a complete descriptor or none.
+ * Slots live in pages allocated on the first registration into them and kept
+ * until exit, so the table costs memory only for index ranges in use.
+ */
+typedef cm_list<CmEmulSys::iobuffer>::iterator::cm_node_ptr iobuffer_node_ptr;
+
+const int iobuffer_page_bits = 10;
+const int iobuffer_page_size = 1 << iobuffer_page_bits;
+
+struct iobuffer_page {
+    std::atomic<iobuffer_node_ptr> slots[iobuffer_page_size];
+};
+static std::atomic<iobuffer_page*> iobuffer_table[maxbsize >> iobuffer_page_bits];
+
+static iobuffer_node_ptr lookup_buffer(int id)
+{
+    iobuffer_page *page = iobuffer_table[id >> iobuffer_page_bits].load(std::memory_order_acquire);
+    if (page == NULL) {
+        return NULL;
+    }
+    return page->slots[id & (iobuffer_page_size - 1)].load(std::memory_order_acquire);
+}
+
+static void publish_buffer(int id, iobuffer_node_ptr node)
+{
+    if (id < 0 || id >= maxbsize) {
+        return;
+    }
+    iobuffer_page *page = iobuffer_table[id >> iobuffer_page_bits].load(std::memory_order_relaxed);
+    if (page == NULL) {
+        if (node == NULL) {
+            return;
+        }
+        page = new iobuffer_page();
+        iobuffer_table[id >> iobuffer_page_bits].store(page, std::memory_order_release);
+    }
+    page->slots[id & (iobuffer_page_size - 1)].store(node, std::memory_order_release);
+}
+
+/* Derives the per-surface accessor selection from the pixel format once,
+ * so dataport accesses do not decode the format on every element.
+ */
+static void set_buffer_format(CmEmulSys::iobuffer &buff, CmSurfaceFormatID surfFormat)
+{
+    buff.pixelFormat = surfFormat;
+    buff.bpp = CM_genx_bytes_per_pixel(surfFormat);
+    if (surfFormat == YCRCB_NORMAL) {
+        buff.formatClass = GENX_FORMAT_YCRCB_NORMAL;
+    } else if (surfFormat == YCRCB_SWAPY) {
+        buff.formatClass = GENX_FORMAT_YCRCB_SWAPY;
+    } else {
+        buff.formatClass = GENX_FORMAT_LINEAR;
+    }
+}
+
+/* Registered buffers by their data pointer, to check new registrations
+ * against without walking iobuffers. Guarded by the dataport critical section.
+ */
+static std::unordered_multimap<void *, iobuffer_node_ptr> iobuffers_by_src;
+
+static void add_buffer(const CmEmulSys::iobuffer &buff)
+{
+    CmEmulSys::iobuffers.add(buff);
+    iobuffer_node_ptr node = CmEmulSys::iobuffers.begin()._Ptr;
+    iobuffers_by_src.emplace(buff.p, node);
+    publish_buffer(buff.id, node);
+}
+
+static void remove_buffer(cm_list<CmEmulSys::iobuffer>::iterator buff_iter)
+{
+    int id = buff_iter->id;
+    if (id >= 0 && id < maxbsize && lookup_buffer(id) == buff_iter._Ptr) {
+        publish_buffer(id, NULL);
+    }
+    auto range = iobuffers_by_src.equal_range(buff_iter->p);
+    for (auto src_iter = range.first; src_iter != range.second; ++src_iter) {
+        if (src_iter->second == buff_iter._Ptr) {
+            iobuffers_by_src.erase(src_iter);
+            break;
+        }
+    }
+    CmEmulSys::iobuffers.remove(buff_iter);
+}
+
+/* Re-keys a registered buffer under a new surface index. The old slot is
+ * cleared only if it still refers to this buffer, since a surface moved in
+ * its place may already have been published there.
+ */
+static void move_buffer(cm_list<CmEmulSys::iobuffer>::iterator buff_iter, int id)
+{
+    int old_id = buff_iter->id;
+    if (old_id >= 0 && old_id < maxbsize && lookup_buffer(old_id) == buff_iter._Ptr) {
+        publish_buffer(old_id, NULL);
+    }
+    buff_iter->id = id;
+    publish_buffer(id, buff_iter._Ptr);
+}
+
+/* Finds the most recently registered buffer on src satisfying match. */
+template <typename Match>
+static cm_list<CmEmulSys::iobuffer>::iterator find_buffer_by_src(void *src, Match match)
+{
+    cm_list<CmEmulSys::iobuffer>::iterator it = CmEmulSys::iobuffers.end();
+    int matches = 0;
+
+    auto range = iobuffers_by_src.equal_range(src);
+    for (auto src_iter = range.first; src_iter != range.second; ++src_iter) {
+        cm_list<CmEmulSys::iobuffer>::iterator candidate(src_iter->second);
+        if (match(*candidate)) {
+            it = candidate;
+            matches++;
+        }
+    }
+    if (matches > 1) {
+        // Several registrations share src; iobuffers keeps the newest first.
+        for (it = CmEmulSys::iobuffers.begin(); it != CmEmulSys::iobuffers.end(); ++it) {
+            if ((it->p == src) && match(*it)) {
+                break;
+            }
+        }
+    }
+    return it;
+}
+
 CMRT_LIBCM_API SurfaceIndex* globalSurfaceIndex[4];
 ushort thread_origin_x = 0;
 ushort thread_origin_y = 0;
@@ -40,6 +170,11 @@ CM_API CmEmulSys::search_buffer(int id)
 {
     cm_list<CmEmulSys::iobuffer>::iterator it;
 
+    if (id >= 0 && id < maxbsize) {
+        iobuffer_node_ptr node = lookup_buffer(id);
+        return node ? cm_list<CmEmulSys::iobuffer>::iterator(node) : CmEmulSys::iobuffers.end();
+    }
+
     CmEmulSys::enter_dataport_cs();
     for (it = CmEmulSys::iobuffers.begin(); it != CmEmulSys::iobuffers.end(); ++it) {
         if (it->id == id) {
@@ -57,11 +192,9 @@ CmEmulSys::search_buffer(void *src, CmBufferType bclass)
     cm_list<CmEmulSys::iobuffer>::iterator it;
 
     CmEmulSys::enter_dataport_cs();
-    for (it = CmEmulSys::iobuffers.begin(); it != CmEmulSys::iobuffers.end(); ++it) {
-        if ((it->p == src) && (it->bclass == bclass)) {
-            break;
-        }
-    }
+    it = find_buffer_by_src(src, [bclass](const CmEmulSys::iobuffer &buff) {
+        return buff.bclass == bclass;
+    });
     CmEmulSys::leave_dataport_cs();
     return it;
 }
@@ -72,11 +205,9 @@ CmEmulSys::search_buffer(void *src)
     cm_list<CmEmulSys::iobuffer>::iterator it;
 
     CmEmulSys::enter_dataport_cs();
-    for (it = CmEmulSys::iobuffers.begin(); it != CmEmulSys::iobuffers.end(); ++it) {
-        if (it->p == src) {
-            break;
-        }
-    }
+    it = find_buffer_by_src(src, [](const CmEmulSys::iobuffer &) {
+        return true;
+    });
     CmEmulSys::leave_dataport_cs();
     return it;
 }
@@ -114,8 +245,12 @@ CM_API void set_color(ushort c)
     color = c;
 }
 
+// Media objects run in parallel, each with its own origin and color; the
+// globals above serve kernels run otherwise.
 CM_API ushort get_color()
 {
+    if (auto item = cmrt::get_media_work_item())
+        return item->color;
     return color;
 }
 
@@ -123,6 +258,8 @@ CM_API ushort get_thread_origin_x()
 {
     if(GfxEmu::Cfg::Platform ().getInt () >= GfxEmu::Platform::XEHP_SDV)
         return cm_group_id(0);
+    if (auto item = cmrt::get_media_work_item())
+        return item->originX;
     return thread_origin_x;
 }
 
@@ -130,6 +267,8 @@ CM_API ushort get_thread_origin_y()
 {
     if(GfxEmu::Cfg::Platform ().getInt () >= GfxEmu::Platform::XEHP_SDV)
         return cm_group_id(1);
+    if (auto item = cmrt::get_media_work_item())
+        return item->originY;
     return thread_origin_y;
 }
 
@@ -146,7 +285,7 @@ CM_unregister_buffer_emu(int buf_id)
         //    memcpy(buff_iter->p, buff_iter->p_volatile, (buff_iter->width)*(buff_iter->height)*(buff_iter->depth));
         //    free(buff_iter->p_volatile);
         //}
-        CmEmulSys::iobuffers.remove(buff_iter);
+        remove_buffer(buff_iter);
     }
     CmEmulSys::leave_dataport_cs();
 }
@@ -156,7 +295,7 @@ CM_register_buffer_emu(int buf_id, CmBufferType bclass, void *src, uint width, u
                        CmSurfaceFormatID surfFormat, uint depth, uint pitch)
 {
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter;
-    assert((buf_id < maxbsize) && ((int)CmEmulSys::iobuffers.size() < maxbsize));
+    assert((buf_id >= 0) && (buf_id < maxbsize));
 
     CmEmulSys::enter_dataport_cs();
 
@@ -173,7 +312,7 @@ CM_register_buffer_emu(int buf_id, CmBufferType bclass, void *src, uint width, u
 
     new_buff.id = buf_id;
     new_buff.bclass = bclass;
-    new_buff.pixelFormat = surfFormat;
+    set_buffer_format(new_buff, surfFormat);
     new_buff.p = src;
     new_buff.width = width;
     new_buff.height = height;
@@ -196,7 +335,7 @@ CM_register_buffer_emu(int buf_id, CmBufferType bclass, void *src, uint width, u
         new_buff.p_volatile = NULL;
     }
 
-    CmEmulSys::iobuffers.add(new_buff);
+    add_buffer(new_buff);
     CmEmulSys::leave_dataport_cs();
 }
 
@@ -216,7 +355,7 @@ CM_modify_buffer_emu(int buf_id, CmBufferDescField field, int value)
         switch (field)
         {
         case GEN4_FIELD_SURFACE_FORMAT:
-            buff_iter->pixelFormat = (CmSurfaceFormatID)value;
+            set_buffer_format(*buff_iter, (CmSurfaceFormatID)value);
             break;
         case GEN4_FIELD_SURFACE_TYPE:
         case GEN4_FIELD_TILE_FORMAT:
@@ -249,7 +388,7 @@ CM_unregister_buffer_emu(SurfaceIndex buf_id, bool copy)
             //}
             //free(buff_iter->p_volatile);
         }
-        CmEmulSys::iobuffers.remove(buff_iter);
+        remove_buffer(buff_iter);
     }
     CmEmulSys::leave_dataport_cs();
 }
@@ -260,7 +399,7 @@ CM_register_buffer_emu(SurfaceIndex buf_id, CmBufferType bclass, void *src, uint
 {
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter;
 
-    assert((buf_id.get_data() < maxbsize) && ((int)CmEmulSys::iobuffers.size() < maxbsize));
+    assert(buf_id.get_data() < maxbsize);
     CmEmulSys::enter_dataport_cs();
 
     CM_unregister_buffer_emu(buf_id.get_data());
@@ -269,7 +408,7 @@ CM_register_buffer_emu(SurfaceIndex buf_id, CmBufferType bclass, void *src, uint
 
     new_buff.id = buf_id.get_data();
     new_buff.bclass = bclass;
-    new_buff.pixelFormat = surfFormat;
+    set_buffer_format(new_buff, surfFormat);
     new_buff.p = src;
     new_buff.width = width;
     new_buff.height = height;
@@ -291,7 +430,7 @@ CM_register_buffer_emu(SurfaceIndex buf_id, CmBufferType bclass, void *src, uint
     } else {
         new_buff.p_volatile = NULL;
     }
-    CmEmulSys::iobuffers.add(new_buff);
+    add_buffer(new_buff);
     CmEmulSys::leave_dataport_cs();
 }
 
@@ -310,10 +449,10 @@ CM_modify_buffer_emu(SurfaceIndex buf_id, CmBufferDescField field, int value)
         switch (field)
         {
         case GEN4_FIELD_SURFACE_FORMAT:
-            buff_iter->pixelFormat = (CmSurfaceFormatID)value;
+            set_buffer_format(*buff_iter, (CmSurfaceFormatID)value);
             break;
         case GEN4_FIELD_SURFACE_ID:
-            buff_iter->id = value;
+            move_buffer(buff_iter, value);
             break;
         case GEN4_FIELD_SURFACE_TYPE:
         case GEN4_FIELD_TILE_FORMAT:
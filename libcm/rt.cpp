@@ -7,11 +7,24 @@ SPDX-License-Identifier: MIT
 ============================= end_copyright_notice ===========================*/
 
 #include <chrono>
+#include <cstring>
+#include <map>
+#include <regex>
+#include <unordered_map>
+#include <unordered_set>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
 
 #include <cm_priv_def.h>
 #include <cm_kernel_base.h>
 
 #include "rt.h"
+#include "rt_fiber.h"
+#include "rt_worker_pool.h"
 #include "emu_log.h"
 #include "emu_kernel_support.h"
 #include "emu_utils.h"
@@ -83,93 +96,136 @@ CmEmu_KernelLauncher::CmEmu_KernelLauncher(
             m_args.at(i++).annotate(a);
     }
 #endif
+
+    m_invoker = find_kernel_invoker(m_kernel_func_ptr, m_args);
+    if (!m_invoker)
+        m_plan = get_launch_plan(m_args);
+
+    // Argument buffers are shared by the launcher copies, so the slots stay
+    // valid for as long as any copy lives.
+    m_arg_slots.reserve(m_args.size ());
+    for (const auto& a: m_args) {
+        const auto base = static_cast<uint8_t*>(a.getBufferPtr(0));
+        m_arg_slots.push_back({
+            base,
+            a.isPerThread () ? static_cast<size_t>(static_cast<uint8_t*>(a.getBufferPtr(1)) - base) : 0,
+            a.getUnitCount ()});
+    }
 }
 
 CmEmu_KernelLauncher::~CmEmu_KernelLauncher()
 {
 }
 
+void CmEmu_KernelLauncher::set_media_work_items(std::vector<CmEmu_MediaWorkItem> items)
+{
+    m_media_work_items = std::make_shared<const std::vector<CmEmu_MediaWorkItem>>(std::move(items));
+}
+
 void CmEmuMt_Thread::execute() {
     GFX_EMU_MESSAGE_SCOPE_PREFIX(
         std::string{""} +
             "<gid:" + std::to_string(m_group_idx) + ",lid:" + std::to_string(m_local_idx) + "> ");
-    m_kernel_launcher.launch();
+    if (m_kernel_launcher->m_media_work_items) {
+        // Work-item objects are rebound to other groups, so this is not cached.
+        m_media_work_item = &m_kernel_launcher->m_media_work_items->at(m_group_idx);
+        m_kernel_launcher->launch(m_media_work_item->threadId);
+        return;
+    }
+    if (m_thread_linear_id == CmEmu_KernelLauncher::kThreadIdUnset)
+        m_thread_linear_id =
+            m_kernel_launcher->m_thread_linear_id != CmEmu_KernelLauncher::kThreadIdUnset ?
+                m_kernel_launcher->m_thread_linear_id : cmrt::thread_linear_id ();
+    m_kernel_launcher->launch(m_thread_linear_id);
 }
 
-void CmEmu_KernelLauncher::launch()
-{
-#ifdef LIBFFI_FOUND
+//-----------------------------------------------------------------------------
+namespace {
+struct KernelInvokerDesc {
+    CmEmuKernelInvoker invoker;
+    std::vector<size_t> argSizes;
+};
 
-    if(m_thread_linear_id == kThreadIdUnset) {
-         m_thread_linear_id = cmrt::thread_linear_id ();
-    }
+// Filled in during static initialization of kernel modules.
+std::mutex& kernel_invokers_mtx() {
+    static std::mutex mtx;
+    return mtx;
+}
 
-    class FfiArgData
-    {
+auto& kernel_invokers() {
+    static std::unordered_map<CmEmu_KernelLauncher::VoidFuncPtr, KernelInvokerDesc> registry;
+    return registry;
+}
+}
 
-    private:
-        std::vector<ffi_type*> classMemberDescPtrs;
-        ffi_type classTypeDesc;
-        void* argPtr__ {nullptr};
-
-    public:
-        ffi_type* typeDescPtr;
-        void* argPtr {nullptr};
-
-        FfiArgData () = default;
-        void create (
-                const bool isPointer,
-                const bool isFloat,
-                bool isClass,
-                size_t size,
-                void* argPtr_
-        ) {
-            isClass |= size > sizeof(uint64_t); // Fallback in case no kernel arguments metadata.
-
-            if(isClass) {
-#if defined(_WIN32)
-                classTypeDesc.size = classTypeDesc.alignment = 0;
-                classTypeDesc.type = FFI_TYPE_STRUCT;
-                while (size--) classMemberDescPtrs.push_back(&ffi_type_uchar);
-                classMemberDescPtrs.push_back(nullptr);
+void register_kernel_invoker(
+    void(*kernel)(),
+    CmEmuKernelInvoker invoker,
+    const size_t* argSizes,
+    size_t argsCount)
+{
+    std::lock_guard<std::mutex> lk(kernel_invokers_mtx ());
+    kernel_invokers ()[kernel] = {invoker, {argSizes, argSizes + argsCount}};
+}
 
-                classTypeDesc.elements =
-                    (ffi_type**)classMemberDescPtrs.data();
+CmEmuKernelInvoker CmEmu_KernelLauncher::find_kernel_invoker(
+    VoidFuncPtr kernel,
+    const std::vector<GfxEmu::KernelArg>& args)
+{
+    std::lock_guard<std::mutex> lk(kernel_invokers_mtx ());
+    const auto& registry = kernel_invokers ();
+    const auto it = registry.find(kernel);
+    if (it == registry.end ())
+        return nullptr;
+
+    const auto& argSizes = it->second.argSizes;
+    bool matches = argSizes.size () == args.size ();
+    for (size_t i = 0; matches && i < args.size (); ++i)
+        matches = argSizes[i] == args[i].getUnitSize ();
+
+    if (!matches) {
+        GFX_EMU_WARNING_MESSAGE(fKernelLaunch,
+            "arguments set for kernel at %p don't match its registered signature, "
+            "calling it through libffi.\n", kernel);
+        return nullptr;
+    }
 
-                typeDescPtr = &classTypeDesc;
-                argPtr = argPtr_;
-#else
-                argPtr__ = argPtr_;
-                argPtr = &argPtr__;
-                typeDescPtr = &ffi_type_pointer;
+    return it->second.invoker;
+}
+
+//-----------------------------------------------------------------------------
+// Prepared libffi call interface for a kernel arguments signature. Built once
+// per signature and shared by all the launches and work-items using it.
+struct CmEmu_LaunchPlan
+{
+#ifdef LIBFFI_FOUND
+    ffi_cif                                 cif;
+    std::vector<ffi_type*>                  argTypes;
+    std::vector<bool>                       passByPointer; // Argument value is passed as a pointer to it.
+    std::list<ffi_type>                     classTypes; // NB: referenced from argTypes, no relocations please.
+    std::list<std::vector<ffi_type*>>       classMembers;
 #endif
-            } else {
-                argPtr = argPtr_;
-                typeDescPtr =
-                    isPointer ? &ffi_type_pointer :
-                    isFloat ? (
-                        size == sizeof(double) ?      &ffi_type_double :
-                        size == sizeof(long double) ? &ffi_type_longdouble :
-                                                      &ffi_type_float ) :
-                    size == sizeof(uint8_t) ?  &ffi_type_uint8 :
-                    size == sizeof(uint16_t) ? &ffi_type_uint16 :
-                    size == sizeof(uint32_t) ? &ffi_type_uint32 :
-                    size == sizeof(uint64_t) ? &ffi_type_uint64 :
-                                               &ffi_type_pointer
-                ;
-            }
-        }
-    };
+};
 
-    std::vector<FfiArgData> ffiArgsData {m_args.size()}; // NB: will contain self-referrenced data, no relocations please.
+std::shared_ptr<CmEmu_LaunchPlan> CmEmu_KernelLauncher::get_launch_plan(
+    const std::vector<GfxEmu::KernelArg>& args)
+{
+#ifdef LIBFFI_FOUND
+    std::string signature;
+    for (const auto& arg: args)
+        signature += std::to_string(arg.isPointer) + std::to_string(arg.isFloat) +
+            std::to_string(arg.isClass) + ":" + std::to_string(arg.getUnitSize ()) + ",";
 
-    std::vector<ffi_type*> argsLibFfiT;
-    std::vector<void*> argsLibFfiV;
-    int argIdx = 0;
-    for (const auto& arg: m_args) {
+    static std::mutex plansMtx;
+    static std::map<std::string, std::shared_ptr<CmEmu_LaunchPlan>> plans;
 
-        auto& ffiArgData = ffiArgsData[argIdx++];
+    std::lock_guard<std::mutex> lk(plansMtx);
+    auto& plan = plans[signature];
+    if (plan)
+        return plan;
 
+    plan = std::make_shared<CmEmu_LaunchPlan>();
+    for (const auto& arg: args) {
         GFX_EMU_MESSAGE(fKernelLaunch | fDetail,
                 "arg %s of type %s info: isPtr: %u, isFloat: %u, isClass: %u, size: %u\n",
             arg.name.c_str (),
@@ -179,81 +235,157 @@ void CmEmu_KernelLauncher::launch()
             arg.isClass,
             arg.getUnitSize ());
 
-        ffiArgData.create(
-            arg.isPointer,
-            arg.isFloat,
-            arg.isClass,
-            arg.getUnitSize (),
-            arg.getBufferPtr(arg.isPerThread () ? m_thread_linear_id : 0)
-        );
+        auto size = arg.getUnitSize ();
+        const bool isClass = arg.isClass ||
+            size > sizeof(uint64_t); // Fallback in case no kernel arguments metadata.
+        bool passByPointer = false;
+        ffi_type* typeDescPtr = nullptr;
+
+        if(isClass) {
+#if defined(_WIN32)
+            auto& members = plan->classMembers.emplace_back();
+            while (size--) members.push_back(&ffi_type_uchar);
+            members.push_back(nullptr);
+
+            auto& classTypeDesc = plan->classTypes.emplace_back();
+            classTypeDesc.size = classTypeDesc.alignment = 0;
+            classTypeDesc.type = FFI_TYPE_STRUCT;
+            classTypeDesc.elements = members.data();
+            typeDescPtr = &classTypeDesc;
+#else
+            passByPointer = true;
+            typeDescPtr = &ffi_type_pointer;
+#endif
+        } else {
+            typeDescPtr =
+                arg.isPointer ? &ffi_type_pointer :
+                arg.isFloat ? (
+                    size == sizeof(double) ?      &ffi_type_double :
+                    size == sizeof(long double) ? &ffi_type_longdouble :
+                                                  &ffi_type_float ) :
+                size == sizeof(uint8_t) ?  &ffi_type_uint8 :
+                size == sizeof(uint16_t) ? &ffi_type_uint16 :
+                size == sizeof(uint32_t) ? &ffi_type_uint32 :
+                size == sizeof(uint64_t) ? &ffi_type_uint64 :
+                                           &ffi_type_pointer
+            ;
+        }
 
-        argsLibFfiT.emplace_back(ffiArgData.typeDescPtr);
-        argsLibFfiV.emplace_back(ffiArgData.argPtr);
+        plan->argTypes.push_back(typeDescPtr);
+        plan->passByPointer.push_back(passByPointer);
+    }
+
+    if(ffi_prep_cif(&plan->cif, FFI_DEFAULT_ABI, plan->argTypes.size (), &ffi_type_void, plan->argTypes.data ())
+        != FFI_OK)
+    {
+        GFX_EMU_FAIL_WITH_MESSAGE(fKernelLaunch,
+            "ffi_prep_cif returned not FFI_OK. Unable to prepare data for a kernel call with signature %s\n",
+                signature.c_str ());
+    }
+
+    return plan;
+#else
+    return nullptr;
+#endif
+}
+
+// Work-items only fill in argument value pointers, the call itself is either
+// a registered typed invoker or libffi call prepared by the launch plan.
+void CmEmu_KernelLauncher::launch(size_t threadLinearId) const
+{
+    constexpr size_t kMaxStackArgs = 32;
+    const auto argsCount = m_arg_slots.size ();
+    void* stackValues[kMaxStackArgs], *stackPointers[kMaxStackArgs];
+    std::vector<void*> heapValues, heapPointers;
+    auto values = stackValues, pointers = stackPointers;
+    if (argsCount > kMaxStackArgs) {
+        heapValues.resize(argsCount);
+        heapPointers.resize(argsCount);
+        values = heapValues.data ();
+        pointers = heapPointers.data ();
     }
 
     GFX_EMU_DEBUG_MESSAGE(fKernelLaunch | fInfo, "calling kernel %s at %p\n",
         m_kernelName.c_str (), m_kernel_func_ptr);
 
-    ffi_cif cif;
-    if(ffi_prep_cif(&cif, FFI_DEFAULT_ABI, argsLibFfiT.size (), &ffi_type_void, argsLibFfiT.data ())
-        == FFI_OK) {
-        ffi_call(
-            &cif,
-            m_kernel_func_ptr,
-            nullptr,
-            argsLibFfiV.data ());
+    auto argPtr = [&](size_t i) -> void* {
+        const auto& slot = m_arg_slots[i];
+        GFX_EMU_ASSERT(!slot.stride || threadLinearId < slot.count);
+        return slot.base + slot.stride * threadLinearId;
+    };
+
+    if (m_invoker) {
+        for (size_t i = 0; i < argsCount; ++i)
+            values[i] = argPtr(i);
+        m_invoker(m_kernel_func_ptr, values);
+        return;
     }
-    else
-        GFX_EMU_FAIL_WITH_MESSAGE(fKernelLaunch,
-            "ffi_prep_cif returned not FFI_OK. Unable to prepare data for and call kernel at %p\n",
-                m_kernel_func_ptr);
 
+#ifdef LIBFFI_FOUND
+    for (size_t i = 0; i < argsCount; ++i) {
+        if (m_plan->passByPointer[i]) {
+            pointers[i] = argPtr(i);
+            values[i] = &pointers[i];
+        } else
+            values[i] = argPtr(i);
+    }
+
+    ffi_call(
+        &m_plan->cif,
+        m_kernel_func_ptr,
+        nullptr,
+        values);
+#else
+    GFX_EMU_FAIL_WITH_MESSAGE(fKernelLaunch,
+        "kernel at %p has no registered invoker (CM_EMU_REGISTER_KERNEL) and libffi is not available.\n",
+            m_kernel_func_ptr);
 #endif // LIBFFI_FOUND
 }
 
 //=============================================================================
 void CmEmuMt_ThreadBell::wait_for_ring() {
-
-    std::unique_lock<std::mutex> lk(m_mutex);
-    m_condition.wait(lk, [this] {
-         if (this->m_ringing == true) {
-              this->m_ringing = false;
-              return true;
-         } else {
-              return false;
-         }
-    });
+    if (spin_until([this] { return try_take(); }))
+        return;
+
+    for (;;) {
+        uint32_t v = kIdle;
+        if (m_state.compare_exchange_strong(v, kSleeping) || v == kSleeping)
+            futex_wait(m_state, kSleeping);
+        else if (try_take())
+            return;
+    }
 }
 
 //-----------------------------------------------------------------------------
 void CmEmuMt_ThreadBell::ring() {
-    std::lock_guard<std::mutex> lk(m_mutex);
-    m_ringing = true;
-    m_condition.notify_all();
+    if (m_state.exchange(kRinging) == kSleeping)
+        futex_wake_one(m_state);
 }
 
 //=============================================================================
 CmEmuMt_Thread::CmEmuMt_Thread(
-                   CmEmu_KernelLauncher launcher,
+                   const CmEmu_KernelLauncher& launcher,
                    CmEmuMt_Kernel* kernel)
     : m_resources(nullptr),
       m_extra_resources(nullptr),
-      m_kernel_launcher(launcher),
+      m_kernel_launcher(&launcher),
       m_kernel(kernel)
 {
     wrapper_debug();
 }
 
 CmEmuMt_Thread::CmEmuMt_Thread(uint32_t local_idx, uint32_t group_idx,
+                   uint32_t slot_idx,
                    std::shared_ptr<CmEmuMt_GroupState> resources,
                    std::shared_ptr<CmEmuMt_GroupState> extra_resources,
-                   CmEmu_KernelLauncher launcher,
+                   const CmEmu_KernelLauncher& launcher,
                    CmEmuMt_Kernel* kernel)
     : m_local_idx(local_idx),
       m_group_idx(group_idx),
+      m_slot_idx(slot_idx),
       m_resources(resources),
       m_extra_resources(extra_resources),
-      m_kernel_launcher(launcher),
+      m_kernel_launcher(&launcher),
       m_kernel(kernel)
 {
     state(CmEmuMt_Thread::State::Unspawned);
@@ -265,32 +397,51 @@ CmEmuMt_Thread::~CmEmuMt_Thread() {}
 
 //-----------------------------------------------------------------------------
 void CmEmuMt_Thread::suspend() {
-    kernel()->suspend_thread(this);
+    if (m_parallel_for) {
+        // A yield, e.g. this_thread_yield () from a spin-wait poll, may wait
+        // for a work-item of the group not run yet, so the group has to be
+        // switched to fibers as for a synchronization. A single work-item
+        // group can only wait for other groups, which run on other workers.
+        if (kernel()->group_size () > 1)
+            wait_for_group_state();
+        return;
+    }
+    if (m_fiber)
+        CmEmuMt_Fiber::yield();
+    else
+        kernel()->suspend_thread(this);
 }
 
+void CmEmuMt_Thread::park() {
+    if (m_fiber)
+        CmEmuMt_Fiber::yield();
+    else
+        kernel()->park_thread(this);
+}
+
+// Called by the kernel scheduler when the work-item gets a running slot.
 void CmEmuMt_Thread::resume() {
     GFX_EMU_DEBUG_MESSAGE(fSched | fDetail, "resuming thread with local idx %u\n", local_idx());
 
-        if(m_state.load() == State::Unspawned) {
-            m_os_thread_ptr.reset(new std::thread(&CmEmuMt_Thread::wrapper, this));
-            m_os_thread_ptr->detach ();
-
-            g_stat_current_os_threads.fetch_add(1);
-            GfxEmu::Utils::atomicUpdateMax(g_stat_max_os_threads, g_stat_current_os_threads.load ());
-            GFX_EMU_DEBUG_MESSAGE(fSched | fDetail, "OS threads stat: current: %u, max: %u\n",
-                g_stat_current_os_threads.load(),
-                g_stat_max_os_threads.load());
-
-            while(!suspended());
-        }
-
-    kernel()->resume_thread(this);
+    if(m_state.exchange(State::Running) == State::Unspawned) {
+        if (GfxEmu::Cfg::PooledThreads ().getBool ())
+            CmEmuMt_WorkerPool::instance ().spawn([this] { wrapper(); });
+        else
+            std::thread(&CmEmuMt_Thread::wrapper, this).detach ();
+
+        g_stat_current_os_threads.fetch_add(1);
+        GfxEmu::Utils::atomicUpdateMax(g_stat_max_os_threads, g_stat_current_os_threads.load ());
+        GFX_EMU_DEBUG_MESSAGE(fSched | fDetail, "OS threads stat: current: %u, max: %u\n",
+            g_stat_current_os_threads.load(),
+            g_stat_max_os_threads.load());
+    } else
+        m_bell.ring();
 }
 
 //-----------------------------------------------------------------------------
 bool CmEmuMt_Thread::next_group() {
-    m_group_idx += kernel()->resident_groups_limit();
-    if (m_group_idx < kernel()->group_count()) {
+    m_group_idx = kernel()->slot_group(m_slot_idx, ++m_round);
+    if (m_group_idx != CmEmuMt_Kernel::kNoGroup) {
         std::swap(m_resources, m_extra_resources);
         return true;
     }
@@ -323,7 +474,6 @@ void CmEmuMt_Thread::wrapper_debug() {
 
 void CmEmuMt_Thread::wrapper() {
     g_resident_thread = this;
-    suspend();
     do {
         execute();
         aux_barrier()->signal(this);
@@ -333,6 +483,23 @@ void CmEmuMt_Thread::wrapper() {
     complete();
 }
 
+// Fiber entry: the worker runs a whole work-group before taking the next one,
+// so there is no need in resources ping-pong or aux barrier here.
+void CmEmuMt_Thread::wrapper_fiber(void* p) {
+    static_cast<CmEmuMt_Thread*>(p)->execute();
+}
+
+void CmEmuMt_Thread::rebind(
+    uint32_t group_idx,
+    std::shared_ptr<CmEmuMt_GroupState> resources,
+    CmEmuMt_Fiber* fiber)
+{
+    m_group_idx = group_idx;
+    m_resources = std::move(resources);
+    m_fiber = fiber;
+    state(State::Running);
+}
+
 //=============================================================================
 
 CmEmuMt_Kernel::CmEmuMt_Kernel(
@@ -379,34 +546,61 @@ CmEmuMt_Kernel::~CmEmuMt_Kernel(){
 }
 
 //-----------------------------------------------------------------------------
+// Running slots are handed over directly by the work-items releasing them,
+// so no scheduler thread needs to poll work-items states.
+void CmEmuMt_Kernel::dispatch_threads() {
+    while (m_running_threads_count < m_parallel_threads_limit && !m_ready_threads.empty ()) {
+        auto thread = m_ready_threads.front ();
+        m_ready_threads.pop_front ();
+        m_running_threads_count++;
+        thread->resume ();
+    }
+}
+
+// Yield: the work-item goes to the back of the ready queue.
 void CmEmuMt_Kernel::suspend_thread(CmEmuMt_Thread* thread) {
-        if (thread->suspended ()) {
-            GFX_EMU_ERROR_MESSAGE("trying to suspend an already suspended thread.\n");
-            exit(EXIT_FAILURE);
-        }
+    if (thread->suspended ()) {
+        GFX_EMU_ERROR_MESSAGE("trying to suspend an already suspended thread.\n");
+        exit(EXIT_FAILURE);
+    }
 
-    if(!thread->suspended () && !thread->unspawned())
-        m_running_threads_count.fetch_sub(1);
+    {
+        std::lock_guard<std::mutex> lk(m_sched_mutex);
+        thread->state(CmEmuMt_Thread::State::Suspended);
+        m_running_threads_count--;
+        m_ready_threads.push_back(thread);
+        dispatch_threads ();
+    }
+    thread->bell()->wait_for_ring();
+    thread->state(CmEmuMt_Thread::State::Running);
+}
 
-    thread->state(CmEmuMt_Thread::State::Suspended);
+// The work-item waits outside of the ready queue until unpark_thread().
+// The bell remembers a ring, so an unpark racing ahead of the park is fine.
+void CmEmuMt_Kernel::park_thread(CmEmuMt_Thread* thread) {
+    {
+        std::lock_guard<std::mutex> lk(m_sched_mutex);
+        thread->state(CmEmuMt_Thread::State::Suspended);
+        m_running_threads_count--;
+        dispatch_threads ();
+    }
     thread->bell()->wait_for_ring();
+    thread->state(CmEmuMt_Thread::State::Running);
 }
 
-//-----------------------------------------------------------------------------
-void CmEmuMt_Kernel::resume_thread(CmEmuMt_Thread * thread) {
-    if (thread->suspended () || thread->unspawned()) {
-        thread->state(CmEmuMt_Thread::State::Running);
-        m_running_threads_count.fetch_add(1);
-        thread->bell()->ring();
-    } else {
-        GFX_EMU_ERROR_MESSAGE("*** Error: trying to resume not a suspended thread.\n");
-        exit(EXIT_FAILURE);
-    };
+void CmEmuMt_Kernel::unpark_thread(CmEmuMt_Thread* thread) {
+    std::lock_guard<std::mutex> lk(m_sched_mutex);
+    m_ready_threads.push_back(thread);
+    dispatch_threads ();
 }
 
 //-----------------------------------------------------------------------------
 void CmEmuMt_Kernel::complete_thread(CmEmuMt_Thread *) {
-    m_running_threads_count.fetch_sub(1);
+    std::lock_guard<std::mutex> lk(m_sched_mutex);
+    m_running_threads_count--;
+    m_completed_threads_count++;
+    dispatch_threads ();
+    m_sched_condition.notify_all ();
 }
 
 //-----------------------------------------------------------------------------
@@ -430,6 +624,278 @@ uint32_t CmEmuMt_Kernel::group_count(uint32_t dim) {
     return m_grid_dims[dim];
 }
 
+//-----------------------------------------------------------------------------
+uint32_t CmEmuMt_Kernel::slot_group(uint32_t slot, uint32_t round) {
+    auto& s = m_slots[slot];
+    std::lock_guard<std::mutex> lk(s.mutex);
+    while (s.groups.size () <= round) {
+        uint32_t group_idx;
+        s.groups.push_back(m_group_deques.pop(slot, group_idx) ? group_idx : kNoGroup);
+    }
+    return s.groups[round];
+}
+
+//=============================================================================
+void CmEmuMt_GroupDeques::reset(uint32_t workersCount, uint32_t groupsCount) {
+    m_count = workersCount;
+    m_ranges.reset(new Range[workersCount]);
+    for (uint32_t i = 0; i < workersCount; ++i) {
+        m_ranges[i].packed.store(pack(
+            (uint64_t)groupsCount * i / workersCount,
+            (uint64_t)groupsCount * (i + 1) / workersCount));
+    }
+}
+
+bool CmEmuMt_GroupDeques::pop(uint32_t worker, uint32_t& group_idx) {
+    return take_own(worker, group_idx) || steal(worker, group_idx);
+}
+
+bool CmEmuMt_GroupDeques::take_own(uint32_t worker, uint32_t& group_idx) {
+    auto& own = m_ranges[worker].packed;
+    auto r = own.load ();
+    while (begin(r) < end(r)) {
+        if (own.compare_exchange_weak(r, pack(begin(r) + 1, end(r)))) {
+            group_idx = begin(r);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Own range is empty here, so no one else updates it until it gets refilled
+// with the stolen part. A group index never comes back to a range once taken,
+// so the compare-exchange loops are free of ABA.
+bool CmEmuMt_GroupDeques::steal(uint32_t worker, uint32_t& group_idx) {
+    for (;;) {
+        uint32_t victim = m_count, victimSize = 0;
+        uint64_t victimRange = 0;
+        for (uint32_t i = 0; i < m_count; ++i) {
+            if (i == worker) continue;
+            const auto r = m_ranges[i].packed.load ();
+            if (end(r) > begin(r) && end(r) - begin(r) > victimSize) {
+                victim = i;
+                victimSize = end(r) - begin(r);
+                victimRange = r;
+            }
+        }
+        if (victim == m_count) return false;
+
+        const auto stolen = (victimSize + 1) / 2;
+        const auto stolenBegin = end(victimRange) - stolen;
+        if (!m_ranges[victim].packed.compare_exchange_strong(
+                victimRange, pack(begin(victimRange), stolenBegin)))
+            continue;
+
+        GFX_EMU_DEBUG_MESSAGE(fSched | fDetail, "worker %u stole %u work-groups from worker %u\n",
+            worker, stolen, victim);
+        group_idx = stolenBegin;
+        m_ranges[worker].packed.store(pack(stolenBegin + 1, end(victimRange)));
+        return true;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Kernels found to use group synchronization, so that they go to the full
+// scheduler directly on the next launches.
+namespace {
+std::mutex g_sync_kernels_mtx;
+std::unordered_set<CmEmu_KernelLauncher::VoidFuncPtr> g_sync_kernels;
+
+bool is_sync_kernel(CmEmu_KernelLauncher::VoidFuncPtr f) {
+    std::lock_guard<std::mutex> lk(g_sync_kernels_mtx);
+    return g_sync_kernels.count(f) != 0;
+}
+
+void add_sync_kernel(CmEmu_KernelLauncher::VoidFuncPtr f) {
+    std::lock_guard<std::mutex> lk(g_sync_kernels_mtx);
+    g_sync_kernels.insert(f);
+}
+}
+
+bool CmEmuMt_Kernel::parallel_for_enabled() {
+    if (is_sync_kernel(m_kernel_launcher.m_kernel_func_ptr))
+        return false;
+
+    if (GfxEmu::Cfg::SchedMode ().getInt () == GfxEmu::Sched::AUTO)
+        return true;
+
+    static const auto& kernelsRxStr = GfxEmu::Cfg::ParallelForKernels ().getStr ();
+    static const std::regex kernelsRx {kernelsRxStr};
+    return !kernelsRxStr.empty () &&
+        std::regex_search(m_kernel_launcher.m_kernelName, kernelsRx);
+}
+
+// A parallel-for work-item runs on a fiber with no group state. The first
+// time it needs one, or yields, it hands the fiber back to the worker, which
+// binds a group state to the whole group and clears m_parallel_for.
+void CmEmuMt_Thread::wait_for_group_state() {
+    CmEmuMt_Fiber::yield();
+}
+
+// Fibers are kept per OS thread across kernel launches, so pooled workers
+// do not allocate stacks on every run.
+static std::vector<std::unique_ptr<CmEmuMt_Fiber>>& worker_fibers(uint32_t count)
+{
+    thread_local std::vector<std::unique_ptr<CmEmuMt_Fiber>> fibers;
+    thread_local size_t fibersStackSize = 0;
+
+    const size_t stackSize = GfxEmu::Cfg::FiberStackSize ().getInt ();
+    if (stackSize != fibersStackSize) {
+        fibers.clear ();
+        fibersStackSize = stackSize;
+    }
+    while (fibers.size () < count)
+        fibers.emplace_back(std::make_unique<CmEmuMt_Fiber>(stackSize));
+    return fibers;
+}
+
+// Runs the work-items of a group bound to the fibers, switching them in
+// round-robin order until all of them complete. Returns false on timeout.
+static bool run_group_fibers(
+    std::list<CmEmuMt_Thread>& workItems,
+    std::vector<std::unique_ptr<CmEmuMt_Fiber>>& fibers,
+    std::chrono::steady_clock::time_point deadline)
+{
+    uint32_t pending = 0;
+    for (size_t i = 0; i < workItems.size (); ++i)
+        if (!fibers[i]->finished ()) pending++;
+
+    while (pending) {
+        auto fiberIt = fibers.begin ();
+        for (auto& workItem: workItems) {
+            auto& fiber = *fiberIt++;
+            if (fiber->finished ()) continue;
+            g_resident_thread = &workItem;
+            fiber->switch_to ();
+            if (fiber->finished ()) pending--;
+        }
+
+        if (pending && std::chrono::steady_clock::now () > deadline) {
+            // Abandoned fibers are still inside the kernel and can not be
+            // reused.
+            fibers.clear ();
+            return false;
+        }
+    }
+    return true;
+}
+
+// Parallel-for runs the work-items of a group one after another on a single
+// fiber, which is left to the work-item that needs the group state.
+namespace {
+struct GroupLoop
+{
+    std::list<CmEmuMt_Thread>* workItems;
+    uint32_t                   current {0};     // Index of the work-item being run.
+    bool                       stopped {false}; // Set when the group goes to the fibers scheduler.
+};
+
+void run_group_loop(void* p) {
+    auto& loop = *static_cast<GroupLoop*>(p);
+    for (auto& workItem: *loop.workItems) {
+        g_resident_thread = &workItem;
+        workItem.execute ();
+        if (loop.stopped) return;
+        loop.current++;
+    }
+}
+}
+
+// Runs work-items as a plain loop over work-groups on the pool workers: the
+// work-items of a group run one after another to completion, with no group
+// state and no yields. A work-item calling a group synchronization or SLM
+// helper, or yielding, suspends the loop instead; the worker then binds a group state to
+// the group and finishes it in fibers mode, resuming that work-item where it
+// stopped. No work-item is run twice.
+bool CmEmuMt_Kernel::run_parallel_for(double timeout)
+{
+    const auto kernelFunc = m_kernel_launcher.m_kernel_func_ptr;
+    const auto workersCount = std::min(m_parallel_threads_limit, m_group_count);
+
+    GFX_EMU_MESSAGE(fSched, "running kernel %s at %p in parallel-for mode.\n",
+        m_kernel_launcher.m_kernelName.c_str (), kernelFunc);
+    GFX_EMU_MESSAGE(fSched, "work-groups: %d\n", m_group_count);
+    GFX_EMU_MESSAGE(fSched, "parallel-for workers: %d\n", workersCount);
+
+    const auto deadline = std::chrono::steady_clock::now () +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>{timeout});
+    std::atomic<bool> syncRequired {false}, timedOut {false};
+
+    m_group_deques.reset(workersCount, m_group_count);
+
+    CmEmuMt_WorkerPool::instance ().parallel_for(workersCount, [&] (uint32_t workerIdx) {
+        CmEmuMt_Fiber::thread_init();
+
+        auto& fibers = worker_fibers(m_group_size);
+        std::list<CmEmuMt_Thread> workItems;
+        for (uint32_t local_idx = 0; local_idx < m_group_size; ++local_idx)
+            workItems.emplace_back(local_idx, 0, workerIdx, nullptr, nullptr, m_kernel_launcher, this);
+
+        // Acquired by the first group that synchronizes, and reused by the
+        // next ones.
+        std::shared_ptr<CmEmuMt_GroupState> groupState;
+
+        GroupLoop loop {&workItems};
+        uint32_t group_idx;
+        while (!timedOut.load () && m_group_deques.pop(workerIdx, group_idx))
+        {
+            const auto runner = fibers.front ().get ();
+            for (auto& workItem: workItems) {
+                workItem.rebind(group_idx, nullptr, runner);
+                workItem.set_parallel_for(true);
+            }
+            loop.current = 0;
+            loop.stopped = false;
+            runner->reset(&run_group_loop, &loop);
+            runner->switch_to ();
+
+            if (!runner->finished ()) {
+                syncRequired.store(true);
+                if (!groupState)
+                    groupState = CmEmuMt_GroupStatePool::instance ().acquire(this);
+
+                // The runner stays with the suspended work-item, the ones
+                // after it start on fibers of their own.
+                loop.stopped = true;
+                std::swap(fibers.front (), fibers[loop.current]);
+                uint32_t local_idx = 0;
+                for (auto& workItem: workItems) {
+                    const auto fiber = fibers[local_idx].get ();
+                    workItem.rebind(group_idx, groupState, fiber);
+                    workItem.set_parallel_for(false);
+                    if (local_idx++ > loop.current)
+                        fiber->reset(&CmEmuMt_Thread::wrapper_fiber, &workItem);
+                }
+                if (!run_group_fibers(workItems, fibers, deadline)) {
+                    timedOut.store(true);
+                    break;
+                }
+            }
+
+            if (std::chrono::steady_clock::now () > deadline)
+                timedOut.store(true);
+        }
+
+        g_resident_thread = nullptr;
+        CmEmuMt_Fiber::thread_fini();
+    });
+
+    if (syncRequired.load ()) {
+        add_sync_kernel(kernelFunc);
+        GFX_EMU_MESSAGE(fSched, "kernel %s at %p uses group synchronization, "
+            "next launches go to the full scheduler.\n",
+            m_kernel_launcher.m_kernelName.c_str (), kernelFunc);
+    }
+
+    if (timedOut.load ()) {
+        GFX_EMU_ERROR_MESSAGE("*** Error: timeout while running a kernel!\n");
+        return false;
+    }
+
+    return true;
+}
+
 //-----------------------------------------------------------------------------
 bool CmEmuMt_Kernel::run_debug()
 {
@@ -439,14 +905,90 @@ bool CmEmuMt_Kernel::run_debug()
     GFX_EMU_MESSAGE(fSched, "NB: Use only for debugging purposes on simple kernels!\n");
     GFX_EMU_MESSAGE(fSched, "NB: Alternative modes for debugging kernels with synchronization are:\n");
     GFX_EMU_MESSAGE(fSched, "NB: 1) CM_RT_PARALLEL_THREADS=1\n");
+    GFX_EMU_MESSAGE(fSched, "NB: 2) CM_RT_SCHED_MODE=fibers CM_RT_PARALLEL_THREADS=1\n");
     GFX_EMU_MESSAGE(fSched, "NB: See README_CONFIG.md for details.\n");
     GFX_EMU_MESSAGE(fSched, "--==--==--==--==--==--==--==--==--==--==--==--==--==--==--==--\n");
     CmEmuMt_Thread { m_kernel_launcher, this };
     return true;
 }
 
+bool CmEmuMt_Kernel::run_fibers(double timeout)
+{
+    const auto workersCount = std::min(m_parallel_threads_limit, m_group_count);
+
+    static auto once = 0;
+    if(!once++) {
+        GFX_EMU_MESSAGE(fSched, "work-items scheduling mode: fibers.\n");
+        GfxEmu::Log::adviceToEnable(fSched, "for more info on scheduling.\n");
+    }
+    GFX_EMU_MESSAGE(fSched, "work-groups: %d\n", m_group_count);
+    GFX_EMU_MESSAGE(fSched, "fiber workers: %d\n", workersCount);
+    GFX_EMU_MESSAGE(fSched, "work-items per work-group: %d\n", m_group_size);
+
+    const auto deadline = std::chrono::steady_clock::now () +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>{timeout});
+    std::atomic<bool> timedOut {false};
+
+    // Every worker runs one work-group at a time: all of its work-items are
+    // fibers switched in round-robin order whenever one of them suspends
+    // (barrier, yield) or completes.
+    m_group_deques.reset(workersCount, m_group_count);
+
+    auto worker = [&] (uint32_t workerIdx) {
+        CmEmuMt_Fiber::thread_init();
+
+        auto& fibers = worker_fibers(m_group_size);
+        std::list<CmEmuMt_Thread> workItems;
+        for (uint32_t local_idx = 0; local_idx < m_group_size; ++local_idx)
+            workItems.emplace_back(local_idx, 0, workerIdx, nullptr, nullptr, m_kernel_launcher, this);
+
+        // A group's state is done with when all of its work-items are, so
+        // the worker reuses one for all the groups it runs.
+        const auto groupState = CmEmuMt_GroupStatePool::instance ().acquire(this);
+
+        uint32_t group_idx;
+        while (!timedOut.load () && m_group_deques.pop(workerIdx, group_idx))
+        {
+            {
+                auto fiberIt = fibers.begin ();
+                for (auto& workItem: workItems) {
+                    auto& fiber = *fiberIt++;
+                    workItem.rebind(group_idx, groupState, fiber.get ());
+                    fiber->reset(&CmEmuMt_Thread::wrapper_fiber, &workItem);
+                }
+            }
+
+            if (!run_group_fibers(workItems, fibers, deadline))
+                timedOut.store(true);
+        }
+
+        g_resident_thread = nullptr;
+        CmEmuMt_Fiber::thread_fini();
+    };
+
+    CmEmuMt_WorkerPool::instance ().parallel_for(workersCount, worker);
+
+    if (timedOut.load ()) {
+        GFX_EMU_ERROR_MESSAGE("*** Error: timeout while running a kernel!\n");
+        return false;
+    }
+
+    return true;
+}
+
 bool CmEmuMt_Kernel::run(double timeout)
 {
+    if (!timeout)
+        timeout = kCmEmuKnlTimeout;
+
+    const auto schedMode = GfxEmu::Cfg::SchedMode ().getInt ();
+
+    if (parallel_for_enabled ())
+        return run_parallel_for(timeout);
+
+    if (schedMode == GfxEmu::Sched::FIBERS || schedMode == GfxEmu::Sched::AUTO)
+        return run_fibers(timeout);
 
     //-----------------------------------------------------------------
     static auto once = 0;
@@ -460,18 +1002,23 @@ bool CmEmuMt_Kernel::run(double timeout)
 
     std::list<CmEmuMt_Thread> threadsList;
 
-    for (uint32_t group_idx = 0;
-        group_idx < m_resident_groups_limit;
-        ++group_idx)
+    m_group_deques.reset(m_resident_groups_limit, m_group_count);
+    m_slots.reset(new ResidentSlot[m_resident_groups_limit]);
+
+    for (uint32_t slot_idx = 0;
+        slot_idx < m_resident_groups_limit;
+        ++slot_idx)
     {
-        auto groupState1Ptr = std::make_shared<CmEmuMt_GroupState>(this);
-        auto groupState2Ptr = std::make_shared<CmEmuMt_GroupState>(this);
+        auto groupState1Ptr = CmEmuMt_GroupStatePool::instance ().acquire(this);
+        auto groupState2Ptr = CmEmuMt_GroupStatePool::instance ().acquire(this);
+        const auto group_idx = slot_group(slot_idx, 0);
 
         for (uint32_t local_idx = 0; local_idx < m_group_size; ++local_idx) {
             //m_running_threads_count++;
             threadsList.emplace_back(
                     local_idx,
                     group_idx,
+                    slot_idx,
                     groupState1Ptr,
                     groupState2Ptr,
                     m_kernel_launcher,
@@ -479,42 +1026,21 @@ bool CmEmuMt_Kernel::run(double timeout)
         }
     }
 
-    if (!timeout)
-        timeout = kCmEmuKnlTimeout;
+    const auto deadline = std::chrono::steady_clock::now () +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>{timeout});
 
-    const auto startTime = std::chrono::system_clock::now();
-    auto isTimeout = [startTime,timeout] {
-        static int chkTimeoutI = 0;
-        if(!(chkTimeoutI++ % 100) &&
-            std::chrono::duration<double> {std::chrono::system_clock::now() - startTime}.count () > timeout)
-        {
-            GFX_EMU_ERROR_MESSAGE("*** Error: timeout while running a kernel!\n");
-            return true;
-        }
-        return false;
-    };
+    std::unique_lock<std::mutex> lk(m_sched_mutex);
+    for (auto& thread: threadsList)
+        m_ready_threads.push_back(&thread);
+    dispatch_threads ();
 
-    auto curThreadIt = threadsList.begin();
-    while (threadsList.size ())
+    // Sleep until all the work-items are complete, or the deadline passes.
+    if (!m_sched_condition.wait_until(lk, deadline, [&] {
+            return m_completed_threads_count == threadsList.size (); }))
     {
-        if (isTimeout ()) return false;
-
-        if (curThreadIt->suspended() || curThreadIt->unspawned()) {
-            if(m_running_threads_count.load() < m_parallel_threads_limit)
-                curThreadIt->resume ();
-        }
-
-        if(m_parallel_threads_limit > 1 ||
-           m_running_threads_count.load() == 0 // Guarantee sequentiality of threads spawning in parallelism = 1 mode.
-        )
-        {
-            curThreadIt = curThreadIt->completed () ?
-                threadsList.erase(curThreadIt) :
-                std::next(curThreadIt);
-        }
-
-        if (curThreadIt == threadsList.end())
-            curThreadIt = threadsList.begin();
+        GFX_EMU_ERROR_MESSAGE("*** Error: timeout while running a kernel!\n");
+        return false;
     }
 
     return true;
@@ -525,25 +1051,126 @@ CmEmuMt_GroupBarrier::CmEmuMt_GroupBarrier(CmEmuMt_Kernel *kernel) : m_kernel(ke
     m_local_sense.resize(m_kernel->group_size(), 0);
 }
 
+void CmEmuMt_GroupBarrier::reset(CmEmuMt_Kernel *kernel) {
+    m_kernel = kernel;
+    m_counter.store(0);
+    m_global_sense.store(0);
+    m_local_sense.assign(m_kernel->group_size(), 0);
+}
+
 //-----------------------------------------------------------------------------
 void CmEmuMt_GroupBarrier::signal(CmEmuMt_Thread *thread) {
     // we use split-version of sensing barrier
     m_local_sense[thread->local_idx()] = ~m_local_sense[thread->local_idx()];
 
-    while (m_counter.load() > m_kernel->group_size() - 1)
-        ;
+    // The last arrival of the previous phase may not have reset the counter yet.
+    const auto full = m_kernel->group_size();
+    if (!spin_until([&] { return m_counter.load() < full; })) {
+        uint32_t v;
+        while ((v = m_counter.load()) >= full)
+            futex_wait(m_counter, v);
+    }
 
-    if (m_counter.fetch_add(1) == m_kernel->group_size() - 1) {
+    if (m_counter.fetch_add(1) == full - 1) {
         m_counter.store(0);
+        futex_wake_all(m_counter);
         m_global_sense.store(m_local_sense[thread->local_idx()]);
+        m_wait_list.notify_all();
     }
 }
 
 //-----------------------------------------------------------------------------
 void CmEmuMt_GroupBarrier::wait(CmEmuMt_Thread *thread) {
-    do {
-        thread->suspend();
-    } while (m_global_sense.load() != m_local_sense[thread->local_idx()]);
+    const auto localSense = m_local_sense[thread->local_idx()];
+    m_wait_list.wait(thread, [&] { return m_global_sense.load() == localSense; });
+}
+
+//=============================================================================
+CmEmuMt_GroupState::CmEmuMt_GroupState(CmEmuMt_Kernel *kernel)
+{
+    simple_barrier = std::make_unique<CmEmuMt_GroupBarrier>(kernel);
+    aux_barrier = std::make_unique<CmEmuMt_GroupBarrier>(kernel);
+}
+
+CmEmuMt_GroupState::~CmEmuMt_GroupState()
+{
+    for (auto& b: m_named_barriers)
+        delete b.load();
+    delete m_xthread_broadcast.load();
+}
+
+void CmEmuMt_GroupState::reset(CmEmuMt_Kernel *kernel)
+{
+    slm.reset();
+    simple_barrier->reset(kernel);
+    aux_barrier->reset(kernel);
+    max_avail_barrier_id = 0;
+    for (auto& b: m_named_barriers)
+        if (auto barrier = b.load()) barrier->reset();
+}
+
+CmEmuMt_NamedBarrier* CmEmuMt_GroupState::materialize_named_barrier(uint id)
+{
+    std::lock_guard<std::mutex> lk(m_materialize_mutex);
+    auto barrier = m_named_barriers[id].load();
+    if (!barrier) {
+        barrier = new CmEmuMt_NamedBarrier;
+        barrier->set_id(id);
+        m_named_barriers[id].store(barrier, std::memory_order_release);
+    }
+    return barrier;
+}
+
+XThreadBroadcastBuf& CmEmuMt_GroupState::materialize_xthread_broadcast()
+{
+    std::lock_guard<std::mutex> lk(m_materialize_mutex);
+    auto buf = m_xthread_broadcast.load();
+    if (!buf) {
+        buf = new XThreadBroadcastBuf;
+        m_xthread_broadcast.store(buf, std::memory_order_release);
+    }
+    return *buf;
+}
+
+//-----------------------------------------------------------------------------
+// Never destroyed, as the work-group states of a kernel timed out may still
+// be referenced.
+CmEmuMt_GroupStatePool& CmEmuMt_GroupStatePool::instance() {
+    static auto& pool = *(new CmEmuMt_GroupStatePool);
+    return pool;
+}
+
+std::shared_ptr<CmEmuMt_GroupState> CmEmuMt_GroupStatePool::acquire(CmEmuMt_Kernel *kernel) {
+    std::unique_ptr<CmEmuMt_GroupState> state;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        if (!m_free.empty ()) {
+            state = std::move(m_free.back ());
+            m_free.pop_back ();
+        }
+    }
+
+    if (state)
+        state->reset(kernel);
+    else
+        state = std::make_unique<CmEmuMt_GroupState>(kernel);
+
+    return std::shared_ptr<CmEmuMt_GroupState>(state.release (),
+        [this] (CmEmuMt_GroupState *released) {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            m_free.emplace_back(released);
+        });
+}
+
+//=============================================================================
+void CmEmuMt_WaitList::notify_all() {
+    std::vector<CmEmuMt_Thread*> waiters;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        waiters.swap(m_waiters);
+    }
+    for (auto thread: waiters)
+        thread->kernel()->unpark_thread(thread);
 }
 
 //=============================================================================
@@ -567,6 +1194,16 @@ CmEmuMt_NamedBarrier::CmEmuMt_NamedBarrier() {
     }
 }
 
+void CmEmuMt_NamedBarrier::reset() {
+    m_cfg_prod_count = m_cfg_cons_count = 0;
+    m_is_configured.store(false);
+    m_signaled_prod_count.store(0);
+    m_signaled_cons_count.store(0);
+    m_pending_cons_count.store(0);
+    m_cons_tracking.fill(false);
+    m_prod_tracking.fill(false);
+}
+
 CmEmuMt_NamedBarrier::~CmEmuMt_NamedBarrier() {
     //ASSERT_NBARRIER(!m_is_configured.load (std::memory_order_acquire), "destroyed while still being configured.");
 }
@@ -627,6 +1264,8 @@ void CmEmuMt_NamedBarrier::signal(
 
         ASSERT_NBARRIER(m_signaled_prod_count <= m_cfg_prod_count,
             "Too much producers! Expected per current config " << m_cfg_prod_count);
+
+        m_wait_list.notify_all(); // Last consumer may be waiting for producers.
     }
 
     DBG_NBARRIER("Signal"
@@ -647,18 +1286,19 @@ void CmEmuMt_NamedBarrier::wait(const int tid)
     const auto curCfgCookie = m_cfg_cookie.load (); // 1. Presave current config identifier.
     const auto chosen = m_pending_cons_count.fetch_sub(1) == 1; // 2. Register consumer wait.
 
-    while (m_cfg_cookie.load () == curCfgCookie)
+    if (chosen)
     {
-        if (chosen && is_ready ())
-        {
-            m_reconfLock.test_and_set ();
-            DBG_NBARRIER("deconfiguring.");
-            m_is_configured.store (false); // is_ready() -> false.
-            m_cfg_cookie.fetch_add (1); // break this loop for all the threads.
-            m_reconfLock.clear ();
-        }
-        else cmrt::this_thread_yield ();
+        m_wait_list.wait(g_resident_thread, [this] { return is_ready (); });
+
+        m_reconfLock.test_and_set ();
+        DBG_NBARRIER("deconfiguring.");
+        m_is_configured.store (false); // is_ready() -> false.
+        m_cfg_cookie.fetch_add (1); // release all the waiting threads.
+        m_reconfLock.clear ();
+        m_wait_list.notify_all ();
     }
+    else
+        m_wait_list.wait(g_resident_thread, [&] { return m_cfg_cookie.load () != curCfgCookie; });
 
     DBG_NBARRIER("finished waiting. My cfg_cookie was: " << curCfgCookie);
 }
@@ -801,6 +1441,11 @@ CmEmuMt_Thread * get_thread ()
     return g_resident_thread;
 }
 
+const CmEmu_MediaWorkItem* get_media_work_item ()
+{
+    return g_resident_thread ? g_resident_thread->media_work_item() : nullptr;
+}
+
 char *get_slm(){
     return g_resident_thread->slm();
 }
@@ -828,6 +1473,31 @@ void this_thread_yield(){
 
 //=============================================================================
 
+// SLM regions come from the OS page allocator: they are page-aligned, zeroed
+// and only get committed as pages are touched.
+static char* alloc_slm_region(size_t size)
+{
+#if defined(_WIN32)
+    const auto region = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (!region)
+#else
+    auto region = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED)
+#endif
+        GFX_EMU_FAIL_WITH_MESSAGE("unable to allocate SLM region of %zu bytes.\n", size);
+    return static_cast<char*>(region);
+}
+
+static void release_slm_region(char* region, size_t size)
+{
+    if (!region) return;
+#if defined(_WIN32)
+    VirtualFree(region, 0, MEM_RELEASE);
+#else
+    munmap(region, size);
+#endif
+}
+
 void CmEmuMt_SLM::set_size (unsigned int size)
 {
     std::lock_guard<std::mutex> lk(m_mutex);
@@ -847,16 +1517,34 @@ void CmEmuMt_SLM::set_size (unsigned int size)
         GFX_EMU_FAIL_WITH_MESSAGE("Error in SLM Emulation:  Max SLM size = %dK!\n", slm_max_size/1024);
     }
 
-    if (m_memory.empty()) {
-        m_memory.resize(size);
+    if (!m_size) {
+        if (m_capacity < size) {
+            release_slm_region(m_memory, m_capacity);
+            m_capacity = slm_max_size;
+            m_memory = alloc_slm_region(m_capacity);
+        } else if (m_dirty)
+            std::memset(m_memory, 0, size);
+        m_dirty = false;
     } else {
-        if (m_memory.size() != size) {
+        if (m_size != size) {
             GFX_EMU_FAIL_WITH_MESSAGE("Requesting SLM size of %u while SLM size already set to %u\n",
-                size, m_memory.size());
+                size, m_size);
         }
     }
 
     m_size = size;
 }
 
+void CmEmuMt_SLM::reset ()
+{
+    m_dirty = m_dirty || m_size;
+    m_buffer_offset = m_basic_offset = 0;
+    m_size = 0;
+}
+
+CmEmuMt_SLM::~CmEmuMt_SLM ()
+{
+    release_slm_region(m_memory, m_capacity);
+}
+
 } // namespace cmrt
@@ -23,6 +23,7 @@ SPDX-License-Identifier: MIT
 #include <condition_variable>
 
 #include <list>
+#include <deque>
 #include <array>
 #include <vector>
 #include <iostream>
@@ -31,25 +32,57 @@ SPDX-License-Identifier: MIT
 #include "cm_vm.h"
 #include "emu_kernel_arg.h"
 #include "emu_kernel_support.h"
+#include "rt_futex.h"
+#include "cm_kernel_invoker.h"
 
 namespace cmrt
 {
 
+struct CmEmu_LaunchPlan;
+
+// Media object of a pre-XeHP thread space, run as a work-group of its own:
+// the thread id selects its argument values, thread origin and color are
+// returned by get_thread_origin_x/y and get_color while it runs.
+struct CmEmu_MediaWorkItem
+{
+    uint32_t threadId;
+    uint16_t originX, originY;
+    uint16_t color;
+};
+
 class CmEmu_KernelLauncher
 {
 public:
     friend class CmEmuMt_Thread;
+    friend class CmEmuMt_Kernel;
     using VoidFuncPtr = void(*)();
     static constexpr size_t kThreadIdUnset = -1;
 
 private:
+    // Immutable per-launch view of an argument buffer: a work-item's value
+    // is at base + stride * thread linear id, stride is 0 for shared values.
+    struct ArgSlot {
+        uint8_t* base;
+        size_t   stride;
+        size_t   count;
+    };
 
     const GfxEmu::KernelSupport::ProgramModule& m_programModule;
     VoidFuncPtr m_kernel_func_ptr = nullptr;
     std::string m_kernelName;
     std::vector<GfxEmu::KernelArg> m_args;
+    std::shared_ptr<CmEmu_LaunchPlan> m_plan;
+    CmEmuKernelInvoker m_invoker {nullptr}; // Registered typed invoker, preferred over libffi.
+    std::vector<ArgSlot> m_arg_slots;
+
+    size_t m_thread_linear_id; // Fixed by the caller, or kThreadIdUnset.
+    std::shared_ptr<const std::vector<CmEmu_MediaWorkItem>> m_media_work_items; // Indexed by work-group.
 
-    size_t m_thread_linear_id;
+    static std::shared_ptr<CmEmu_LaunchPlan> get_launch_plan(
+        const std::vector<GfxEmu::KernelArg>&);
+    static CmEmuKernelInvoker find_kernel_invoker(
+        VoidFuncPtr,
+        const std::vector<GfxEmu::KernelArg>&);
 
 public:
     CM_API CmEmu_KernelLauncher(
@@ -66,8 +99,13 @@ public:
 
     CM_API ~CmEmu_KernelLauncher();
 
+    // Makes work-group i run the media object items[i].
+    CM_API void set_media_work_items(std::vector<CmEmu_MediaWorkItem> items);
+
 protected:
-    CM_API void launch();
+    // Calls the kernel with the arguments of the given work-item. Does not
+    // modify the launcher, so one launcher serves all work-items of a launch.
+    CM_API void launch(size_t threadLinearId) const;
 };
 
 using CmEmuThreadBroadcastEl = uint32_t;
@@ -100,18 +138,42 @@ using XThreadBroadcastBuf = vector<CmEmuThreadBroadcastEl, kCmEmuXThreadBroadcas
 
 extern thread_local class CmEmuMt_Thread* g_resident_thread; // For helper funcs.
 
+class CmEmuMt_Fiber;
+
+// Binary semaphore a parked work-item sleeps on. A ring is remembered until
+// consumed, so ringing ahead of waiting is fine.
 class CmEmuMt_ThreadBell
 {
 private:
-    std::mutex              m_mutex;
-    std::condition_variable m_condition;
-    bool                    m_ringing{false};
+    enum : uint32_t { kIdle = 0, kRinging = 1, kSleeping = 2 };
+    std::atomic<uint32_t> m_state {kIdle};
+
+    bool try_take() {
+        uint32_t v = kRinging;
+        return m_state.compare_exchange_strong(v, kIdle);
+    }
 
 public:
     void wait_for_ring(); // Will suspend thread while waiting.
     void ring();
 };
 
+// Work-items waiting for a synchronization object state change. In threads
+// mode waiters are parked until notified, releasing their running slot; in
+// fibers mode they just yield to the other fibers of the work-group.
+class CmEmuMt_WaitList
+{
+private:
+    std::mutex                   m_mutex;
+    std::vector<CmEmuMt_Thread*> m_waiters;
+
+public:
+    // Returns once isDone() holds. The state isDone() depends on must be
+    // updated before notify_all() is called.
+    template<class Pred> void wait(CmEmuMt_Thread *thread, Pred isDone);
+    void notify_all();
+};
+
 class CmEmuMt_Kernel;
 class CmEmuMt_NamedBarrier
 {
@@ -138,6 +200,8 @@ private:
     std::array<bool, kMaxWorkItemsPerWorkGroup> m_cons_tracking {};
     std::array<bool, kMaxWorkItemsPerWorkGroup> m_prod_tracking {};
 
+    CmEmuMt_WaitList m_wait_list;
+
     bool is_ready() const;
 
 public:
@@ -145,6 +209,7 @@ public:
     ~CmEmuMt_NamedBarrier ();
 
     void set_id (int id) {m_id = id;}
+    void reset ();
 
     void signal(
         const int tid,
@@ -163,9 +228,11 @@ private:
     std::atomic<uint32_t> m_counter{0};
     std::atomic<uint32_t> m_global_sense{0};
     std::vector<uint32_t> m_local_sense;
+    CmEmuMt_WaitList      m_wait_list;
 
 public:
     CmEmuMt_GroupBarrier(CmEmuMt_Kernel *kernel);
+    void         reset(CmEmuMt_Kernel *kernel);
     void         signal(CmEmuMt_Thread *thread);
     void         wait(CmEmuMt_Thread *thread);
     CmEmuMt_Kernel* kernel() const { return m_kernel; }
@@ -178,19 +245,29 @@ struct CmEmuMt_SLM
         kDefaultMaxSize = 64ll << 10,
         kPvcMaxSize = 128ll << 10
     ;
-    std::vector<char> m_memory;
+    // Page-aligned region of the platform max SLM size, allocated on the
+    // first set_size() and kept when the owning group state is recycled.
+    char*             m_memory {nullptr};
+    size_t            m_capacity {0};
+    bool              m_dirty {false}; // Holds data of the previous launch.
     std::mutex        m_mutex;
 
     unsigned int m_buffer_offset = 0;
     unsigned int m_basic_offset  = 0;
     size_t       m_size          = 0;
 
+    CmEmuMt_SLM() = default;
+    CmEmuMt_SLM(const CmEmuMt_SLM&) = delete;
+    CmEmuMt_SLM& operator=(const CmEmuMt_SLM&) = delete;
+    ~CmEmuMt_SLM();
+
     char *data()
     {
-        return m_memory.data();
+        return m_memory;
     }
 
     void set_size(unsigned int size);
+    void reset();
 
     size_t get_size() {return m_size;}
 
@@ -198,15 +275,15 @@ struct CmEmuMt_SLM
     {
         std::lock_guard<std::mutex> lk(m_mutex);
 
-        if (m_memory.empty())
+        if (!m_size)
         {
             throw std::runtime_error("SLM not initialized");
         }
 
-        if (bufferSize > m_memory.size())
+        if (bufferSize > m_size)
         {
             throw std::runtime_error("SLM allocate size larger than initial size " +
-                std::to_string(m_memory.size()));
+                std::to_string(m_size));
         }
 
         // Note: don't support multiple allocation
@@ -228,19 +305,20 @@ struct CmEmuMt_SLM
     }
 };
 
+// Shared state of the work-items of a resident work-group. Named barriers
+// and the cross-thread broadcast buffer are sizeable and used by few kernels,
+// so they are only materialized on first use.
 struct CmEmuMt_GroupState
 {
     CmEmuMt_SLM slm;
     std::unique_ptr<CmEmuMt_GroupBarrier> simple_barrier, aux_barrier;
-    std::array<CmEmuMt_NamedBarrier, kMaxNamedBarriersCount> named_barriers;
-    XThreadBroadcastBuf xthread_broadcast;
 	uint max_avail_barrier_id {0};
 
     void set_max_avail_barrier_id(uint maxId) {
-        if(maxId >= named_barriers.size())
+        if(maxId >= kMaxNamedBarriersCount)
         {
             std::cerr << "*** Error: max initialized barrier id can not be more than " <<
-                (named_barriers.size () - 1) << std::endl;
+                (kMaxNamedBarriersCount - 1) << std::endl;
             exit(EXIT_FAILURE);
         }
 
@@ -249,12 +327,78 @@ struct CmEmuMt_GroupState
 
     uint get_max_avail_barrier_id() const { return max_avail_barrier_id; }
 
-    CmEmuMt_GroupState(CmEmuMt_Kernel *kernel)
-    {
-        simple_barrier = std::make_unique<CmEmuMt_GroupBarrier>(kernel);
-        aux_barrier = std::make_unique<CmEmuMt_GroupBarrier>(kernel);
-        {int i = 0; for (auto& b: named_barriers) b.set_id (i++);}
+    CmEmuMt_NamedBarrier* named_barrier(uint id) {
+        if (auto b = m_named_barriers[id].load(std::memory_order_acquire))
+            return b;
+        return materialize_named_barrier(id);
     }
+
+    XThreadBroadcastBuf& xthread_broadcast() {
+        if (auto buf = m_xthread_broadcast.load(std::memory_order_acquire))
+            return *buf;
+        return materialize_xthread_broadcast();
+    }
+
+    CmEmuMt_GroupState(CmEmuMt_Kernel *kernel);
+    ~CmEmuMt_GroupState();
+
+    // Prepares a recycled state to serve a work-group of the given kernel.
+    void reset(CmEmuMt_Kernel *kernel);
+
+private:
+    std::mutex m_materialize_mutex;
+    std::array<std::atomic<CmEmuMt_NamedBarrier*>, kMaxNamedBarriersCount> m_named_barriers {};
+    std::atomic<XThreadBroadcastBuf*> m_xthread_broadcast {nullptr};
+
+    CmEmuMt_NamedBarrier* materialize_named_barrier(uint id);
+    XThreadBroadcastBuf& materialize_xthread_broadcast();
+};
+
+// Process-wide free list of work-group states. States are recycled across
+// launches, so resident groups do not allocate and fault in barriers and SLM
+// on every launch. The pool holds as many states as were resident at peak
+// and never shrinks.
+class CmEmuMt_GroupStatePool
+{
+private:
+    std::mutex                                       m_mutex;
+    std::vector<std::unique_ptr<CmEmuMt_GroupState>> m_free;
+
+    CmEmuMt_GroupStatePool() = default;
+
+public:
+    static CmEmuMt_GroupStatePool& instance();
+
+    // The state returns to the pool when the last reference is dropped.
+    std::shared_ptr<CmEmuMt_GroupState> acquire(CmEmuMt_Kernel *kernel);
+};
+
+// Work-stealing distribution of work-group indices between workers. Every
+// worker owns a deque holding a contiguous range of groups and takes groups
+// from its front; a worker that runs dry steals the back half of the longest
+// range of another worker. Ranges are packed into a single atomic word each,
+// so neither taking nor stealing needs a lock.
+class CmEmuMt_GroupDeques
+{
+private:
+    struct alignas(64) Range
+    {
+        std::atomic<uint64_t> packed {0}; // begin in low, end in high 32 bits.
+    };
+
+    static uint64_t pack(uint32_t begin, uint32_t end) { return (uint64_t)end << 32 | begin; }
+    static uint32_t begin(uint64_t r) { return (uint32_t)r; }
+    static uint32_t end(uint64_t r) { return (uint32_t)(r >> 32); }
+
+    std::unique_ptr<Range[]> m_ranges;
+    uint32_t                 m_count {0};
+
+    bool take_own(uint32_t worker, uint32_t& group_idx);
+    bool steal(uint32_t worker, uint32_t& group_idx);
+
+public:
+    void reset(uint32_t workersCount, uint32_t groupsCount);
+    bool pop(uint32_t worker, uint32_t& group_idx);
 };
 
 class CmEmuMt_Thread
@@ -270,31 +414,48 @@ public:
 
 private:
     uint32_t m_local_idx, m_group_idx; // local thread index, and group_dims index
+    uint32_t m_slot_idx {0}, m_round {0}; // resident group slot, and groups run by it so far
     // we need extra resources to avoid races when we start executing the next
     // thread group_dims in the same thread. so we ping-pong between the two
     std::shared_ptr<CmEmuMt_GroupState> m_resources, m_extra_resources;
-    CmEmu_KernelLauncher   m_kernel_launcher;
+    const CmEmu_KernelLauncher* m_kernel_launcher; // Owned by the kernel, shared by all work-items.
+    size_t                 m_thread_linear_id {CmEmu_KernelLauncher::kThreadIdUnset};
+    const CmEmu_MediaWorkItem* m_media_work_item {nullptr}; // Set while running a media object.
     CmEmuMt_Kernel*        m_kernel;
     CmEmuMt_ThreadBell     m_bell;
-    std::unique_ptr<std::thread>  m_os_thread_ptr;
+    CmEmuMt_Fiber*         m_fiber {nullptr}; // Set in fibers scheduling mode only.
+    bool                   m_parallel_for {false}; // No group state bound until one is needed.
     std::atomic<State>     m_state {State::Running};
 
+    static void wait_for_group_state();
+    CmEmuMt_GroupState* group_state() const {
+        if (m_parallel_for) wait_for_group_state();
+        return m_resources.get();
+    }
+
 public:
     CmEmuMt_Thread(
-        CmEmu_KernelLauncher launcher,
+        const CmEmu_KernelLauncher& launcher,
         CmEmuMt_Kernel* kernel);
     CmEmuMt_Thread(
         uint32_t local_idx,
         uint32_t group_idx,
+        uint32_t slot_idx,
         std::shared_ptr<CmEmuMt_GroupState> resources,
         std::shared_ptr<CmEmuMt_GroupState> extra_resources,
-        CmEmu_KernelLauncher launcher,
+        const CmEmu_KernelLauncher& launcher,
         CmEmuMt_Kernel* kernel);
     ~CmEmuMt_Thread();
 
     void        wrapper();
     void        wrapper_debug();
+    static void wrapper_fiber(void*);
+    void        rebind(
+        uint32_t group_idx,
+        std::shared_ptr<CmEmuMt_GroupState> resources,
+        CmEmuMt_Fiber* fiber);
     void        suspend();
+    void        park();
     void        resume();
     void        complete();
 
@@ -309,24 +470,29 @@ public:
     bool                next_group();
     void                execute();
 
+    void                set_parallel_for(bool v) { m_parallel_for = v; }
+    bool                is_fiber() const { return m_fiber != nullptr; }
+    const CmEmu_MediaWorkItem* media_work_item() const { return m_media_work_item; }
+
     CmEmuMt_Kernel* kernel() const { return m_kernel; }
-    CmEmuMt_NamedBarrier* named_barrier(uint id) { return &m_resources->named_barriers[id]; }
-    CmEmuMt_GroupBarrier* simple_barrier() const { return m_resources->simple_barrier.get(); }
-    CmEmuMt_GroupBarrier* aux_barrier() const { return m_resources->aux_barrier.get(); }
-    std::shared_ptr<CmEmuMt_GroupState> resources() const { return m_resources; }
+    CmEmuMt_NamedBarrier* named_barrier(uint id) { return group_state()->named_barrier(id); }
+    CmEmuMt_GroupBarrier* simple_barrier() const { return group_state()->simple_barrier.get(); }
+    CmEmuMt_GroupBarrier* aux_barrier() const { return group_state()->aux_barrier.get(); }
+    std::shared_ptr<CmEmuMt_GroupState> resources() const { group_state(); return m_resources; }
 
-    char *                slm() const { return m_resources->slm.data(); }
-    void                  set_slm_size(unsigned int size) { m_resources->slm.set_size(size); }
-    size_t                get_slm_size() { return m_resources->slm.get_size();}
-    unsigned int          alloc_slm(unsigned int bufferSize) { return m_resources->slm.alloc(bufferSize); }
+    char *                slm() const { return group_state()->slm.data(); }
+    void                  set_slm_size(unsigned int size) { group_state()->slm.set_size(size); }
+    size_t                get_slm_size() { return group_state()->slm.get_size();}
+    unsigned int          alloc_slm(unsigned int bufferSize) { return group_state()->slm.alloc(bufferSize); }
 
-    XThreadBroadcastBuf& get_xthread_broadcast() { return m_resources->xthread_broadcast; }
+    XThreadBroadcastBuf& get_xthread_broadcast() { return group_state()->xthread_broadcast(); }
 };
 
 class CmEmuMt_Kernel
 {
 public:
     static thread_local void* m_sched_ctx;
+    static constexpr uint32_t kNoGroup = -1;
 private:
     CmEmu_KernelLauncher m_kernel_launcher;
 
@@ -342,8 +508,30 @@ private:
                           m_group_size{0},
                           m_parallel_threads_limit{0};
 
-    // keep track of currently running number of threads, must be < m_parallel_threads_limit
-    std::atomic<uint32_t> m_running_threads_count{0};
+    // threads mode scheduling state: work-items ready to run in run order,
+    // how many are running (must be <= m_parallel_threads_limit) and how
+    // many are complete. Guarded by m_sched_mutex.
+    std::mutex                  m_sched_mutex;
+    std::condition_variable     m_sched_condition; // Notified on work-item completion.
+    std::deque<CmEmuMt_Thread*> m_ready_threads;
+    uint32_t                    m_running_threads_count {0};
+    uint32_t                    m_completed_threads_count {0};
+
+    void dispatch_threads(); // Must be called with m_sched_mutex held.
+
+    // work-groups pending per worker (fibers mode) or resident slot (threads
+    // mode). All the work-items of a slot must agree on the groups it runs,
+    // so the first of them to move on takes the group for the whole slot.
+    CmEmuMt_GroupDeques   m_group_deques;
+    struct ResidentSlot
+    {
+        std::mutex            mutex;
+        std::vector<uint32_t> groups;
+    };
+    std::unique_ptr<ResidentSlot[]> m_slots;
+
+    bool parallel_for_enabled();
+    bool run_parallel_for(double timeout);
 
 public:
     CM_API CmEmuMt_Kernel(
@@ -356,12 +544,15 @@ public:
     CM_API ~CmEmuMt_Kernel();
     CM_API bool run(double timeout = 0);
     CM_API bool run_debug();
+    bool     run_fibers(double timeout);
     void     suspend_thread(CmEmuMt_Thread *);
-    void     resume_thread(CmEmuMt_Thread *);
+    void     park_thread(CmEmuMt_Thread *);
+    void     unpark_thread(CmEmuMt_Thread *);
     void     complete_thread(CmEmuMt_Thread *);
     uint32_t group_size() const { return m_group_size; }
     uint32_t group_count() const { return m_group_count; }
     uint32_t resident_groups_limit() const { return m_resident_groups_limit; }
+    uint32_t slot_group(uint32_t slot, uint32_t round);
 
     uint32_t thread_idx(uint32_t idx, uint32_t dim);
     uint32_t group_idx(uint32_t idx, uint32_t dim);
@@ -370,6 +561,24 @@ public:
     uint32_t group_count(uint32_t idx);
 };
 
+template<class Pred>
+void CmEmuMt_WaitList::wait(CmEmuMt_Thread *thread, Pred isDone)
+{
+    while (!isDone ()) {
+        if (thread->is_fiber ()) {
+            thread->suspend ();
+            continue;
+        }
+        if (spin_until(isDone)) return;
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            if (isDone ()) return;
+            m_waiters.push_back(thread);
+        }
+        thread->park ();
+    }
+}
+
 inline uint platform_get_max_barriers_count()
 {
     return kMaxNamedBarriersCount;
@@ -406,6 +615,7 @@ void    aux_barrier_signal();
 void    aux_barrier_wait();
 
 CmEmuMt_Thread * get_thread ();
+const CmEmu_MediaWorkItem* get_media_work_item (); // nullptr unless running a media object.
 
 char *       get_slm();
 void         set_slm_size(unsigned int size);
@@ -0,0 +1,178 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2021 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include <cstring>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "cm_vm.h"
+#include "rt_fiber.h"
+#include "emu_log.h"
+
+using namespace GfxEmu::Log::Flags;
+
+namespace cmrt
+{
+
+namespace {
+thread_local CmEmuMt_Fiber* t_current_fiber = nullptr;
+#if defined(_WIN32)
+thread_local void* t_worker_fiber = nullptr;
+thread_local bool t_worker_converted = false;
+#else
+thread_local ucontext_t t_worker_ctx;
+#endif
+}
+
+//=============================================================================
+void CmEmuMt_Fiber::save_simd_state() {
+    m_simd_working_stack = __CMInternal__::getWorkingStack();
+    m_simd_break_stack = __CMInternal__::getBreakStack();
+    m_simd_marker = __CMInternal__::getSIMDMarker();
+}
+
+void CmEmuMt_Fiber::restore_simd_state() {
+    __CMInternal__::setWorkingStack(static_cast<__CMInternal__::Stack*>(m_simd_working_stack));
+    __CMInternal__::setBreakStack(static_cast<__CMInternal__::Stack*>(m_simd_break_stack));
+    __CMInternal__::setSIMDMarker(m_simd_marker);
+}
+
+//-----------------------------------------------------------------------------
+// Fiber body never returns: once the entry function is done the fiber parks
+// itself and gets reused by the next reset()/switch_to() pair.
+void CmEmuMt_Fiber::entry_loop(CmEmuMt_Fiber* fiber) {
+    for (;;) {
+        fiber->m_entry(fiber->m_arg);
+        fiber->m_finished = true;
+        yield();
+    }
+}
+
+void CmEmuMt_Fiber::reset(EntryFunc entry, void* arg) {
+    GFX_EMU_ASSERT(m_finished);
+    m_entry = entry;
+    m_arg = arg;
+    m_finished = false;
+}
+
+CmEmuMt_Fiber* CmEmuMt_Fiber::current() {
+    return t_current_fiber;
+}
+
+void CmEmuMt_Fiber::switch_to() {
+    const auto workerWorkingStack = __CMInternal__::getWorkingStack();
+    const auto workerBreakStack = __CMInternal__::getBreakStack();
+    const auto workerMarker = __CMInternal__::getSIMDMarker();
+
+    t_current_fiber = this;
+    restore_simd_state();
+#if defined(_WIN32)
+    SwitchToFiber(m_handle);
+#else
+    swapcontext(&t_worker_ctx, &m_ctx);
+#endif
+    save_simd_state();
+    t_current_fiber = nullptr;
+
+    __CMInternal__::setWorkingStack(workerWorkingStack);
+    __CMInternal__::setBreakStack(workerBreakStack);
+    __CMInternal__::setSIMDMarker(workerMarker);
+}
+
+void CmEmuMt_Fiber::yield() {
+    auto fiber = t_current_fiber;
+    if (!fiber) {
+        GFX_EMU_FAIL_WITH_MESSAGE(fSched, "fiber yield called outside of a fiber.\n");
+    }
+#if defined(_WIN32)
+    SwitchToFiber(t_worker_fiber);
+#else
+    swapcontext(&fiber->m_ctx, &t_worker_ctx);
+#endif
+}
+
+//=============================================================================
+#if defined(_WIN32)
+
+static void WINAPI fiber_proc(void* p) {
+    CmEmuMt_Fiber::entry_loop(static_cast<CmEmuMt_Fiber*>(p));
+}
+
+CmEmuMt_Fiber::CmEmuMt_Fiber(size_t stackSize) {
+    m_handle = CreateFiberEx(0, stackSize, FIBER_FLAG_FLOAT_SWITCH, fiber_proc, this);
+    if (!m_handle) {
+        GFX_EMU_FAIL_WITH_MESSAGE(fSched, "unable to create a fiber with stack of %zu bytes: %s\n",
+            stackSize, GfxEmu::Utils::lastErrorStr().c_str());
+    }
+}
+
+CmEmuMt_Fiber::~CmEmuMt_Fiber() {
+    if (m_handle) DeleteFiber(m_handle);
+}
+
+// Worker may be a thread that is already a fiber (e.g. the calling
+// application thread), only threads converted here are converted back.
+void CmEmuMt_Fiber::thread_init() {
+    if (IsThreadAFiber()) {
+        t_worker_fiber = GetCurrentFiber();
+        return;
+    }
+    t_worker_fiber = ConvertThreadToFiberEx(nullptr, FIBER_FLAG_FLOAT_SWITCH);
+    t_worker_converted = t_worker_fiber != nullptr;
+    if (!t_worker_fiber) {
+        GFX_EMU_FAIL_WITH_MESSAGE(fSched, "unable to convert worker thread to a fiber: %s\n",
+            GfxEmu::Utils::lastErrorStr().c_str());
+    }
+}
+
+void CmEmuMt_Fiber::thread_fini() {
+    if (t_worker_converted) ConvertFiberToThread();
+    t_worker_converted = false;
+    t_worker_fiber = nullptr;
+}
+
+#else
+
+static void fiber_trampoline() {
+    CmEmuMt_Fiber::entry_loop(CmEmuMt_Fiber::current());
+}
+
+CmEmuMt_Fiber::CmEmuMt_Fiber(size_t stackSize) {
+    const size_t pageSize = sysconf(_SC_PAGESIZE);
+    // One extra page at the bottom serves as a stack overflow guard.
+    m_stack_size = (stackSize + pageSize - 1) / pageSize * pageSize + pageSize;
+    m_stack = mmap(nullptr, m_stack_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    if (m_stack == MAP_FAILED) {
+        GFX_EMU_FAIL_WITH_MESSAGE(fSched, "unable to allocate fiber stack of %zu bytes: %s\n",
+            m_stack_size, std::strerror(errno));
+    }
+    mprotect(m_stack, pageSize, PROT_NONE);
+
+    getcontext(&m_ctx);
+    m_ctx.uc_stack.ss_sp = m_stack;
+    m_ctx.uc_stack.ss_size = m_stack_size;
+    m_ctx.uc_link = nullptr;
+    makecontext(&m_ctx, fiber_trampoline, 0);
+}
+
+CmEmuMt_Fiber::~CmEmuMt_Fiber() {
+    if (m_stack) munmap(m_stack, m_stack_size);
+}
+
+void CmEmuMt_Fiber::thread_init() {}
+void CmEmuMt_Fiber::thread_fini() {}
+
+#endif
+
+}  // namespace cmrt
@@ -0,0 +1,82 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2021 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#pragma once
+#ifndef CM_MT_RT_FIBER_INCLUDED
+#define CM_MT_RT_FIBER_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+#if !defined(_WIN32)
+#include <ucontext.h>
+#endif
+
+namespace cmrt
+{
+
+// Stackful user-mode execution context used for work-items in fibers
+// scheduling mode. A fiber never migrates between OS threads: it is created,
+// switched to and yielded from on the same worker thread.
+class CmEmuMt_Fiber
+{
+public:
+    using EntryFunc = void(*)(void*);
+
+private:
+    EntryFunc m_entry {nullptr};
+    void*     m_arg {nullptr};
+    bool      m_finished {true};
+
+    // SIMD control flow emulation keeps its state in thread_local storage,
+    // so it is swapped along with the fiber context.
+    void*    m_simd_working_stack {nullptr};
+    void*    m_simd_break_stack {nullptr};
+    uint32_t m_simd_marker {0};
+
+#if defined(_WIN32)
+    void* m_handle {nullptr};
+#else
+    ucontext_t m_ctx;
+    void*      m_stack {nullptr};
+    size_t     m_stack_size {0};
+#endif
+
+    void save_simd_state();
+    void restore_simd_state();
+
+public:
+    // Fiber body, for use by the platform-specific start routine only.
+    static void entry_loop(CmEmuMt_Fiber*);
+
+    explicit CmEmuMt_Fiber(size_t stackSize);
+    ~CmEmuMt_Fiber();
+
+    CmEmuMt_Fiber(const CmEmuMt_Fiber&) = delete;
+    CmEmuMt_Fiber& operator=(const CmEmuMt_Fiber&) = delete;
+
+    // Rearms a finished fiber to run entry(arg) on its next switch_to().
+    void reset(EntryFunc entry, void* arg);
+
+    // Runs the fiber until it yields or finishes. Called by the worker.
+    void switch_to();
+
+    // Returns control from the currently running fiber to its worker.
+    static void yield();
+
+    static CmEmuMt_Fiber* current();
+    bool finished() const { return m_finished; }
+
+    // Must bracket fibers usage on every worker OS thread.
+    static void thread_init();
+    static void thread_fini();
+};
+
+}  // namespace cmrt
+
+#endif // CM_MT_RT_FIBER_INCLUDED
@@ -0,0 +1,61 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2021 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include <climits>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "rt_futex.h"
+
+namespace cmrt
+{
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+    "futex word must be a plain 32-bit integer");
+
+#if defined(_WIN32)
+
+void futex_wait(std::atomic<uint32_t>& word, uint32_t expected) {
+    WaitOnAddress(&word, &expected, sizeof(expected), INFINITE);
+}
+
+void futex_wake_one(std::atomic<uint32_t>& word) {
+    WakeByAddressSingle(&word);
+}
+
+void futex_wake_all(std::atomic<uint32_t>& word) {
+    WakeByAddressAll(&word);
+}
+
+#else
+
+static long futex(std::atomic<uint32_t>& word, int op, uint32_t val) {
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), op, val, nullptr, nullptr, 0);
+}
+
+void futex_wait(std::atomic<uint32_t>& word, uint32_t expected) {
+    futex(word, FUTEX_WAIT_PRIVATE, expected);
+}
+
+void futex_wake_one(std::atomic<uint32_t>& word) {
+    futex(word, FUTEX_WAKE_PRIVATE, 1);
+}
+
+void futex_wake_all(std::atomic<uint32_t>& word) {
+    futex(word, FUTEX_WAKE_PRIVATE, INT_MAX);
+}
+
+#endif
+
+}  // namespace cmrt
@@ -0,0 +1,58 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2021 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#pragma once
+#ifndef CM_MT_RT_FUTEX_INCLUDED
+#define CM_MT_RT_FUTEX_INCLUDED
+
+#include <cstdint>
+#include <atomic>
+#include <thread>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace cmrt
+{
+
+// Address-based wait/wake primitives: Linux futex, Windows WaitOnAddress.
+// futex_wait() sleeps while word == expected; spurious wake-ups are possible.
+void futex_wait(std::atomic<uint32_t>& word, uint32_t expected);
+void futex_wake_one(std::atomic<uint32_t>& word);
+void futex_wake_all(std::atomic<uint32_t>& word);
+
+inline void cpu_relax()
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#endif
+}
+
+// Bounded busy-wait before falling asleep: waits handed over by another
+// core are often satisfied within a few hundred cycles. No spinning on a
+// single core machine as the other party can not make progress meanwhile.
+template<class Pred>
+bool spin_until(Pred isDone)
+{
+    constexpr int kSpinCount = 512;
+    static const bool spinEnabled = std::thread::hardware_concurrency () > 1;
+
+    if (isDone ()) return true;
+    if (!spinEnabled) return false;
+
+    for (int i = 0; i < kSpinCount; ++i) {
+        cpu_relax ();
+        if (isDone ()) return true;
+    }
+    return false;
+}
+
+}  // namespace cmrt
+
+#endif // CM_MT_RT_FUTEX_INCLUDED
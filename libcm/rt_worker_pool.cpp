@@ -0,0 +1,123 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2021 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+
+#include "rt_worker_pool.h"
+#include "emu_log.h"
+#include "emu_cfg.h"
+
+using namespace GfxEmu::Log::Flags;
+
+namespace cmrt
+{
+
+//=============================================================================
+CmEmuMt_WorkerPool::CmEmuMt_WorkerPool(uint32_t threadsCount) {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    while (m_threads_count < threadsCount)
+        start_thread();
+    GFX_EMU_MESSAGE(fSched, "worker pool started with %u threads.\n", m_threads_count);
+}
+
+// Never destroyed: parked workers must not be joined from static
+// destructors or DLL unload.
+CmEmuMt_WorkerPool& CmEmuMt_WorkerPool::instance() {
+    static auto& pool = *(new CmEmuMt_WorkerPool {
+        static_cast<uint32_t>(GfxEmu::Cfg::ParallelThreads ().getInt ())});
+    return pool;
+}
+
+uint32_t CmEmuMt_WorkerPool::threads_count() {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_threads_count;
+}
+
+//-----------------------------------------------------------------------------
+void CmEmuMt_WorkerPool::start_thread() {
+    std::thread {&CmEmuMt_WorkerPool::worker_loop, this}.detach ();
+    m_threads_count++;
+    m_idle_count++;
+}
+
+void CmEmuMt_WorkerPool::worker_loop() {
+    std::unique_lock<std::mutex> lk(m_mutex);
+    for (;;) {
+        m_condition.wait(lk, [this] { return !m_tasks.empty (); });
+        auto task = std::move(m_tasks.front ());
+        m_tasks.pop_front ();
+        m_idle_count--;
+
+        lk.unlock ();
+        task ();
+        task = nullptr; // Release captured state before parking.
+        lk.lock ();
+
+        m_idle_count++;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void CmEmuMt_WorkerPool::spawn(Task task) {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_tasks.emplace_back(std::move(task));
+    if (m_idle_count < m_tasks.size ()) {
+        start_thread ();
+        GFX_EMU_DEBUG_MESSAGE(fSched | fDetail, "worker pool grown to %u threads.\n", m_threads_count);
+    }
+    m_condition.notify_one ();
+}
+
+void CmEmuMt_WorkerPool::parallel_for(uint32_t count, const IndexedTask& task) {
+    if (!count) return;
+
+    struct State {
+        std::atomic<uint32_t> next {0};
+        uint32_t              done {0};
+        std::exception_ptr    error;
+        std::mutex            mutex;
+        std::condition_variable condition;
+    };
+    auto state = std::make_shared<State>();
+
+    // Helpers keep claiming indices until none are left, so the ones started
+    // late just return. The task is only referenced for a claimed index, and
+    // the caller does not return before all claimed indices are done.
+    auto claimLoop = [state, count, &task] {
+        uint32_t idx, doneHere = 0;
+        std::exception_ptr error;
+        while ((idx = state->next.fetch_add(1)) < count) {
+            try {
+                task(idx);
+            } catch (...) {
+                if (!error) error = std::current_exception ();
+            }
+            doneHere++;
+        }
+        if (!doneHere) return;
+
+        std::lock_guard<std::mutex> lk(state->mutex);
+        if (error && !state->error) state->error = error;
+        state->done += doneHere;
+        if (state->done == count) state->condition.notify_all ();
+    };
+
+    for (uint32_t i = 1; i < count; ++i)
+        spawn(claimLoop);
+    claimLoop ();
+
+    std::unique_lock<std::mutex> lk(state->mutex);
+    state->condition.wait(lk, [&] { return state->done == count; });
+    if (state->error)
+        std::rethrow_exception(state->error);
+}
+
+}  // namespace cmrt
@@ -0,0 +1,68 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2021 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#pragma once
+#ifndef CM_MT_RT_WORKER_POOL_INCLUDED
+#define CM_MT_RT_WORKER_POOL_INCLUDED
+
+#include <cstdint>
+
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+
+#include "cm_common_macros.h"
+
+namespace cmrt
+{
+
+// Process-wide set of OS threads shared by all kernel launches and queues.
+// Threads are started once and parked between tasks, so launches do not pay
+// for OS thread creation. The pool is pre-started with CM_RT_PARALLEL_THREADS
+// threads and grows on demand when more tasks are in flight than threads
+// are idle; it never shrinks.
+class CmEmuMt_WorkerPool
+{
+public:
+    using Task = std::function<void()>;
+    using IndexedTask = std::function<void(uint32_t)>;
+
+private:
+    std::mutex              m_mutex;
+    std::condition_variable m_condition;
+    std::deque<Task>        m_tasks;
+    uint32_t                m_threads_count {0};
+    uint32_t                m_idle_count {0};
+
+    CmEmuMt_WorkerPool(uint32_t threadsCount);
+
+    void start_thread(); // Must be called with m_mutex held.
+    void worker_loop();
+
+public:
+    CmEmuMt_WorkerPool(const CmEmuMt_WorkerPool&) = delete;
+    CmEmuMt_WorkerPool& operator=(const CmEmuMt_WorkerPool&) = delete;
+
+    CM_API static CmEmuMt_WorkerPool& instance();
+
+    // Runs the task on a pooled thread, never on the calling one.
+    CM_API void spawn(Task task);
+
+    // Runs task(0) .. task(count - 1) and returns when all of them are done.
+    // The calling thread takes part in execution, so progress is guaranteed
+    // even when all the pooled threads are busy. An exception thrown by any
+    // of the calls is rethrown to the caller.
+    CM_API void parallel_for(uint32_t count, const IndexedTask& task);
+
+    uint32_t threads_count();
+};
+
+}  // namespace cmrt
+
+#endif // CM_MT_RT_WORKER_POOL_INCLUDED
@@ -49,11 +49,7 @@ CmBufferEmu::~CmBufferEmu(){
     CM_unregister_buffer_emu(*pIndex,false);
     if(this->m_buffer != nullptr && this->alloc_dummy)
     {
-#if defined(_WIN32)
-        _aligned_free(this->m_buffer);
-#else
-        free(this->m_buffer);
-#endif
+        FreeBuffer();
     }
 }
 
@@ -62,17 +58,12 @@ int32_t CmBufferEmu::Initialize( uint32_t index, uint32_t arrayIndex, void *&sys
     m_arrayIndex=arrayIndex;
     if(sysMem == nullptr)
     {
-#if defined(_WIN32)
-        m_buffer = _aligned_malloc(m_width, 16); // oword aligned
-#else
-        posix_memalign(&m_buffer, 16, m_width); // oword aligned
-#endif
+        m_buffer = AllocBuffer(m_width); // cache line aligned
         if (m_buffer == nullptr) {
             GFX_EMU_ERROR_MESSAGE("Out of memory (%d) - 1dEmu\n", m_width);
             fflush(stderr);
             exit(1);
         }
-        CmSafeMemSet( m_buffer, 0, m_width );
         this->alloc_dummy = true;
         sysMem = m_buffer; // write buffer address back to sysMem
     }else
@@ -114,6 +105,11 @@ int32_t CmBufferEmu::Create(uint32_t index, uint32_t arrayIndex, uint32_t width,
 
 CM_RT_API int32_t CmBufferEmu::ReadSurface(unsigned char *pSysMem, CmEvent* pEvent, uint64_t sysMemSize )
 {
+    if (pEvent)
+    {
+        pEvent->WaitForTaskFinished();
+    }
+
     int index=0;
 
     if(pSysMem == nullptr)
@@ -133,13 +129,18 @@ CM_RT_API int32_t CmBufferEmu::ReadSurface(unsigned char *pSysMem, CmEvent* pEve
         surf1->read(mem2)
         use mem1 <-- problem because otherwise mem1 will be overwritten
     */
-    CmFastMemCopyFromWC(pSysMem, this->m_buffer, this->m_width, GetCpuInstructionLevel());
+    CmHostMemCopy(pSysMem, this->m_buffer, this->m_width);
 
     return CM_SUCCESS;
 }
 
 CM_RT_API int32_t CmBufferEmu::WriteSurface(const unsigned char *pSysMem, CmEvent* pEvent, uint64_t sysMemSize )
 {
+    if (pEvent)
+    {
+        pEvent->WaitForTaskFinished();
+    }
+
     if(pSysMem == nullptr)
     {
         GFX_EMU_ASSERT( 0 );
@@ -152,7 +153,7 @@ CM_RT_API int32_t CmBufferEmu::WriteSurface(const unsigned char *pSysMem, CmEven
         return CM_INVALID_ARG_VALUE;
     }
 
-    CmSafeMemCopy( this->m_buffer, pSysMem, this->m_width );
+    CmHostMemCopy( this->m_buffer, pSysMem, this->m_width );
 
     return DoGPUCopy();
 }
@@ -206,7 +207,12 @@ bool doD3DCopy
 
 CM_RT_API int32_t CmBufferEmu::InitSurface(const uint32_t initValue, CmEvent* pEvent)
 {
-    CmDwordMemSet( m_buffer, initValue, m_width );
+    if (pEvent)
+    {
+        pEvent->WaitForTaskFinished();
+    }
+
+    CmHostMemSet32( m_buffer, initValue, m_width );
     return DoGPUCopy();
 }
 
@@ -269,6 +275,7 @@ CM_RT_API int32_t CmBufferEmu::SetSurfaceStateParam(SurfaceIndex *surfIndex,
         aliasBufferState.uiBaseAddressOffset = bufferStateParam->uiBaseAddressOffset;
         std::pair<uint32_t, CM_BUFFER_STATE_PARAM> newElement(aliasIndex, aliasBufferState);
         m_aliasBufferStates.insert(newElement);
+        m_surfaceManager->AddToSyncSurfaces(this);
     }
     else
     {
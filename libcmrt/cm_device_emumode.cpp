@@ -93,6 +93,16 @@ int32_t CmDeviceEmu::Initialize()
     m_HalMaxValuesEx.max2DUPSurfaceTableSize = CM_MAX_2DSURFACEUP_TABLE_SIZE;
     m_HalMaxValuesEx.maxSampler8x8TableSize = CM_MAX_SAMPLER_8X8_TABLE_SIZE;
 
+    // Surfaces are not bound to a hardware binding table here, so workloads
+    // with many more live surfaces can ask for larger tables.
+    if (const uint32_t surfaceTableSize = GfxEmu::Cfg::SurfaceTableSize().getInt())
+    {
+        m_HalMaxValues.maxBufferTableSize = surfaceTableSize;
+        m_HalMaxValues.max2DSurfaceTableSize = surfaceTableSize;
+        m_HalMaxValues.max3DSurfaceTableSize = surfaceTableSize;
+        m_HalMaxValuesEx.max2DUPSurfaceTableSize = surfaceTableSize;
+    }
+
     result = CmSurfaceManagerEmu::Create(m_pSurfaceMgr,
         m_HalMaxValues, m_HalMaxValuesEx);
 
@@ -497,6 +507,7 @@ CM_RT_API int32_t CmDeviceEmu::DestroySurface(CmSurface2D *&pSurface)
     {
         return CM_FAILURE;
     }
+    WaitForQueuedTasks();
     CLock locker(m_CriticalSection_Surface);
     CmSurface2DEmu* temp = (CmSurface2DEmu*)(pSurface);
     int32_t status = this->m_pSurfaceMgr->DestroySurface(temp);
@@ -513,6 +524,7 @@ CM_RT_API int32_t CmDeviceEmu::DestroySurface(CmBuffer *&pSurface)
     {
         return CM_FAILURE;
     }
+    WaitForQueuedTasks();
     CLock locker(m_CriticalSection_Surface);
     CmBufferEmu* temp = (CmBufferEmu*)(pSurface);
     int32_t status = this->m_pSurfaceMgr->DestroySurface(temp);
@@ -541,12 +553,14 @@ CmDeviceEmu::~CmDeviceEmu()
     CLock locker(m_CriticalSection_Surface);
     CLock locker2(m_CriticalSection_Kernel);
 
-    CmSurfaceManagerEmu::Destroy( m_pSurfaceMgr );
+    // Queues go first, as they run the tasks still queued on destruction.
     CmQueueEmu::Destroy(this->m_pQueue);
 
     for_each(m_queueArray.begin(), m_queueArray.end(),
              CmQueueEmu::Destroy);
 
+    CmSurfaceManagerEmu::Destroy( m_pSurfaceMgr );
+
     for( uint32_t i = 0; i < m_KernelCount; i ++ )
     {
         CmKernelEmu* pKernel = (CmKernelEmu* )m_KernelArray.GetElement( i );
@@ -572,6 +586,7 @@ CmDeviceEmu::~CmDeviceEmu()
 
 CM_RT_API int32_t CmDeviceEmu::DestroyKernel( CmKernel*& pKernel)
 {
+    WaitForQueuedTasks();
     CLock locker(m_CriticalSection_Kernel);
     CmKernelEmu* temp = dynamic_cast< CmKernelEmu* >(pKernel);
     if( temp == nullptr )
@@ -613,6 +628,7 @@ CM_RT_API int32_t CmDeviceEmu::DestroyProgram( CmProgram*& pProgram )
         return CM_FAILURE;
     }
 
+    WaitForQueuedTasks();
     CLock locker(m_CriticalSection_Program);
     for( uint32_t i = 0; i < m_ProgramCount; i ++ )
     {
@@ -664,6 +680,7 @@ CM_RT_API int32_t CmDeviceEmu::DestroySurface( CmSurface3D* & pSurface)
     {
         return CM_FAILURE;
     }
+    WaitForQueuedTasks();
     CLock locker(m_CriticalSection_Surface);
     CmSurface3DEmu* temp = (CmSurface3DEmu*)(pSurface);
     int32_t status = this->m_pSurfaceMgr->DestroySurface(temp);
@@ -1193,6 +1210,7 @@ CM_RT_API int32_t CmDeviceEmu::DestroyBufferUP( CmBufferUP* & pSurface)
     {
         return CM_FAILURE;
     }
+    WaitForQueuedTasks();
     CLock locker(m_CriticalSection_Surface);
     CmBufferEmu* temp = (CmBufferEmu*)(pSurface);
     int32_t status = this->m_pSurfaceMgr->DestroySurface(temp);
@@ -1203,6 +1221,23 @@ CM_RT_API int32_t CmDeviceEmu::DestroyBufferUP( CmBufferUP* & pSurface)
     return status;
 }
 
+//*-----------------------------------------------------------------------------
+//| Purpose:    Block until the tasks queued on the queues of the device are
+//|             finished, as they may use the kernels, programs and surfaces
+//|             about to be destroyed.
+//*-----------------------------------------------------------------------------
+void CmDeviceEmu::WaitForQueuedTasks( )
+{
+    if( m_pQueue )
+    {
+        m_pQueue->WaitForQueuedTasks();
+    }
+    for( auto pQueue : m_queueArray )
+    {
+        pQueue->WaitForQueuedTasks();
+    }
+}
+
 int32_t CmDeviceEmu::DoCopyAll( )
 {
 
@@ -1298,6 +1333,7 @@ CM_RT_API int32_t CmDeviceEmu::DestroySurface2DUP( CmSurface2DUP* & pSurface)
         GFX_EMU_ASSERT( 0 );
         return CM_FAILURE;
     }
+    WaitForQueuedTasks();
     CLock locker(m_CriticalSection_Surface);
     CmSurface2DEmu* temp = (CmSurface2DEmu*)(pSurface);
     int32_t status = this->m_pSurfaceMgr->DestroySurface2DUP(temp);
@@ -1374,6 +1410,7 @@ CM_RT_API int32_t CmDeviceEmu::DestroyBufferSVM(CmBufferSVM *&pSurface)
     {
         return CM_FAILURE;
     }
+    WaitForQueuedTasks();
     CLock locker(m_CriticalSection_Surface);
     CmBufferEmu* temp = (CmBufferEmu*)(pSurface);
     int32_t status = m_pSurfaceMgr->DestroySurface(temp);
@@ -1542,6 +1579,7 @@ CM_RT_API int32_t CmDeviceEmu::DestroyBufferStateless(CmBufferStateless* & pSurf
         GFX_EMU_ASSERT(0);
         return CM_FAILURE;
     }
+    WaitForQueuedTasks();
     CLock locker(m_CriticalSection_Surface);
     CmBufferEmu* temp = (CmBufferEmu*)(pSurface);
     int32_t status = this->m_pSurfaceMgr->DestroySurface(temp);
@@ -1591,6 +1629,7 @@ CmDeviceEmu::DestroySurface2DStateless(CmSurface2DStateless *&pSurface)
         GFX_EMU_ASSERT(0);
         return CM_FAILURE;
     }
+    WaitForQueuedTasks();
     CLock locker(m_CriticalSection_Surface);
     CmSurface2DEmu* temp = (CmSurface2DEmu*)(pSurface);
     int32_t status = this->m_pSurfaceMgr->DestroySurface(temp);
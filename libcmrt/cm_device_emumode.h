@@ -177,6 +177,7 @@ protected:
     ~CmDeviceEmu( ) override;
 
     int32_t DestroyQueue( CmQueue* & pQueue );
+    void WaitForQueuedTasks( );
 
     // synchronization objects
     CSync m_CriticalSection_Program;
@@ -6,6 +6,9 @@ SPDX-License-Identifier: MIT
 
 ============================= end_copyright_notice ===========================*/
 
+#include <chrono>
+#include <cstring>
+
 #include "cm_include.h"
 #include "cm_event_emumode.h"
 
@@ -33,7 +36,8 @@ int32_t CmEventEmu::Destroy( CmEventEmu* &pEvent )
     return CM_SUCCESS;
 }
 
-CmEventEmu::CmEventEmu( uint32_t index ): m_Index( index ), m_RefCount(0)
+CmEventEmu::CmEventEmu( uint32_t index ): m_Index( index ), m_RefCount(0), m_Status(CM_STATUS_FINISHED),
+    m_Result(CM_SUCCESS), m_Times{}, m_Callback(nullptr), m_CallbackData(nullptr)
 {
 
 }
@@ -49,36 +53,75 @@ CmEventEmu::~CmEventEmu( void )
 //! is enqueued.
 //! This is a non-blocking call.
 //! INPUT:
-//!     The reference to status. For now only two status, CM_STATUS_QUEUED and CM_STATUS_FINISHED, are supported
+//!     The reference to status. CM_STATUS_QUEUED, CM_STATUS_STARTED and CM_STATUS_FINISHED are supported
 //! OUTPUT:
 //!     CM_SUCCESS if the status is successfully returned;
 //!     CM_FAILURE if not.
 //!
 CM_RT_API int32_t CmEventEmu::GetStatus( CM_STATUS& status)
 {
-    status = CM_STATUS_FINISHED;
+    std::lock_guard<std::mutex> lk(m_StatusMutex);
+    status = m_Status;
     return CM_SUCCESS;
 }
 
+//!
+//! Move the event to the given state, recording the time of the transition:
+//! queuing is the enqueue time, starting is the submit time.
+//!
+void CmEventEmu::SetStatus( CM_STATUS status )
+{
+    const auto now = Now();
+    Callback callback = nullptr;
+    void* callbackData = nullptr;
+    {
+        std::lock_guard<std::mutex> lk(m_StatusMutex);
+        m_Status = status;
+        switch (status)
+        {
+        case CM_STATUS_QUEUED:   m_Times[CM_EVENT_PROFILING_ENQUEUE] = now; break;
+        case CM_STATUS_STARTED:  m_Times[CM_EVENT_PROFILING_SUBMIT] = now; break;
+        case CM_STATUS_FINISHED:
+            m_Times[CM_EVENT_PROFILING_COMPLETE] = now;
+            callback = m_Callback;
+            callbackData = m_CallbackData;
+            break;
+        default: break;
+        }
+    }
+    if (status == CM_STATUS_FINISHED)
+    {
+        m_StatusCondition.notify_all();
+        if (callback)
+            callback(this, callbackData);
+    }
+}
+
+//!
+//! Record the result of the task run, before the event is finished.
+//!
+void CmEventEmu::SetResult( int32_t result )
+{
+    std::lock_guard<std::mutex> lk(m_StatusMutex);
+    m_Result = result;
+}
+
 //!
 //! Wait for the task completed associated with the event
 //! An internal event is generated when a task ( one kernel or multiples kernels running concurrently )
 //! is enqueued.
 //! INPUT:
-//!     Timout in Milliseconds
+//!     Timout in Milliseconds. Not applied: the timeout is meant for hardware
+//!     execution, emulated tasks are bounded by the kernel run timeout instead.
 //! OUTPUT:
-//!     CM_SUCCESS if the status is successfully returned;
-//!     CM_FAILURE if not.
+//!     CM_SUCCESS if the task is finished successfully;
+//!     the error returned by the task run if it failed.
 //!
 CM_RT_API int32_t CmEventEmu::WaitForTaskFinished(uint32_t dwTimeOutMs)
 {
-    CM_STATUS status;
-    GetStatus(status);
-    while( status != CM_STATUS_FINISHED)
-    {
-        GetStatus(status);
-    }
-    return CM_SUCCESS;
+    std::unique_lock<std::mutex> lk(m_StatusMutex);
+    m_StatusCondition.wait(lk, [this] { return m_Status == CM_STATUS_FINISHED; });
+    return m_Result;
 }
 
 //!
@@ -95,11 +138,16 @@ CM_RT_API int32_t CmEventEmu::WaitForTaskFinished(uint32_t dwTimeOutMs)
 //!
 CM_RT_API int32_t CmEventEmu::GetExecutionTime(unsigned long long& time)
 {
-    time = 100;
+    std::lock_guard<std::mutex> lk(m_StatusMutex);
+    if (m_Status != CM_STATUS_FINISHED)
+    {
+        return CM_FAILURE;
+    }
+    time = m_Times[CM_EVENT_PROFILING_HWEND] - m_Times[CM_EVENT_PROFILING_HWSTART];
     return CM_SUCCESS;
 }
 
-//! This is a non-blocking call.
+//! This is a non-blocking call. Ticks are nanoseconds in Emulation mode.
 //! INPUT:
 //!     Reference to tick number
 //! OUTPUT:
@@ -108,8 +156,160 @@ CM_RT_API int32_t CmEventEmu::GetExecutionTime(unsigned long long& time)
 //!
 CM_RT_API int32_t CmEventEmu::GetExecutionTickTime(unsigned long long& tick)
 {
-	tick = 100;
-	return CM_SUCCESS;
+	return GetExecutionTime(tick);
+}
+
+//!
+//! Query profiling information of the task associated with the event.
+//! Times are uint64_t nanoseconds of a monotonic clock. CM_EVENT_PROFILING_HWSTART
+//! and CM_EVENT_PROFILING_HWEND give the times of the whole task, or of a kernel
+//! of the task if pInputValue points to its uint32_t index.
+//! CM_EVENT_PROFILING_KERNELNAMES returns a char* and CM_EVENT_PROFILING_THREADSPACE
+//! four uint32_t values (thread space width, height, group space width, height) for
+//! the kernel index pInputValue points to. CM_EVENT_PROFILING_CALLBACK sets
+//! pInputValue as the function called on task completion with pValue as its data.
+//! INPUT:
+//!     Information type, size of the output, input and output value pointers
+//! OUTPUT:
+//!     CM_SUCCESS if the information is successfully returned
+//!     CM_FAILURE if not, e.g. the task hasn't finished
+//!
+CM_RT_API int32_t CmEventEmu::GetProfilingInfo(CM_EVENT_PROFILING_INFO infoType, size_t paramSize, void *pInputValue, void *pValue)
+{
+    if (infoType == CM_EVENT_PROFILING_CALLBACK)
+    {
+        if (!pInputValue)
+        {
+            return CM_NULL_POINTER;
+        }
+        const auto callback = reinterpret_cast<Callback>(pInputValue);
+        bool finished = false;
+        {
+            std::lock_guard<std::mutex> lk(m_StatusMutex);
+            m_Callback = callback;
+            m_CallbackData = pValue;
+            finished = m_Status == CM_STATUS_FINISHED;
+        }
+        if (finished)
+        {
+            callback(this, pValue);
+        }
+        return CM_SUCCESS;
+    }
+
+    if (!pValue)
+    {
+        return CM_NULL_POINTER;
+    }
+
+    std::lock_guard<std::mutex> lk(m_StatusMutex);
+
+    auto kernelIndex = [&] (uint32_t& index) {
+        if (!pInputValue)
+            return false;
+        index = *static_cast<const uint32_t*>(pInputValue);
+        return index < m_Kernels.size();
+    };
+    uint32_t index = 0;
+
+    switch (infoType)
+    {
+    case CM_EVENT_PROFILING_HWSTART:
+    case CM_EVENT_PROFILING_HWEND:
+    case CM_EVENT_PROFILING_SUBMIT:
+    case CM_EVENT_PROFILING_COMPLETE:
+    case CM_EVENT_PROFILING_ENQUEUE:
+    {
+        if (paramSize < sizeof(uint64_t))
+        {
+            return CM_INVALID_ARG_SIZE;
+        }
+        if (infoType != CM_EVENT_PROFILING_ENQUEUE && m_Status != CM_STATUS_FINISHED)
+        {
+            return CM_FAILURE;
+        }
+
+        auto time = m_Times[infoType];
+        if (pInputValue && (infoType == CM_EVENT_PROFILING_HWSTART || infoType == CM_EVENT_PROFILING_HWEND))
+        {
+            if (!kernelIndex(index))
+            {
+                return CM_INVALID_ARG_VALUE;
+            }
+            time = infoType == CM_EVENT_PROFILING_HWSTART ? m_Kernels[index].start : m_Kernels[index].end;
+        }
+        *static_cast<uint64_t*>(pValue) = time;
+        return CM_SUCCESS;
+    }
+
+    case CM_EVENT_PROFILING_KERNELCOUNT:
+        if (paramSize < sizeof(uint32_t))
+        {
+            return CM_INVALID_ARG_SIZE;
+        }
+        *static_cast<uint32_t*>(pValue) = static_cast<uint32_t>(m_Kernels.size());
+        return CM_SUCCESS;
+
+    case CM_EVENT_PROFILING_KERNELNAMES:
+        if (paramSize < sizeof(char*))
+        {
+            return CM_INVALID_ARG_SIZE;
+        }
+        if (!kernelIndex(index))
+        {
+            return CM_INVALID_ARG_VALUE;
+        }
+        *static_cast<const char**>(pValue) = m_Kernels[index].name.c_str();
+        return CM_SUCCESS;
+
+    case CM_EVENT_PROFILING_THREADSPACE:
+        if (paramSize < sizeof(m_Kernels[0].threadSpace))
+        {
+            return CM_INVALID_ARG_SIZE;
+        }
+        if (!kernelIndex(index))
+        {
+            return CM_INVALID_ARG_VALUE;
+        }
+        std::memcpy(pValue, m_Kernels[index].threadSpace, sizeof(m_Kernels[index].threadSpace));
+        return CM_SUCCESS;
+
+    default:
+        return CM_INVALID_ARG_VALUE;
+    }
+}
+
+uint64_t CmEventEmu::Now( void )
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void CmEventEmu::SetTime( CM_EVENT_PROFILING_INFO infoType, uint64_t time )
+{
+    std::lock_guard<std::mutex> lk(m_StatusMutex);
+    m_Times[infoType] = time;
+}
+
+//!
+//! Register a kernel of the task for profiling.
+//! OUTPUT:
+//!     Index of the kernel in the task.
+//!
+uint32_t CmEventEmu::AddKernel( const char* name, const uint32_t threadSpace[4] )
+{
+    std::lock_guard<std::mutex> lk(m_StatusMutex);
+    KernelProfile kernel {name ? name : "", {}, 0, 0};
+    std::memcpy(kernel.threadSpace, threadSpace, sizeof(kernel.threadSpace));
+    m_Kernels.push_back(std::move(kernel));
+    return static_cast<uint32_t>(m_Kernels.size() - 1);
+}
+
+void CmEventEmu::SetKernelTimes( uint32_t kernelIndex, uint64_t start, uint64_t end )
+{
+    std::lock_guard<std::mutex> lk(m_StatusMutex);
+    m_Kernels[kernelIndex].start = start;
+    m_Kernels[kernelIndex].end = end;
 }
 
 int32_t CmEventEmu::GetIndex( uint32_t & index )
@@ -124,8 +324,7 @@ int32_t CmEventEmu::GetIndex( uint32_t & index )
 //*-----------------------------------------------------------------------------
 int CmEventEmu::Acquire()
 {
-    ++m_RefCount;
-    return m_RefCount;
+    return ++m_RefCount;
 }
 
 //*-----------------------------------------------------------------------------
@@ -134,14 +333,14 @@ int CmEventEmu::Acquire()
 //*-----------------------------------------------------------------------------
 int CmEventEmu::SafeRelease()
 {
-    --m_RefCount;
-    if (m_RefCount == 0)
+    const auto refCount = --m_RefCount;
+    if (refCount == 0)
     {
         delete this;
         return 0;
     }
     else
     {
-        return m_RefCount;
+        return refCount;
     }
 }
@@ -8,6 +8,12 @@ SPDX-License-Identifier: MIT
 
 #pragma once
 
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <vector>
+
 #include "cm_event_base.h"
 #include "cm_def.h"
 #include "emu_log.h"
@@ -32,13 +38,46 @@ public:
     CM_RT_API int32_t GetSurfaceDetails(uint32_t kernIndex, uint32_t surfBTI,CM_SURFACE_DETAILS& outDetails ) { return CmNotImplemented(__PRETTY_FUNCTION__); }
 
     int32_t GetIndex( uint32_t & index );
-    CM_RT_API int32_t GetProfilingInfo(CM_EVENT_PROFILING_INFO infoType, size_t paramSize, void  *pInputValue, void  *pValue) { return CmNotImplemented(__PRETTY_FUNCTION__); };
+    CM_RT_API int32_t GetProfilingInfo(CM_EVENT_PROFILING_INFO infoType, size_t paramSize, void  *pInputValue, void  *pValue);
 	CM_RT_API int32_t GetExecutionTickTime(unsigned long long& tick);
+
+    void SetStatus( CM_STATUS status );
+    void SetResult( int32_t result );
+
+    // Profiling data recorded by the queue. Times are in nanoseconds of the
+    // monotonic clock returned by Now().
+    static uint64_t Now( void );
+    void SetTime( CM_EVENT_PROFILING_INFO infoType, uint64_t time );
+    uint32_t AddKernel( const char* name, const uint32_t threadSpace[4] );
+    void SetKernelTimes( uint32_t kernelIndex, uint64_t start, uint64_t end );
+
 protected:
     CmEventEmu( uint32_t index  );
     ~CmEventEmu( void );
 
     uint32_t m_Index;
-    int m_RefCount;
+    std::atomic<int> m_RefCount;
+
+    // Tasks run synchronously are finished by the time their event is
+    // returned; the asynchronous queue executor moves it through the states.
+    CM_STATUS m_Status;
+    int32_t m_Result; // Result of the task run, returned by WaitForTaskFinished.
+    std::mutex m_StatusMutex;
+    std::condition_variable m_StatusCondition;
+
+    using Callback = void (*)(CmEvent*, void*);
+
+    struct KernelProfile
+    {
+        std::string name;
+        uint32_t    threadSpace[4]; // Thread space width, height and group space width, height.
+        uint64_t    start, end;
+    };
+
+    // Indexed by CM_EVENT_PROFILING_HWSTART .. CM_EVENT_PROFILING_ENQUEUE.
+    uint64_t m_Times[CM_EVENT_PROFILING_ENQUEUE + 1];
+    std::vector<KernelProfile> m_Kernels;
+    Callback m_Callback;
+    void* m_CallbackData;
 
 };
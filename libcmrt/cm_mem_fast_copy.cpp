@@ -0,0 +1,452 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2021 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include <algorithm>
+#include <thread>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "cm_include.h"
+#include "cm_mem_fast_copy.h"
+#include "rt_worker_pool.h"
+#include "emu_cfg.h"
+
+#if defined(__GNUC__)
+#define CM_TARGET_AVX2   __attribute__((target("avx2")))
+#define CM_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define CM_TARGET_AVX2
+#define CM_TARGET_AVX512
+#endif
+
+namespace
+{
+
+// Copies of this size and larger use non-temporal stores: the destination
+// would not stay in the caches anyway and streaming avoids the RFO reads.
+const size_t kStreamingThreshold = 4 << 20;
+
+// Least number of bytes copied by one worker of a parallel copy.
+const size_t kParallelChunk = 1 << 20;
+
+enum class CopyIsa { SSE2, AVX2, AVX512 };
+
+/*****************************************************************************\
+Function:
+GetCopyIsa
+
+Description:
+Returns the widest vector instruction set usable for copies, checked once
+with CPUID, including the OS support for the extended register state.
+\*****************************************************************************/
+CopyIsa GetCopyIsa()
+{
+    static const CopyIsa isa = [] {
+#if defined(__GNUC__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+            return CopyIsa::AVX512;
+        if (__builtin_cpu_supports("avx2"))
+            return CopyIsa::AVX2;
+#elif defined(_MSC_VER)
+        int cpuInfo[4];
+        __cpuid(cpuInfo, 0);
+        const int maxLeaf = cpuInfo[0];
+        __cpuid(cpuInfo, 1);
+        const bool osxsave = (cpuInfo[2] & BIT(27)) && (cpuInfo[2] & BIT(28));
+        if (osxsave && maxLeaf >= 7)
+        {
+            const unsigned long long xcr0 = _xgetbv(0);
+            __cpuidex(cpuInfo, 7, 0);
+            if ((xcr0 & 0xe6) == 0xe6 && (cpuInfo[1] & BIT(16)))
+                return CopyIsa::AVX512;
+            if ((xcr0 & 0x6) == 0x6 && (cpuInfo[1] & BIT(5)))
+                return CopyIsa::AVX2;
+        }
+#endif
+        return CopyIsa::SSE2;
+    } ();
+    return isa;
+}
+
+CM_TARGET_AVX2 void CopyAVX2(uint8_t *dst, const uint8_t *src, size_t bytes, bool stream)
+{
+    if (bytes >= sizeof(__m256i))
+    {
+        // Align the destination, streaming stores require it.
+        const size_t head = GetAlignmentOffset(dst, sizeof(__m256i));
+        CmSafeMemCopy(dst, src, head);
+        dst += head;
+        src += head;
+        bytes -= head;
+
+        __m256i *dst256i = (__m256i *)dst;
+        const __m256i *src256i = (const __m256i *)src;
+        const size_t count = bytes / sizeof(__m256i);
+        size_t i = 0;
+        if (stream)
+        {
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m256i ymm0 = _mm256_loadu_si256(src256i + i);
+                const __m256i ymm1 = _mm256_loadu_si256(src256i + i + 1);
+                const __m256i ymm2 = _mm256_loadu_si256(src256i + i + 2);
+                const __m256i ymm3 = _mm256_loadu_si256(src256i + i + 3);
+                _mm256_stream_si256(dst256i + i, ymm0);
+                _mm256_stream_si256(dst256i + i + 1, ymm1);
+                _mm256_stream_si256(dst256i + i + 2, ymm2);
+                _mm256_stream_si256(dst256i + i + 3, ymm3);
+            }
+            for (; i < count; i++)
+                _mm256_stream_si256(dst256i + i, _mm256_loadu_si256(src256i + i));
+        }
+        else
+        {
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m256i ymm0 = _mm256_loadu_si256(src256i + i);
+                const __m256i ymm1 = _mm256_loadu_si256(src256i + i + 1);
+                const __m256i ymm2 = _mm256_loadu_si256(src256i + i + 2);
+                const __m256i ymm3 = _mm256_loadu_si256(src256i + i + 3);
+                _mm256_store_si256(dst256i + i, ymm0);
+                _mm256_store_si256(dst256i + i + 1, ymm1);
+                _mm256_store_si256(dst256i + i + 2, ymm2);
+                _mm256_store_si256(dst256i + i + 3, ymm3);
+            }
+            for (; i < count; i++)
+                _mm256_store_si256(dst256i + i, _mm256_loadu_si256(src256i + i));
+        }
+        dst += count * sizeof(__m256i);
+        src += count * sizeof(__m256i);
+        bytes -= count * sizeof(__m256i);
+    }
+
+    if (bytes)
+    {
+        CmSafeMemCopy(dst, src, bytes);
+    }
+}
+
+CM_TARGET_AVX512 void CopyAVX512(uint8_t *dst, const uint8_t *src, size_t bytes, bool stream)
+{
+    if (bytes >= sizeof(__m512i))
+    {
+        // Align the destination to the cache line, streaming stores require it.
+        const size_t head = GetAlignmentOffset(dst, sizeof(__m512i));
+        CmSafeMemCopy(dst, src, head);
+        dst += head;
+        src += head;
+        bytes -= head;
+
+        __m512i *dst512i = (__m512i *)dst;
+        const __m512i *src512i = (const __m512i *)src;
+        const size_t count = bytes / sizeof(__m512i);
+        size_t i = 0;
+        if (stream)
+        {
+            for (; i + 2 <= count; i += 2)
+            {
+                const __m512i zmm0 = _mm512_loadu_si512(src512i + i);
+                const __m512i zmm1 = _mm512_loadu_si512(src512i + i + 1);
+                _mm512_stream_si512(dst512i + i, zmm0);
+                _mm512_stream_si512(dst512i + i + 1, zmm1);
+            }
+            for (; i < count; i++)
+                _mm512_stream_si512(dst512i + i, _mm512_loadu_si512(src512i + i));
+        }
+        else
+        {
+            for (; i + 2 <= count; i += 2)
+            {
+                const __m512i zmm0 = _mm512_loadu_si512(src512i + i);
+                const __m512i zmm1 = _mm512_loadu_si512(src512i + i + 1);
+                _mm512_store_si512(dst512i + i, zmm0);
+                _mm512_store_si512(dst512i + i + 1, zmm1);
+            }
+            for (; i < count; i++)
+                _mm512_store_si512(dst512i + i, _mm512_loadu_si512(src512i + i));
+        }
+        dst += count * sizeof(__m512i);
+        src += count * sizeof(__m512i);
+        bytes -= count * sizeof(__m512i);
+    }
+
+    if (bytes)
+    {
+        CmSafeMemCopy(dst, src, bytes);
+    }
+}
+
+void CopyRow(uint8_t *dst, const uint8_t *src, size_t bytes, bool stream)
+{
+    switch (GetCopyIsa())
+    {
+    case CopyIsa::AVX512:
+        CopyAVX512(dst, src, bytes, stream);
+        break;
+    case CopyIsa::AVX2:
+        CopyAVX2(dst, src, bytes, stream);
+        break;
+    default:
+        if (stream)
+            CmFastMemCopy(dst, src, bytes);
+        else
+            CmSafeMemCopy(dst, src, bytes);
+        break;
+    }
+}
+
+// Byte fills of the unaligned head and the tail of a fill. The value pattern
+// starts at the fill start, offset is the position from there.
+inline void FillBytes(uint8_t *dst, const uint32_t value, size_t offset, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; i++)
+        dst[i] = uint8_t(value >> (8 * ((offset + i) % 4)));
+}
+
+// The value pattern as seen from an aligned position offset bytes in.
+inline uint32_t RotatePattern(const uint32_t value, size_t offset)
+{
+    const uint32_t shift = uint32_t(8 * (offset % 4));
+    return shift ? (value >> shift) | (value << (32 - shift)) : value;
+}
+
+CM_TARGET_AVX2 void FillAVX2(uint8_t *dst, const uint32_t value, size_t bytes, bool stream)
+{
+    const size_t head = std::min(bytes, GetAlignmentOffset(dst, sizeof(__m256i)));
+    FillBytes(dst, value, 0, head);
+
+    const __m256i pattern = _mm256_set1_epi32(int(RotatePattern(value, head)));
+    __m256i *dst256i = (__m256i *)(dst + head);
+    const size_t count = (bytes - head) / sizeof(__m256i);
+    if (stream)
+    {
+        for (size_t i = 0; i < count; i++)
+            _mm256_stream_si256(dst256i + i, pattern);
+    }
+    else
+    {
+        for (size_t i = 0; i < count; i++)
+            _mm256_store_si256(dst256i + i, pattern);
+    }
+
+    const size_t done = head + count * sizeof(__m256i);
+    FillBytes(dst + done, value, done, bytes - done);
+}
+
+CM_TARGET_AVX512 void FillAVX512(uint8_t *dst, const uint32_t value, size_t bytes, bool stream)
+{
+    const size_t head = std::min(bytes, GetAlignmentOffset(dst, sizeof(__m512i)));
+    FillBytes(dst, value, 0, head);
+
+    const __m512i pattern = _mm512_set1_epi32(int(RotatePattern(value, head)));
+    __m512i *dst512i = (__m512i *)(dst + head);
+    const size_t count = (bytes - head) / sizeof(__m512i);
+    if (stream)
+    {
+        for (size_t i = 0; i < count; i++)
+            _mm512_stream_si512(dst512i + i, pattern);
+    }
+    else
+    {
+        for (size_t i = 0; i < count; i++)
+            _mm512_store_si512(dst512i + i, pattern);
+    }
+
+    const size_t done = head + count * sizeof(__m512i);
+    FillBytes(dst + done, value, done, bytes - done);
+}
+
+void FillSSE2(uint8_t *dst, const uint32_t value, size_t bytes, bool stream)
+{
+    const size_t head = std::min(bytes, GetAlignmentOffset(dst, sizeof(__m128i)));
+    FillBytes(dst, value, 0, head);
+
+    const __m128i pattern = _mm_set1_epi32(int(RotatePattern(value, head)));
+    __m128i *dst128i = (__m128i *)(dst + head);
+    const size_t count = (bytes - head) / sizeof(__m128i);
+    if (stream)
+    {
+        for (size_t i = 0; i < count; i++)
+            _mm_stream_si128(dst128i + i, pattern);
+    }
+    else
+    {
+        for (size_t i = 0; i < count; i++)
+            _mm_store_si128(dst128i + i, pattern);
+    }
+
+    const size_t done = head + count * sizeof(__m128i);
+    FillBytes(dst + done, value, done, bytes - done);
+}
+
+void FillRow(uint8_t *dst, const uint32_t value, size_t bytes, bool stream)
+{
+    switch (GetCopyIsa())
+    {
+    case CopyIsa::AVX512:
+        FillAVX512(dst, value, bytes, stream);
+        break;
+    case CopyIsa::AVX2:
+        FillAVX2(dst, value, bytes, stream);
+        break;
+    default:
+        FillSSE2(dst, value, bytes, stream);
+        break;
+    }
+}
+
+// Number of workers to split a copy of the given size across.
+uint32_t GetCopyWorkers(size_t bytes)
+{
+    static const uint32_t maxWorkers = std::max(1u, std::min(
+        static_cast<uint32_t>(GfxEmu::Cfg::ParallelThreads ().getInt ()),
+        std::thread::hardware_concurrency ()));
+    return static_cast<uint32_t>(std::min<size_t>(maxWorkers, std::max<size_t>(1, bytes / kParallelChunk)));
+}
+
+// Calls rangeOp(dstOffset, srcOffset, bytes, stream) for ranges covering
+// rows of rowBytes bytes. Contiguous rows are covered as one linear range,
+// split at cache line boundaries. Large copies are run on the worker pool.
+template <typename RangeOp>
+void ForEachRange(const size_t dstPitch, const size_t srcPitch,
+                  const size_t rowBytes, const size_t rows, RangeOp rangeOp)
+{
+    size_t rowSize = rowBytes;
+    size_t rowsCount = rows;
+    if (dstPitch == rowBytes && srcPitch == rowBytes)
+    {
+        rowSize *= rowsCount;
+        rowsCount = 1;
+    }
+
+    const size_t bytes = rowSize * rowsCount;
+    if (!bytes)
+    {
+        return;
+    }
+
+    const bool stream = bytes >= kStreamingThreshold;
+    const uint32_t workers = GetCopyWorkers(bytes);
+
+    auto runWorker = [&] (uint32_t worker) {
+        if (rowsCount == 1)
+        {
+            const size_t chunk = (rowSize / workers + 63) & ~size_t(63);
+            const size_t begin = std::min(rowSize, chunk * worker);
+            const size_t end = worker + 1 == workers ? rowSize : std::min(rowSize, begin + chunk);
+            rangeOp(begin, begin, end - begin, stream);
+        }
+        else
+        {
+            const size_t begin = rowsCount * worker / workers;
+            const size_t end = rowsCount * (worker + 1) / workers;
+            for (size_t row = begin; row < end; row++)
+            {
+                rangeOp(row * dstPitch, row * srcPitch, rowSize, stream);
+            }
+        }
+        if (stream)
+        {
+            // Order the streaming stores before the copy is reported done.
+            _mm_sfence();
+        }
+    };
+
+    if (workers == 1)
+    {
+        runWorker(0);
+    }
+    else
+    {
+        cmrt::CmEmuMt_WorkerPool::instance ().parallel_for(workers, runWorker);
+    }
+}
+
+} // namespace
+
+/*****************************************************************************\
+Function:
+CmHostMemCopy
+
+Description:
+Copies host memory with the widest vector instructions supported by the CPU.
+Copies of kStreamingThreshold bytes and more use non-temporal stores and are
+split across the worker pool threads.
+\*****************************************************************************/
+void CmHostMemCopy(void* dst, const void* src, const size_t bytes)
+{
+    CmHostMemCopy2D(dst, bytes, src, bytes, bytes, 1);
+}
+
+/*****************************************************************************\
+Function:
+CmHostMemCopy2D
+
+Description:
+Copies rows of rowBytes bytes between buffers of the given pitches, as
+CmHostMemCopy does. A copy of contiguous rows is done as one linear copy.
+\*****************************************************************************/
+void CmHostMemCopy2D(void* dst, const size_t dstPitch,
+                     const void* src, const size_t srcPitch,
+                     const size_t rowBytes, const size_t rows)
+{
+    uint8_t *p_dst = (uint8_t*)dst;
+    const uint8_t *p_src = (const uint8_t*)src;
+
+    ForEachRange(dstPitch, srcPitch, rowBytes, rows,
+        [=] (size_t dstOffset, size_t srcOffset, size_t bytes, bool stream) {
+            CopyRow(p_dst + dstOffset, p_src + srcOffset, bytes, stream);
+        });
+}
+
+/*****************************************************************************\
+Function:
+CmHostMemSet32
+
+Description:
+Fills the whole dwords of bytes with value, as CmDwordMemSet does, using the
+host copy engine vector instructions and threads.
+\*****************************************************************************/
+void CmHostMemSet32(void* dst, const uint32_t value, const size_t bytes)
+{
+    uint8_t *p_dst = (uint8_t*)dst;
+    const size_t dwordBytes = bytes & ~size_t(3);
+
+    // Linear ranges start at multiples of 64, so the pattern starts over there.
+    ForEachRange(dwordBytes, dwordBytes, dwordBytes, 1,
+        [=] (size_t dstOffset, size_t, size_t bytes, bool stream) {
+            FillRow(p_dst + dstOffset, value, bytes, stream);
+        });
+}
+
+/*****************************************************************************\
+Function:
+CmHostMemSet32_2D
+
+Description:
+Fills the whole dwords of rows of rowBytes bytes, the value pattern starting
+over at every row. Contiguous rows are filled as CmHostMemSet32 does.
+\*****************************************************************************/
+void CmHostMemSet32_2D(void* dst, const size_t dstPitch, const uint32_t value,
+                       const size_t rowBytes, const size_t rows)
+{
+    if (dstPitch == rowBytes)
+    {
+        CmHostMemSet32(dst, value, rowBytes * rows);
+        return;
+    }
+
+    uint8_t *p_dst = (uint8_t*)dst;
+    ForEachRange(dstPitch, dstPitch, rowBytes & ~size_t(3), rows,
+        [=] (size_t dstOffset, size_t, size_t bytes, bool stream) {
+            FillRow(p_dst + dstOffset, value, bytes, stream);
+        });
+}
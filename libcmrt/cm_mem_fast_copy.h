@@ -39,6 +39,15 @@ inline bool IsAligned(void * ptr, const size_t alignSize);
 inline void CmFastMemCopy(void* dst, const void* src, const size_t bytes);
 inline void CmFastMemCopyFromWC(void* dst, const void* src, const size_t bytes, CPU_INSTRUCTION_LEVEL cpuInstructionLevel);
 
+// Host copy engine, see cm_mem_fast_copy.cpp.
+void CmHostMemCopy(void* dst, const void* src, const size_t bytes);
+void CmHostMemCopy2D(void* dst, const size_t dstPitch,
+                     const void* src, const size_t srcPitch,
+                     const size_t rowBytes, const size_t rows);
+void CmHostMemSet32(void* dst, const uint32_t value, const size_t bytes);
+void CmHostMemSet32_2D(void* dst, const size_t dstPitch, const uint32_t value,
+                       const size_t rowBytes, const size_t rows);
+
 inline void Prefetch(const void* ptr);
 inline void FastMemCopy_SSE2(void* dst, void* src, const size_t doubleQuadWords);
 
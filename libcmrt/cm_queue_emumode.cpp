@@ -127,20 +127,7 @@ int32_t CmQueueEmu::Enqueue_preG12(
     CmEvent *&           pEvent,
     const CmThreadSpace *pTS)
 {
-    int32_t  result     = 0;
-    uint32_t numThreads = 0;
-    uint32_t numMaxArgs = 0;
-    uint32_t x, y = 0;
-    uint32_t i              = 0;
-    uint32_t threadArgCount = 0;
-    uint32_t kernelArgCount = 0;
     uint32_t kernelCount    = 0;
-    int      totalOffset    = 0;
-    void (*fncPt)()         = nullptr;
-    CmKernelEmu *kernel     = NULL;
-    //GfxEmu::KernelArg *     pArg       = nullptr;
-
-    bool threadArgExists = false;
 
     CmThreadSpaceEmu *threadSpace = dynamic_cast<CmThreadSpaceEmu *>(const_cast<CmThreadSpace *>(pTS));
 
@@ -152,8 +139,6 @@ int32_t CmQueueEmu::Enqueue_preG12(
         return CM_INVALID_ARG_VALUE;
     }
 
-    uint32_t totalThreadCount = 0;
-    uint32_t count = 0;
     auto pKATmp = (CmKernelArrayEmu *)pKernelArray;
     kernelCount = pKATmp->GetKernelCount();
 
@@ -165,111 +150,166 @@ int32_t CmQueueEmu::Enqueue_preG12(
         return CM_EXCEED_MAX_KERNEL_PER_ENQUEUE;
     }
 
-    CLock locker(m_CriticalSection_Tasks);
-
-    //selectively copies from SRC to volatile buffer for SM and UP surfaces/buffers
-    this->m_pDevice->DoGPUCopySelect();
+    if (kernelCount == 0)
+    {
+        GFX_EMU_ERROR_MESSAGE("There are no valid kernels!");
+        GFX_EMU_ASSERT(0);
+        return CM_FAILURE;
+    }
 
+    // Kernels and their thread spaces are resolved on enqueue, as the task
+    // itself may be destroyed before it is run.
+    std::vector<CmKernelEmu *>      kernels(kernelCount);
+    std::vector<CmThreadSpaceEmu *> threadSpaces(kernelCount, threadSpace);
+    std::vector<KernelSpace>        spaces(kernelCount);
     for (uint32_t i = 0; i < kernelCount; i++)
     {
-        numThreads                       = 0;
-        numMaxArgs                       = 0;
-        threadArgCount                   = 0;
-        CmThreadSpaceEmu *threadSpaceEmu = threadSpace;
-        kernel                           = (CmKernelEmu *)pKATmp->GetKernelPointer(i);
-        kernel->SetIndexInTask(i);
-        if (threadSpaceEmu == nullptr)
+        kernels[i] = (CmKernelEmu *)pKATmp->GetKernelPointer(i);
+        kernels[i]->SetIndexInTask(i);
+    }
+    for (uint32_t i = 0; i < kernelCount; i++)
+    {
+        if (threadSpaces[i] == nullptr)
         {
-            kernel->GetThreadSpace(threadSpaceEmu);
+            kernels[i]->GetThreadSpace(threadSpaces[i]);
         }
-        if (threadSpaceEmu)
+        if (threadSpaces[i])
         {
-            if (!threadSpaceEmu->IntegrityCheck(pKATmp))
+            if (!threadSpaces[i]->IntegrityCheck(pKATmp))
             {
                 GFX_EMU_ASSERT(0);
                 return CM_INVALID_THREAD_SPACE;
             }
+            threadSpaces[i]->GetThreadSpaceSize(spaces[i][0], spaces[i][1]);
         }
+        else
+        {
+            spaces[i][0] = GetThreadCount(kernels[i], nullptr);
+            spaces[i][1] = 1;
+        }
+        spaces[i][2] = spaces[i][3] = 1;
+    }
 
-        kernel->GetThreadArgCount(threadArgCount);
-        //kernel->GetArgs(pArg);
-        kernel->GetMaxArgCount(numMaxArgs);
-        kernel->GetArgCount(kernelArgCount);
-        numThreads = GetThreadCount(kernel, threadSpaceEmu);
-        fncPt      = (void (*)())kernel->GetFuncPnt();
-        if (!threadArgCount)
+    std::vector<uint32_t> threadCounts(kernelCount), threadArgCounts(kernelCount);
+    for (uint32_t i = 0; i < kernelCount; i++)
+    {
+        threadCounts[i] = GetThreadCount(kernels[i], threadSpaces[i]);
+        kernels[i]->GetThreadArgCount(threadArgCounts[i]);
+    }
+
+    // A queued task runs on copies of the thread spaces, which the host is
+    // free to change or destroy once the enqueue returns. Each kernel gets a
+    // copy of its own, as the kernel is associated with it when run.
+    std::vector<std::shared_ptr<CmThreadSpaceEmu>> snapshots;
+    if (m_Async)
+    {
+        for (auto &ts : threadSpaces)
+        {
+            if (ts == nullptr)
+            {
+                continue;
+            }
+            CmThreadSpaceEmu *snapshot = nullptr;
+            const auto        result   = CmThreadSpaceEmu::CreateSnapshot(*ts, snapshot);
+            if (result != CM_SUCCESS)
+            {
+                return result;
+            }
+            snapshots.emplace_back(snapshot, [](CmThreadSpaceEmu *p) { CmThreadSpaceEmu::Destroy(p); });
+            ts = snapshot;
+        }
+    }
+
+    const auto result = Submit(kernels, spaces,
+        [this, kernels, threadSpaces, threadCounts, threadArgCounts, snapshots] (CmEventEmu *event) -> int32_t {
+        int32_t  result         = 0;
+        uint32_t numThreads     = 0;
+        uint32_t x, y           = 0;
+        uint32_t threadArgCount = 0;
+
+        CLock locker(m_CriticalSection_Tasks);
+
+        //selectively copies from SRC to volatile buffer for SM and UP surfaces/buffers
+        this->m_pDevice->DoGPUCopySelect();
+
+        for (uint32_t i = 0; i < kernels.size(); i++)
         {
-            if (threadSpaceEmu != nullptr)
+            numThreads                       = threadCounts[i];
+            threadArgCount                   = threadArgCounts[i];
+            CmThreadSpaceEmu *threadSpaceEmu = threadSpaces[i];
+            CmKernelEmu *     kernel         = kernels[i];
+            const auto        start          = CmEventEmu::Now();
+            if (!threadArgCount)
+            {
+                if (threadSpaceEmu != nullptr)
+                {
+                    threadSpaceEmu->InitDependency();
+                    if (!threadSpaceEmu->IsThreadAssociated())
+                        threadSpaceEmu->AssociateKernel(kernel);
+                    if ((result = ExecuteScoreBoard_1(threadSpaceEmu, true)) != CM_SUCCESS)
+                    {
+                        GFX_EMU_ASSERT(0);
+                        return result;
+                    }
+                }
+                else
+                {
+                    MediaWorkItems items(numThreads);
+                    for (uint32_t i = 0; i < numThreads; i++)
+                    {
+                        items[i] = {i, (uint16_t)(i % 511), (uint16_t)(i / 511), 0};
+                    }
+                    if ((result = Execute(*kernel, std::move(items))) != CM_SUCCESS)
+                    {
+                        return result;
+                    }
+                }
+            }
+
+            else if (threadSpaceEmu != nullptr)
             {
                 threadSpaceEmu->InitDependency();
                 if (!threadSpaceEmu->IsThreadAssociated())
                     threadSpaceEmu->AssociateKernel(kernel);
-                if ((result = ExecuteScoreBoard_1(threadSpaceEmu, true)) != CM_SUCCESS)
+
+                if (ExecuteScoreBoard_1(threadSpaceEmu, false) == CM_FAILURE)
                 {
                     GFX_EMU_ASSERT(0);
-                    return result;
+                    return CM_FAILURE;
                 }
             }
             else
             {
-                for (uint32_t i = 0; i < numThreads; i++)
+                MediaWorkItems items;
+                items.reserve(numThreads);
+                for (uint32_t threadId = 0; threadId < numThreads; threadId++)
+                {
+                    //was already executed during scoreboard.
+                    if (kernel->GetSCBCoord(threadId, x, y))
+                        continue;
+                    items.push_back({threadId, (uint16_t)(threadId % 512), (uint16_t)(threadId / 512), 0});
+                }
+                if ((result = Execute(*kernel, std::move(items))) != CM_SUCCESS)
                 {
-                    set_thread_origin_x(i % 511);
-                    set_thread_origin_y(i / 511);
-                    Execute(*kernel, i);
+                    return result;
                 }
             }
-        }
-
-        else if (threadSpaceEmu != nullptr)
-        {
-            threadSpaceEmu->InitDependency();
-            if (!threadSpaceEmu->IsThreadAssociated())
-                threadSpaceEmu->AssociateKernel(kernel);
+            m_pDevice->DoCopyAll();
 
-            if (ExecuteScoreBoard_1(threadSpaceEmu, false) == CM_FAILURE)
-            {
-                GFX_EMU_ASSERT(0);
-                return CM_FAILURE;
-            }
-        }
-        else
-        {
-            for (uint32_t threadId = 0; threadId < numThreads; threadId++)
+            if (event)
             {
-                //was already executed during scoreboard.
-                if (kernel->GetSCBCoord(threadId, x, y))
-                    continue;
-                set_thread_origin_x(threadId % 512);
-                set_thread_origin_y(threadId / 512);
-                Execute(*kernel, threadId);
+                event->SetKernelTimes(i, start, CmEventEmu::Now());
             }
         }
-        m_pDevice->DoCopyAll();
-    }
 
-    if (kernelCount == 0)
-    {
-        GFX_EMU_ERROR_MESSAGE("There are no valid kernels!");
-        GFX_EMU_ASSERT(0);
-        return CM_FAILURE;
-    }
+        return CM_SUCCESS;
+    }, pEvent);
 
-    if (pEvent != INVISIBLE_EVENT_MAGIC_NUM)
-    {
-        CmEventEmu *pTmp = nullptr;
-        if (CmEventEmu::Create(m_EventCount, pTmp) == CM_SUCCESS)
-        {
-            m_EventArray.SetElement(m_EventCount, pTmp);
-            m_EventCount++;
-            pEvent = static_cast<CmEvent *>(pTmp);
-        }
-    }
-    else
+    if (result != CM_SUCCESS)
     {
-        // if the input pEvent equals to INVISIBLE_EVENT_MAGIC_NUM, event will not be created.
-        pEvent = nullptr;
+        return result;
     }
+
 #ifdef GFX_EMU_DEBUG_ENABLED
     //////////////////////////////////////////////////////////////////////////////////////
     if (CmStatistics::Get() != nullptr)
@@ -368,10 +408,6 @@ CM_RT_API int32_t CmQueueEmu::EnqueueWithGroup(
     const CmThreadGroupSpace *pTGS)
 {
     uint32_t kernelCount = 0;
-    int      totalOffset = 0;
-    void (*fncPt)()      = nullptr;
-    CmKernelEmu *kernel  = NULL;
-    //GfxEmu::KernelArg *     pArg    = nullptr;
     uint32_t     threadSpaceWidth = -1, threadSpaceHeight = -1, threadSpaceDepth = -1,
         groupSpaceWidth = -1, groupSpaceHeight = -1, groupSpaceDepth = -1;
 
@@ -395,7 +431,16 @@ CM_RT_API int32_t CmQueueEmu::EnqueueWithGroup(
         return CM_EXCEED_MAX_KERNEL_PER_ENQUEUE;
     }
 
-    CLock locker(m_CriticalSection_Tasks);
+    // Group spaces are resolved on enqueue: the ones associated with kernels
+    // by Enqueue are dissociated right after this call returns.
+    struct GroupLaunch
+    {
+        CmKernelEmu *         kernel;
+        std::vector<uint32_t> groupDims, threadDims;
+    };
+    std::vector<GroupLaunch>   launches;
+    std::vector<CmKernelEmu *> kernels;
+    std::vector<KernelSpace>   spaces;
 
     for (uint32_t i = 0; i < kernelCount; i++)
     {
@@ -418,13 +463,9 @@ CM_RT_API int32_t CmQueueEmu::EnqueueWithGroup(
             threadSpaceWidth, threadSpaceHeight, threadSpaceDepth,
             groupSpaceWidth, groupSpaceHeight, groupSpaceDepth);
 
-        uint32_t numMaxArgs = 0;
         uint32_t threadArgCount = 0;
 
         kernel->GetThreadArgCount(threadArgCount);
-        //kernel->GetArgs(pArg);
-        kernel->GetMaxArgCount(numMaxArgs);
-        fncPt = (void (*)())kernel->GetFuncPnt();
 
         if (threadArgCount)
         {
@@ -433,44 +474,58 @@ CM_RT_API int32_t CmQueueEmu::EnqueueWithGroup(
             return CM_THREAD_ARG_NOT_ALLOWED;
         }
 
-        m_pDevice->DoGPUCopySelect(); // Selectively copies from SRC to volatile buffer for SM and UP surfaces/buffers
-
-        if (!cmrt::CmEmuMt_Kernel {
+        launches.push_back({kernel,
             {groupSpaceWidth, groupSpaceHeight, groupSpaceDepth},
-            {threadSpaceWidth, threadSpaceHeight, threadSpaceDepth},
-            m_ResidentGroupNum,
-            m_ParallelThreadNum,
-            cmrt::CmEmu_KernelLauncher {
-                kernel->GetName (),
-                kernel->GetProgramModule (),
-                kernel->GetArgsVecRef (),
-                cmrt::CmEmu_KernelLauncher::kThreadIdUnset,
-                reinterpret_cast<void(*)()> (const_cast<void*>(kernel->GetFuncPnt ()))
-            }}.run ())
-        {
-            GFX_EMU_ERROR_MESSAGE("Kernel group execution timeout.");
-            return CM_FAILURE;
-        }
-
-        m_pDevice->DoCopyAll();
+            {threadSpaceWidth, threadSpaceHeight, threadSpaceDepth}});
+        kernels.push_back(kernel);
+        spaces.push_back({threadSpaceWidth, threadSpaceHeight, groupSpaceWidth, groupSpaceHeight});
     }
 
-    //End_of_enqueue:
-    if (pEvent != INVISIBLE_EVENT_MAGIC_NUM)
-    {
-        CmEventEmu *pTmp = nullptr;
-        if (CmEventEmu::Create(m_EventCount, pTmp) == CM_SUCCESS)
+    const auto residentGroupNum = m_ResidentGroupNum, parallelThreadNum = m_ParallelThreadNum;
+    const auto result = Submit(kernels, spaces, [this, launches, residentGroupNum, parallelThreadNum] (CmEventEmu *event) -> int32_t {
+        CLock locker(m_CriticalSection_Tasks);
+
+        for (uint32_t i = 0; i < launches.size(); i++)
         {
-            m_EventArray.SetElement(m_EventCount, pTmp);
-            m_EventCount++;
-            pEvent = static_cast<CmEvent *>(pTmp);
+            const auto& launch = launches[i];
+            const auto  kernel = launch.kernel;
+            const auto  start  = CmEventEmu::Now();
+
+            m_pDevice->DoGPUCopySelect(); // Selectively copies from SRC to volatile buffer for SM and UP surfaces/buffers
+
+            if (!cmrt::CmEmuMt_Kernel {
+                launch.groupDims,
+                launch.threadDims,
+                residentGroupNum,
+                parallelThreadNum,
+                cmrt::CmEmu_KernelLauncher {
+                    kernel->GetName (),
+                    kernel->GetProgramModule (),
+                    GetTaskArgs(*kernel),
+                    cmrt::CmEmu_KernelLauncher::kThreadIdUnset,
+                    reinterpret_cast<void(*)()> (const_cast<void*>(kernel->GetFuncPnt ()))
+                }}.run ())
+            {
+                GFX_EMU_ERROR_MESSAGE("Kernel group execution timeout.");
+                return CM_FAILURE;
+            }
+
+            m_pDevice->DoCopyAll();
+
+            if (event)
+            {
+                event->SetKernelTimes(i, start, CmEventEmu::Now());
+            }
         }
-    }
-    else
+
+        return CM_SUCCESS;
+    }, pEvent);
+
+    if (result != CM_SUCCESS)
     {
-        // if the input pEvent equals to INVISIBLE_EVENT_MAGIC_NUM, event will not be created.
-        pEvent = nullptr;
+        return result;
     }
+
 #ifdef GFX_EMU_DEBUG_ENABLED
     //////////////////////////////////////////////////////////////////////////////////////
     if (CmStatistics::Get() != nullptr)
@@ -482,16 +537,226 @@ CM_RT_API int32_t CmQueueEmu::EnqueueWithGroup(
     return CM_SUCCESS;
 }
 
+//*-----------------------------------------------------------------------------
+//| Purpose:    Create the event of an enqueued operation, unless the caller
+//|             asked for none with INVISIBLE_EVENT_MAGIC_NUM.
+//| Returns:    The event created or nullptr.
+//*-----------------------------------------------------------------------------
+CmEventEmu *CmQueueEmu::NewEvent(CmEvent *&pEvent)
+{
+    if (pEvent == INVISIBLE_EVENT_MAGIC_NUM)
+    {
+        // if the input pEvent equals to INVISIBLE_EVENT_MAGIC_NUM, event will not be created.
+        pEvent = nullptr;
+        return nullptr;
+    }
+
+    CmEventEmu *pTmp = nullptr;
+    if (CmEventEmu::Create(m_EventCount, pTmp) == CM_SUCCESS)
+    {
+        m_EventArray.SetElement(m_EventCount, pTmp);
+        m_EventCount++;
+        pEvent = static_cast<CmEvent *>(pTmp);
+    }
+    return pTmp;
+}
+
+//*-----------------------------------------------------------------------------
+//| Purpose:    Run a task of the given kernels, or queue it for the executor
+//|             thread in asynchronous mode. In the latter case kernel
+//|             arguments are captured, so that the host is free to change
+//|             them right after enqueue. Kernels are registered with the
+//|             event for profiling along with their thread spaces.
+//| Returns:    Result of the task run or of queuing it.
+//*-----------------------------------------------------------------------------
+int32_t CmQueueEmu::Submit(
+    const std::vector<CmKernelEmu *>&   kernels,
+    const std::vector<KernelSpace>&     spaces,
+    std::function<int32_t(CmEventEmu*)> run,
+    CmEvent *&                          pEvent)
+{
+    const auto failure = TakeAsyncFailure();
+    if (failure != CM_SUCCESS)
+    {
+        pEvent = nullptr;
+        return failure;
+    }
+
+    auto event = NewEvent(pEvent);
+    if (event)
+    {
+        for (size_t i = 0; i < kernels.size(); i++)
+        {
+            event->AddKernel(kernels[i]->GetName(), spaces[i].data());
+        }
+        event->SetStatus(CM_STATUS_QUEUED);
+    }
+
+    if (!m_Async)
+    {
+        const auto result = RunTask(run, event);
+        if (result != CM_SUCCESS && event)
+        {
+            // No event is returned for a task that failed to run.
+            CmEvent *failed = event;
+            DestroyEvent(failed);
+            pEvent = nullptr;
+        }
+        return result;
+    }
+
+    PendingTask task {std::move(run), {}, event};
+    for (auto kernel: kernels)
+    {
+        auto& args = task.args[kernel];
+        if (!args.empty()) continue;
+        for (const auto& arg: kernel->GetArgsVecRef())
+            args.push_back(arg.clone());
+    }
+
+    if (task.event)
+    {
+        task.event->Acquire();
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(m_ExecutorMutex);
+        m_PendingTasks.push_back(std::move(task));
+    }
+    m_ExecutorCondition.notify_all();
+
+    return CM_SUCCESS;
+}
+
+//*-----------------------------------------------------------------------------
+//| Purpose:    Run a task, moving its event through the started and finished
+//|             states and recording the execution time of the task.
+//| Returns:    Result of the task run.
+//*-----------------------------------------------------------------------------
+int32_t CmQueueEmu::RunTask(const std::function<int32_t(CmEventEmu*)>& run, CmEventEmu* event)
+{
+    if (!event)
+    {
+        return run(nullptr);
+    }
+
+    event->SetStatus(CM_STATUS_STARTED);
+    event->SetTime(CM_EVENT_PROFILING_HWSTART, CmEventEmu::Now());
+    const auto result = run(event);
+    event->SetTime(CM_EVENT_PROFILING_HWEND, CmEventEmu::Now());
+    event->SetResult(result);
+    event->SetStatus(CM_STATUS_FINISHED);
+    return result;
+}
+
+void CmQueueEmu::ExecutorLoop(void)
+{
+    std::unique_lock<std::mutex> lk(m_ExecutorMutex);
+    for (;;)
+    {
+        m_ExecutorCondition.wait(lk, [this] { return m_ExecutorStop || !m_PendingTasks.empty(); });
+        if (m_PendingTasks.empty())
+        {
+            return;
+        }
+
+        auto task = std::move(m_PendingTasks.front());
+        m_PendingTasks.pop_front();
+        m_ExecutorBusy = true;
+        lk.unlock();
+
+        m_TaskArgs = std::move(task.args);
+        const auto result = RunTask(task.run, task.event);
+        if (result != CM_SUCCESS)
+        {
+            GFX_EMU_ERROR_MESSAGE("Asynchronously enqueued task failed.\n");
+        }
+        m_TaskArgs.clear();
+
+        if (task.event)
+        {
+            task.event->SafeRelease();
+        }
+
+        lk.lock();
+        if (result != CM_SUCCESS && m_AsyncFailure == CM_SUCCESS)
+        {
+            m_AsyncFailure = result;
+        }
+        m_ExecutorBusy = false;
+        m_ExecutorCondition.notify_all();
+    }
+}
+
+//*-----------------------------------------------------------------------------
+//| Purpose:    Block until all the tasks queued so far are finished, so that
+//|             operations run synchronously keep the queue order.
+//*-----------------------------------------------------------------------------
+void CmQueueEmu::WaitForQueuedTasks(void)
+{
+    if (!m_Async)
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lk(m_ExecutorMutex);
+    m_ExecutorCondition.wait(lk, [this] { return m_PendingTasks.empty() && !m_ExecutorBusy; });
+}
+
+//*-----------------------------------------------------------------------------
+//| Purpose:    Block until all the tasks queued so far are finished, before
+//|             an operation run synchronously.
+//| Returns:    The first failure of a queued task not returned yet, as the
+//|             operation would have returned it in synchronous mode.
+//*-----------------------------------------------------------------------------
+int32_t CmQueueEmu::FinishQueuedTasks(void)
+{
+    WaitForQueuedTasks();
+    return TakeAsyncFailure();
+}
+
+//*-----------------------------------------------------------------------------
+//| Purpose:    Hand the first failure of a queued task over to the caller,
+//|             so that it is returned by one enqueue call only.
+//*-----------------------------------------------------------------------------
+int32_t CmQueueEmu::TakeAsyncFailure(void)
+{
+    if (!m_Async)
+    {
+        return CM_SUCCESS;
+    }
+
+    std::lock_guard<std::mutex> lk(m_ExecutorMutex);
+    const auto failure = m_AsyncFailure;
+    m_AsyncFailure = CM_SUCCESS;
+    return failure;
+}
+
+const std::vector<GfxEmu::KernelArg>& CmQueueEmu::GetTaskArgs(const CmKernelEmu& kernel) const
+{
+    const auto it = m_TaskArgs.find(&kernel);
+    return it != m_TaskArgs.end() ? it->second : kernel.GetArgsVecRef();
+}
+
 int32_t CmQueueEmu::Initialize(void)
 {
     this->m_pDevice->GetHalMaxValues(m_pMaxVhalVals);
 
+    if (m_Async)
+    {
+        m_Executor = std::thread {&CmQueueEmu::ExecutorLoop, this};
+    }
+
     return CM_SUCCESS;
 }
 
 CmQueueEmu::CmQueueEmu(CmDeviceEmu *pDevice) : m_pDevice(pDevice),
                                                m_EventArray(CM_INIT_EVENT_COUNT),
-                                               m_pGPUCopyTask(nullptr)
+                                               m_pGPUCopyTask(nullptr),
+                                               m_Async(GfxEmu::Cfg::AsyncQueue().getBool()),
+                                               m_ExecutorBusy(false),
+                                               m_ExecutorStop(false),
+                                               m_AsyncFailure(CM_SUCCESS)
 {
     m_EventCount = 0;
     m_ResidentGroupNum  = 1;
@@ -502,6 +767,16 @@ CmQueueEmu::CmQueueEmu(CmDeviceEmu *pDevice) : m_pDevice(pDevice),
 
 CmQueueEmu::~CmQueueEmu(void)
 {
+    if (m_Executor.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lk(m_ExecutorMutex);
+            m_ExecutorStop = true;
+        }
+        m_ExecutorCondition.notify_all();
+        m_Executor.join(); // Runs the queued tasks first.
+    }
+
     for (int i = 0; i < m_EventCount; i++)
     {
         CmEventEmu *pEvent = (CmEventEmu *)m_EventArray.GetElement(i);
@@ -515,6 +790,12 @@ CmQueueEmu::~CmQueueEmu(void)
 
 CM_RT_API int32_t CmQueueEmu::EnqueueCopyCPUToGPU(CmSurface2D *pSurface, const unsigned char *pSysMem, CmEvent *&pEvent)
 {
+    const int32_t queued = FinishQueuedTasks();
+    if (queued != CM_SUCCESS)
+    {
+        return queued;
+    }
+
     int32_t     ret  = CM_FAILURE;
     CmEventEmu *pTmp = nullptr;
 
@@ -546,6 +827,12 @@ CM_RT_API int32_t CmQueueEmu::EnqueueCopyCPUToGPU(CmSurface2D *pSurface, const u
 
 CM_RT_API int32_t CmQueueEmu::EnqueueCopyGPUToCPU(CmSurface2D *pSurface, unsigned char *pSysMem, CmEvent *&pEvent)
 {
+    const int32_t queued = FinishQueuedTasks();
+    if (queued != CM_SUCCESS)
+    {
+        return queued;
+    }
+
     int32_t     ret  = CM_FAILURE;
     CmEventEmu *pTmp = nullptr;
 
@@ -579,20 +866,36 @@ CM_RT_API int32_t CmQueueEmu::EnqueueCopyGPUToCPU(CmSurface2D *pSurface, unsigne
     return ret;
 }
 
-int32_t CmQueueEmu::Execute(const CmKernelEmu& kernel, uint32_t threadId)
+//*-----------------------------------------------------------------------------
+//| Purpose:    Run media objects of a kernel as one launch. Every object is a
+//|             work-group of its own, so the objects run in parallel on the
+//|             worker pool. Objects depending on each other must be run by
+//|             separate calls, in their dependency order.
+//| Returns:    Result of the launch.
+//*-----------------------------------------------------------------------------
+int32_t CmQueueEmu::Execute(const CmKernelEmu& kernel, MediaWorkItems items)
 {
+    if (items.empty())
+    {
+        return CM_SUCCESS;
+    }
+
+    const auto objectCount = static_cast<uint32_t>(items.size());
+    cmrt::CmEmu_KernelLauncher launcher {
+        kernel.GetName (),
+        kernel.GetProgramModule (),
+        GetTaskArgs(kernel),
+        cmrt::CmEmu_KernelLauncher::kThreadIdUnset,
+        reinterpret_cast<void(*)()> (const_cast<void*>(kernel.GetFuncPnt ()))
+    };
+    launcher.set_media_work_items(std::move(items));
+
     if (!cmrt::CmEmuMt_Kernel {
+        {objectCount,1,1},
         {1,1,1},
-        {1,1,1},
-        1,
-        1,
-        cmrt::CmEmu_KernelLauncher{
-            kernel.GetName (),
-            kernel.GetProgramModule (),
-            kernel.GetArgsVecRef (),
-            threadId,
-            reinterpret_cast<void(*)()> (const_cast<void*>(kernel.GetFuncPnt ()))
-        }}.run()
+        std::min(objectCount, m_ParallelThreadNum),
+        m_ParallelThreadNum,
+        std::move(launcher)}.run()
     ) {
         GFX_EMU_ERROR_MESSAGE("Kernel execution timeout.");
         return CM_FAILURE;
@@ -601,6 +904,91 @@ int32_t CmQueueEmu::Execute(const CmKernelEmu& kernel, uint32_t threadId)
         return CM_SUCCESS;
 }
 
+//*-----------------------------------------------------------------------------
+//| Purpose:    Run media objects of a thread space given in their serial
+//|             dispatch order. An object waits only for the objects of its
+//|             dependency neighbors dispatched before it, so the objects are
+//|             split into wavefronts of mutually independent objects, each
+//|             run as a parallel launch. Dependent objects keep their serial
+//|             order, so the results are the ones of the serial dispatch.
+//|             Colors of a unit are independent of each other.
+//| Returns:    Result of the first failed launch or CM_SUCCESS.
+//*-----------------------------------------------------------------------------
+int32_t CmQueueEmu::ExecuteMediaObjects(CmThreadSpaceEmu *threadSpace, const MediaObjects &objects)
+{
+    uint32_t       width       = 0;
+    uint32_t       height      = 0;
+    CM_DEPENDENCY *pDependency = nullptr;
+
+    threadSpace->GetThreadSpaceSize(width, height);
+    threadSpace->GetDependency(pDependency);
+
+    // Wavefront of each unit dispatched so far, -1 for the others.
+    std::vector<int32_t>                          unitWavefronts(width * height, -1);
+    std::vector<std::vector<const MediaObject *>> wavefronts;
+
+    for (const auto &object: objects)
+    {
+        auto &wavefront = unitWavefronts[object.unit];
+        if (wavefront < 0)
+        {
+            const int32_t x = object.unit % width;
+            const int32_t y = object.unit / width;
+
+            wavefront = 0;
+            for (uint32_t i = 0; pDependency && i < pDependency->count; i++)
+            {
+                //checking for valid dependency
+                if (pDependency->deltaX[i] == 0 && pDependency->deltaY[i] == 0)
+                    continue;
+
+                const int32_t xCoord = x + pDependency->deltaX[i];
+                const int32_t yCoord = y + pDependency->deltaY[i];
+
+                //checking for valid coordinates
+                if (xCoord < 0 || xCoord >= (int32_t)width ||
+                    yCoord < 0 || yCoord >= (int32_t)height)
+                    continue;
+
+                wavefront = std::max(wavefront, unitWavefronts[yCoord * width + xCoord] + 1);
+            }
+
+            if (wavefronts.size() <= (size_t)wavefront)
+            {
+                wavefronts.resize(wavefront + 1);
+            }
+        }
+        wavefronts[wavefront].push_back(&object);
+    }
+
+    for (const auto &wavefront: wavefronts)
+    {
+        // Objects of different kernels in a wavefront run one launch after another.
+        std::vector<std::pair<const CmKernelEmu *, MediaWorkItems>> launches;
+        for (auto object: wavefront)
+        {
+            auto launch = std::find_if(launches.begin(), launches.end(),
+                [object] (const auto &l) { return l.first == object->kernel; });
+            if (launch == launches.end())
+            {
+                launch = launches.emplace(launches.end(), object->kernel, MediaWorkItems {});
+            }
+            launch->second.push_back(object->item);
+        }
+
+        for (auto &launch: launches)
+        {
+            const auto result = Execute(*launch.first, std::move(launch.second));
+            if (result != CM_SUCCESS)
+            {
+                return result;
+            }
+        }
+    }
+
+    return CM_SUCCESS;
+}
+
 int32_t CmQueueEmu::ExecuteScoreBoard(CmThreadSpaceEmu *threadSpace, bool be_walker)
 {
     CM_THREAD_SPACE_UNIT *pThreadSpaceUnit = nullptr;
@@ -651,10 +1039,7 @@ int32_t CmQueueEmu::ExecuteScoreBoard(CmThreadSpaceEmu *threadSpace, bool be_wal
                 //kernel->GetArgs(pArg);
                 kernel->GetMaxArgCount(numMaxArgs);
 
-                set_thread_origin_x(x);
-                set_thread_origin_y(y);
-
-                Execute(*kernel, pThreadSpaceUnit[y * width + x].threadId);
+                Execute(*kernel, {{pThreadSpaceUnit[y * width + x].threadId, (uint16_t)x, (uint16_t)y, 0}});
                 pThreadSpaceUnit[y * width + x].numEdges--;
                 numExecuted++;
 
@@ -696,7 +1081,8 @@ int32_t CmQueueEmu::ExecuteScoreBoard26Z(CmThreadSpaceEmu *threadSpace)
     uint32_t  x                            = 0;
     uint32_t  y                            = 0;
     uint32_t  index                        = 0;
-    uint32_t *pBoardOrder                  = nullptr;
+    const uint32_t *pBoardOrder            = nullptr;
+    MediaObjects objects;
 
     if (!threadSpace)
     {
@@ -714,7 +1100,7 @@ int32_t CmQueueEmu::ExecuteScoreBoard26Z(CmThreadSpaceEmu *threadSpace)
     }
 
     // Generate Wavefront26Z sequence
-    result = threadSpace->Wavefront26ZSequence();
+    result = threadSpace->GenerateBoardOrder();
     if (result != CM_SUCCESS)
     {
         GFX_EMU_ASSERT(0);
@@ -751,12 +1137,11 @@ int32_t CmQueueEmu::ExecuteScoreBoard26Z(CmThreadSpaceEmu *threadSpace)
         //kernel->GetArgs(pArg);
         kernel->GetMaxArgCount(numMaxArgs);
 
-        set_thread_origin_x(x);
-        set_thread_origin_y(y);
-
-        Execute(*kernel, pThreadSpaceUnit[index].threadId);
+        objects.push_back({index, kernel, {pThreadSpaceUnit[index].threadId, (uint16_t)x, (uint16_t)y, 0}});
     }
 
+    result = ExecuteMediaObjects(threadSpace, objects);
+
 finish:
     return result;
 }
@@ -773,7 +1158,8 @@ int32_t CmQueueEmu::ExecuteScoreBoard26ZI(CmThreadSpaceEmu *threadSpace)
     uint32_t  x                            = 0;
     uint32_t  y                            = 0;
     uint32_t  index                        = 0;
-    uint32_t *pBoardOrder                  = nullptr;
+    const uint32_t *pBoardOrder            = nullptr;
+    MediaObjects objects;
 
     if (!threadSpace)
     {
@@ -790,27 +1176,8 @@ int32_t CmQueueEmu::ExecuteScoreBoard26ZI(CmThreadSpaceEmu *threadSpace)
         goto finish;
     }
 
-    // Generate Wavefront26ZI sequence
-    CM_26ZI_DISPATCH_PATTERN pattern;
-    threadSpace->Get26ZIDispatchPattern(pattern);
-    switch (pattern)
-    {
-    case VVERTICAL_HVERTICAL_26:
-        result = threadSpace->Wavefront26ZISeqVVHV26();
-        break;
-    case VVERTICAL_HHORIZONTAL_26:
-        result = threadSpace->Wavefront26ZISeqVVHH26();
-        break;
-    case VVERTICAL26_HHORIZONTAL26:
-        result = threadSpace->Wavefront26ZISeqVV26HH26();
-        break;
-    case VVERTICAL1X26_HHORIZONTAL1X26:
-        result = threadSpace->Wavefront26ZISeqVV1x26HH1x26();
-        break;
-    default:
-        result = threadSpace->Wavefront26ZISeqVVHV26();
-        break;
-    }
+    // Generate Wavefront26ZI sequence of the 26ZI dispatch pattern selected
+    result = threadSpace->GenerateBoardOrder();
 
     if (result != CM_SUCCESS)
     {
@@ -848,12 +1215,11 @@ int32_t CmQueueEmu::ExecuteScoreBoard26ZI(CmThreadSpaceEmu *threadSpace)
         //kernel->GetArgs(pArg);
         kernel->GetMaxArgCount(numMaxArgs);
 
-        set_thread_origin_x(x);
-        set_thread_origin_y(y);
-
-        Execute(*kernel, pThreadSpaceUnit[index].threadId);
+        objects.push_back({index, kernel, {pThreadSpaceUnit[index].threadId, (uint16_t)x, (uint16_t)y, 0}});
     }
 
+    result = ExecuteMediaObjects(threadSpace, objects);
+
 finish:
     return result;
 }
@@ -900,6 +1266,8 @@ int32_t CmQueueEmu::ExecuteScoreBoard_1(CmThreadSpaceEmu *threadSpace, bool be_w
     int block_size_x = 0, block_size_y = 0;
     int x, y;
 
+    MediaObjects objects; // In the walking pattern order.
+
     if (threadSpace == nullptr)
     {
         GFX_EMU_ASSERT(0);
@@ -1252,13 +1620,10 @@ int32_t CmQueueEmu::ExecuteScoreBoard_1(CmThreadSpaceEmu *threadSpace, bool be_w
                         //kernel->GetArgs(pArg);
                         kernel->GetMaxArgCount(numMaxArgs);
 
-                        set_thread_origin_x(x);
-                        set_thread_origin_y(y);
                         for (uint32_t c = 0; c < colorCount; ++c)
                         {
-                            set_color(c);
-
-                            Execute(*kernel, pThreadSpaceUnit[y * width + x].threadId);
+                            objects.push_back({(uint32_t)(y * width + x), kernel,
+                                {pThreadSpaceUnit[y * width + x].threadId, (uint16_t)x, (uint16_t)y, (uint16_t)c}});
                             numExecuted++;
                         }
 
@@ -1297,14 +1662,22 @@ int32_t CmQueueEmu::ExecuteScoreBoard_1(CmThreadSpaceEmu *threadSpace, bool be_w
         }
     }
 
+    result = ExecuteMediaObjects(threadSpace, objects);
+
 finish:
     return result;
 }
 
 CM_RT_API int32_t CmQueueEmu::EnqueueInitSurface2D(CmSurface2D *pSurface, const uint32_t initValue, CmEvent *&pEvent)
 {
+    const int32_t queued = FinishQueuedTasks();
+    if (queued != CM_SUCCESS)
+    {
+        return queued;
+    }
+
     int32_t ret = CM_FAILURE;
-    ret         = pSurface->InitSurface(initValue, pEvent);
+    ret         = pSurface->InitSurface(initValue, nullptr);
 
     if (ret != CM_SUCCESS)
     {
@@ -1335,6 +1708,12 @@ CM_RT_API int32_t CmQueueEmu::EnqueueInitSurface2D(CmSurface2D *pSurface, const
 
 CM_RT_API int32_t CmQueueEmu::EnqueueCopyGPUToGPU(CmSurface2D *pOutputSurface, CmSurface2D *pInputSurface, uint32_t option, CmEvent *&pEvent)
 {
+    const int32_t queued = FinishQueuedTasks();
+    if (queued != CM_SUCCESS)
+    {
+        return queued;
+    }
+
     int32_t     ret  = CM_FAILURE;
     CmEventEmu *pTmp = nullptr;
 
@@ -1366,8 +1745,10 @@ CM_RT_API int32_t CmQueueEmu::EnqueueCopyGPUToGPU(CmSurface2D *pOutputSurface, C
         return CM_GPUCOPY_INVALID_SURFACES;
     }
 
-    void *Dstbuffer = pDstSurf2D->getBuffer();
-    pInputSurface->ReadSurface((unsigned char *)Dstbuffer, nullptr);
+    // Surfaces of the same size and format have the same layout, the padding
+    // and the NV12 UV plane included, so this is one linear copy.
+    CmHostMemCopy(pDstSurf2D->getBuffer(), pSrcSurf2D->getBuffer(), DstSurfaceWidth * DstSurfaceHeight);
+    pDstSurf2D->DoGPUCopy();
 
     if (pEvent != INVISIBLE_EVENT_MAGIC_NUM)
     {
@@ -1394,6 +1775,12 @@ CM_RT_API int32_t CmQueueEmu::EnqueueCopyGPUToGPU(CmSurface2D *pOutputSurface, C
 #define BYTE_COPY_ONE_THREAD 1024  //1K for each thread
 CM_RT_API int32_t CmQueueEmu::EnqueueCopyCPUToCPU(unsigned char *pDstSysMem, unsigned char *pSrcSysMem, uint32_t size, uint32_t option, CmEvent *&pEvent)
 {
+    const int32_t queued = FinishQueuedTasks();
+    if (queued != CM_SUCCESS)
+    {
+        return queued;
+    }
+
     int         result              = CM_SUCCESS;
     CmEventEmu *pTmp                = nullptr;
     size_t      InputLinearAddress  = (size_t)pSrcSysMem;
@@ -1430,7 +1817,7 @@ CM_RT_API int32_t CmQueueEmu::EnqueueCopyCPUToCPU(unsigned char *pDstSysMem, uns
         return CM_GPUCOPY_INVALID_SIZE;
     }
 
-    CmFastMemCopy(pDstSysMem, pSrcSysMem, size);  //SSE copy used in CMRT.
+    CmHostMemCopy(pDstSysMem, pSrcSysMem, size);
 
     if (size >= BYTE_COPY_ONE_THREAD &&
         pEvent != INVISIBLE_EVENT_MAGIC_NUM)
@@ -8,6 +8,17 @@ SPDX-License-Identifier: MIT
 
 #pragma once
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <array>
+#include <functional>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+
+#include "emu_kernel_arg.h"
+#include "rt.h"
 #include "cm_array.h"
 #include "cm_def.h"
 #include "cm_kernel_base.h"
@@ -31,6 +42,8 @@ class CmThreadGroupSpace;
 //! Each kernel can run in multiple threads concurrently. It is a in-order queue.
 //! Tasks get executed according to the order they get enqueued. The next task
 //! doesn't start execute until the current task finishs.
+//! With CM_RT_ASYNC_QUEUE tasks are run by the queue executor thread and
+//! enqueue calls return right after queuing them.
 //!
 class CmQueueEmu : public CmQueue
 {
@@ -106,6 +119,7 @@ public:
                             CmThreadSpaceEmu *threadSpace);
     void SetDeviceTileID(int32_t deviceTileID) { m_deviceTileID = deviceTileID; }
     CM_QUEUE_TYPE Type() { return m_type; }
+    void WaitForQueuedTasks(void);
 
 protected:
     CmQueueEmu( CmDeviceEmu* pDevice );
@@ -113,7 +127,17 @@ protected:
 
     int32_t Initialize( void );
 
-    int32_t Execute(const CmKernelEmu&, uint32_t threadId);
+    using MediaWorkItems = std::vector<cmrt::CmEmu_MediaWorkItem>;
+    int32_t Execute(const CmKernelEmu&, MediaWorkItems items);
+
+    struct MediaObject
+    {
+        uint32_t                  unit; // Index of the thread space unit.
+        const CmKernelEmu *       kernel;
+        cmrt::CmEmu_MediaWorkItem item;
+    };
+    using MediaObjects = std::vector<MediaObject>;
+    int32_t ExecuteMediaObjects(CmThreadSpaceEmu * threadSpace, const MediaObjects &objects);
     int32_t ExecuteScoreBoard(CmThreadSpaceEmu * threadSpace, bool be_walker);
     bool inner_loop_iteration(int last_x, int last_y, int bound_x, int bound_y, int x_stride, int y_stride, int &x, int &y);
     bool outer_loop_iteration(int last_x, int last_y,
@@ -129,6 +153,26 @@ protected:
     int32_t ExecuteScoreBoard_1(CmThreadSpaceEmu * threadSpace, bool be_walker);
 
     int32_t Enqueue_preG12(CmTask *pKernelArray, CmEvent *&pEvent, const CmThreadSpace *pTS = nullptr);
+
+    using TaskArgs = std::unordered_map<const CmKernelEmu*, std::vector<GfxEmu::KernelArg>>;
+    struct PendingTask
+    {
+        std::function<int32_t(CmEventEmu*)> run;
+        TaskArgs                            args;  // Kernel arguments captured on enqueue.
+        CmEventEmu*                         event; // Referenced until the task is finished.
+    };
+    // Thread space width, height and group space width, height of a kernel, for profiling.
+    using KernelSpace = std::array<uint32_t, 4>;
+
+    CmEventEmu* NewEvent(CmEvent *&pEvent);
+    int32_t Submit(const std::vector<CmKernelEmu*>& kernels, const std::vector<KernelSpace>& spaces,
+        std::function<int32_t(CmEventEmu*)> run, CmEvent *&pEvent);
+    static int32_t RunTask(const std::function<int32_t(CmEventEmu*)>& run, CmEventEmu* event);
+    void ExecutorLoop(void);
+    int32_t FinishQueuedTasks(void);
+    int32_t TakeAsyncFailure(void);
+    const std::vector<GfxEmu::KernelArg>& GetTaskArgs(const CmKernelEmu& kernel) const;
+
     int m_EventCount;
     CmDeviceEmu* m_pDevice;
 
@@ -145,4 +189,14 @@ protected:
     uint32_t m_ResidentGroupNum;
     uint32_t m_ParallelThreadNum;
     int m_deviceTileID; // if it is >= 0, it is multiTile
+
+    bool m_Async;
+    std::thread m_Executor;
+    std::mutex m_ExecutorMutex;
+    std::condition_variable m_ExecutorCondition;
+    std::deque<PendingTask> m_PendingTasks;
+    bool m_ExecutorBusy;
+    bool m_ExecutorStop;
+    int32_t m_AsyncFailure; // First queued task failure not yet returned by an enqueue call.
+    TaskArgs m_TaskArgs; // Arguments of the task being run by the executor.
 };
@@ -8,6 +8,7 @@ SPDX-License-Identifier: MIT
 
 #include "cm_include.h"
 #include "cm_surface_2d_emumode.h"
+#include "cm_event_base.h"
 #include "cm_surface_manager_emumode.h"
 #include "cm.h"
 #include "cm_mem_fast_copy.h"
@@ -81,13 +82,12 @@ int32_t CmSurface2DEmu::Initialize( uint32_t index, void* &pSysMem, bool dummySu
         this->alloc_dummy = false;
     }else
     {
-        m_buffer = malloc(m_width * m_height);
+        m_buffer = AllocBuffer(m_width * m_height);
         if(m_buffer == nullptr)
         {
             GFX_EMU_ASSERT( 0 );
             return CM_OUT_OF_HOST_MEMORY;
         }
-        CmSafeMemSet( m_buffer, 0, m_width * m_height );
         this->alloc_dummy = true;
         pSysMem = m_buffer;
     }
@@ -144,19 +144,9 @@ int32_t CmSurface2DEmu::RegisterSurface(uint32_t index)
         //    this->m_width, GetCpuInstructionLevel());
 
         //UV plane
-        CmEmulSys::iobuffer new_buff;
-
-        new_buff.id = index+GENX_SURFACE_UV_PLANE;
-        new_buff.bclass = GEN4_INPUT_OUTPUT_BUFFER;
-        new_buff.pixelFormat = R16_UNORM;
-        new_buff.p = (char *)m_buffer + m_width * buff_iter->height;
-        new_buff.width = m_width;
-        new_buff.height = m_height - buff_iter->height;
-        new_buff.depth = 1;
-        new_buff.pitch = m_width;
-
-        new_buff.p_volatile = (char *) buff_iter->p_volatile + m_width * buff_iter->height;
-        CmEmulSys::iobuffers.add(new_buff);
+        CM_register_buffer_emu(SurfaceIndex(index + GENX_SURFACE_UV_PLANE), GEN4_INPUT_OUTPUT_BUFFER,
+            (char *)m_buffer + m_width * buff_iter->height, m_width, m_height - buff_iter->height,
+            R16_UNORM, 1, m_width);
 
 #endif
         m_nBuffUsed=2;
@@ -192,6 +182,7 @@ int32_t CmSurface2DEmu::SetD3DSurface(IDirect3DSurface9 *pD3DSurf)
     D3DSURFACE_DESC desc;
     HRESULT hRes = pD3DSurf->GetDesc( &desc );
     this->m_pD3DSurf = pD3DSurf;
+    m_surfaceManager->AddToSyncSurfaces(this);
     D3DLOCKED_RECT rect;
     hRes = m_pD3DSurf->LockRect( &rect, nullptr, D3DLOCK_READONLY );
     if( hRes != D3D_OK )
@@ -271,6 +262,11 @@ int32_t CmSurface2DEmu::Create( uint32_t index, uint32_t sizePerPixel, uint32_t
 
 CM_RT_API int32_t CmSurface2DEmu::WriteSurface( const unsigned char* pSysMem, CmEvent* pEvent, uint64_t sysMemSize )
 {
+    if (pEvent)
+    {
+        pEvent->WaitForTaskFinished();
+    }
+
     int index=0;
 
     if(pSysMem == nullptr)
@@ -285,17 +281,8 @@ CM_RT_API int32_t CmSurface2DEmu::WriteSurface( const unsigned char* pSysMem, Cm
         return CM_INVALID_ARG_VALUE;
     }
 
-    unsigned char* temp_buffer=(unsigned char*)m_buffer;
-    if(m_width != m_OriginalWidth)
-    {
-        for (uint32_t i=0; i < this->m_height; i++)
-        {
-            CmSafeMemCopy( temp_buffer, pSysMem, this->m_OriginalWidth );
-            temp_buffer += m_width;
-            pSysMem += this->m_OriginalWidth;
-        }
-    }else
-    CmSafeMemCopy( this->m_buffer, pSysMem, this->m_height*this->m_width );
+    CmHostMemCopy2D( this->m_buffer, this->m_width, pSysMem, this->m_OriginalWidth,
+                     this->m_OriginalWidth, this->m_height );
 
 #if defined(_WIN32)
 #ifdef CM_DX9
@@ -360,6 +347,11 @@ CM_RT_API int32_t CmSurface2DEmu::WriteSurface( const unsigned char* pSysMem, Cm
 
 CM_RT_API int32_t CmSurface2DEmu::ReadSurface( unsigned char* pSysMem , CmEvent* pEvent, uint64_t sysMemSize )
 {
+    if (pEvent)
+    {
+        pEvent->WaitForTaskFinished();
+    }
+
     int index=0;
 
     if(pSysMem == nullptr)
@@ -374,17 +366,8 @@ CM_RT_API int32_t CmSurface2DEmu::ReadSurface( unsigned char* pSysMem , CmEvent*
         return CM_INVALID_ARG_VALUE;
     }
 
-    unsigned char* temp_buffer=(unsigned char*)m_buffer;
-    if(m_width != m_OriginalWidth)
-    {
-        for (uint32_t i=0; i < this->m_height; i++)
-        {
-            CmSafeMemCopy( pSysMem, temp_buffer,  this->m_OriginalWidth );
-            temp_buffer += m_width;
-            pSysMem += this->m_OriginalWidth;
-        }
-    }else
-        CmFastMemCopyFromWC(pSysMem, this->m_buffer, this->m_height*this->m_width, GetCpuInstructionLevel());
+    CmHostMemCopy2D( pSysMem, this->m_OriginalWidth, this->m_buffer, this->m_width,
+                     this->m_OriginalWidth, this->m_height );
 
     return CM_SUCCESS;
 }
@@ -432,8 +415,7 @@ CmSurface2DEmu::~CmSurface2DEmu(){
 #endif
        )
     {
-        cm_list<CmEmulSys::iobuffer>::iterator buff_iter = CmEmulSys::search_buffer(index + GENX_SURFACE_UV_PLANE);
-        CmEmulSys::iobuffers.remove(buff_iter);
+        CM_unregister_buffer_emu(SurfaceIndex(index + GENX_SURFACE_UV_PLANE), false);
         CM_unregister_buffer_emu(*pIndex, false);
     }else
     {
@@ -447,12 +429,17 @@ CmSurface2DEmu::~CmSurface2DEmu(){
 
     if(this->m_buffer != nullptr && this->alloc_dummy)
     {
-        free(this->m_buffer);
+        FreeBuffer();
     }
 }
 
 CM_RT_API int32_t CmSurface2DEmu::ReadSurfaceStride( unsigned char* pSysMem, CmEvent* pEvent, const uint32_t stride, uint64_t sysMemSize )
 {
+    if (pEvent)
+    {
+        pEvent->WaitForTaskFinished();
+    }
+
     int index=0;
     SurfaceIndex* pIndex;
     if(pSysMem == nullptr)
@@ -476,27 +463,19 @@ CM_RT_API int32_t CmSurface2DEmu::ReadSurfaceStride( unsigned char* pSysMem, CmE
         delete pIndex;
     }
 #endif
-    unsigned char* tempSrc = (unsigned char *)this->m_buffer;
-    if(stride != this->m_width)
-    {
-        for(unsigned int i = 0; i< this->m_height; i++)
-        {
-            CmSafeMemCopy( pSysMem, tempSrc, this->m_width );
-            tempSrc += this->m_width;
-            pSysMem += stride; //assume user knows what they are doing
-
-        }
-    }else
-    {
-        //Data should already be in m_buffer.
-        CmFastMemCopyFromWC(pSysMem, this->m_buffer, this->m_height*this->m_width, GetCpuInstructionLevel());
-    }
+    //Data should already be in m_buffer; assume user knows what they are doing with the stride.
+    CmHostMemCopy2D( pSysMem, stride, this->m_buffer, this->m_width, this->m_width, this->m_height );
 
     return CM_SUCCESS;
 }
 
 CM_RT_API int32_t CmSurface2DEmu::WriteSurfaceStride( const unsigned char* pSysMem, CmEvent* pEvent, const uint32_t stride, uint64_t sysMemSize )
 {
+    if (pEvent)
+    {
+        pEvent->WaitForTaskFinished();
+    }
+
     int index=0;
 
     if(pSysMem == nullptr)
@@ -511,21 +490,8 @@ CM_RT_API int32_t CmSurface2DEmu::WriteSurfaceStride( const unsigned char* pSysM
         return CM_INVALID_ARG_VALUE;
     }
 
-    unsigned char* tempDst = (unsigned char *)this->m_buffer;
-    if(stride != this->m_width)
-    {
-        for(unsigned int i = 0; i< this->m_height; i++)
-        {
-            CmSafeMemCopy( tempDst,  pSysMem, this->m_width );
-            tempDst += this->m_width;
-            pSysMem += stride; //assume user knows what they are doing
-
-        }
-    }else
-    {
-        //Data should already be in m_buffer.
-        CmSafeMemCopy( this->m_buffer, pSysMem, this->m_height*this->m_width );
-    }
+    //Assume user knows what they are doing with the stride.
+    CmHostMemCopy2D( this->m_buffer, this->m_width, pSysMem, stride, this->m_width, this->m_height );
 
     return DoGPUCopy();
 }
@@ -778,7 +744,7 @@ int32_t CmSurface2DEmu::setInternalBuffer(void * buffer)
 {
     if(this->alloc_dummy)
     {
-        free(m_buffer);
+        FreeBuffer();
         alloc_dummy = false;
     }
     this->m_buffer = buffer;
@@ -787,20 +753,13 @@ int32_t CmSurface2DEmu::setInternalBuffer(void * buffer)
 
 CM_RT_API int32_t CmSurface2DEmu::InitSurface(const unsigned long initValue, CmEvent* pEvent)
 {
-    unsigned char* temp_buffer=(unsigned char*)m_buffer;
-    if(m_width != m_OriginalWidth)
+    if (pEvent)
     {
-        for (uint32_t i=0; i < m_height; i++)
-        {
-            CmDwordMemSet( temp_buffer, initValue, m_OriginalWidth );
-            temp_buffer += m_width;
-        }
-    }
-    else
-    {
-        CmDwordMemSet( m_buffer, initValue, m_height*m_width );
+        pEvent->WaitForTaskFinished();
     }
 
+    CmHostMemSet32_2D( m_buffer, m_width, (uint32_t)initValue, m_OriginalWidth, m_height );
+
 #if defined(_WIN32)
 #ifdef CM_DX9
     if(this->m_pD3DSurf != nullptr)
@@ -989,6 +948,10 @@ CM_RT_API int32_t CmSurface2DEmu::SetSurfaceStateParam(SurfaceIndex *surfIndex,
     }
 
     RegisterAliasSurface(surfIndex, surfStateParam);
+    if (surfIndex)
+    {
+        m_surfaceManager->AddToSyncSurfaces(this);
+    }
 
     return CM_SUCCESS;
 }
@@ -8,6 +8,7 @@ SPDX-License-Identifier: MIT
 
 #include "cm_include.h"
 #include "cm_surface_3d_emumode.h"
+#include "cm_event_base.h"
 #include "cm.h"
 #include "cm_mem_fast_copy.h"
 #include "cm_mem.h"
@@ -20,8 +21,8 @@ extern void
     CM_unregister_buffer_emu(SurfaceIndex buf_id, bool copy);
 #endif
 
-CmSurface3DEmu::CmSurface3DEmu( uint32_t width, uint32_t height, uint32_t depth, CM_SURFACE_FORMAT osApiSurfaceFmt,CmSurfaceFormatID surfFormat , bool isCmCreated ):
-    CmSurfaceEmu(isCmCreated, nullptr)
+CmSurface3DEmu::CmSurface3DEmu( uint32_t width, uint32_t height, uint32_t depth, CM_SURFACE_FORMAT osApiSurfaceFmt,CmSurfaceFormatID surfFormat , bool isCmCreated, CmSurfaceManagerEmu* surfaceManager ):
+    CmSurfaceEmu(isCmCreated, surfaceManager)
 {
     m_width = width;
     m_height = height;
@@ -34,9 +35,13 @@ int32_t CmSurface3DEmu::Initialize( uint32_t index, uint32_t arrayIndex )
 {
     this->m_arrayIndex=arrayIndex;
     printf("%d x %d x %d\n",m_width,m_height,m_depth);
-    m_buffer = malloc(m_width * m_height*m_depth);
+    m_buffer = AllocBuffer(m_width * m_height*m_depth);
     printf("buffer: %p\n",m_buffer);
-    CmSafeMemSet( m_buffer, 0, m_width * m_height*m_depth );
+    if(m_buffer == nullptr)
+    {
+        GFX_EMU_ASSERT( 0 );
+        return CM_OUT_OF_HOST_MEMORY;
+    }
     this->alloc_dummy = true;
 
     CM_register_buffer_emu(index, GEN4_INPUT_OUTPUT_BUFFER, m_buffer, m_width, m_height, this->m_surfFormat, m_depth, 0);
@@ -108,11 +113,11 @@ int32_t CmSurface3DEmu::SetD3DSurface(CM_IDIRECT3DSURFACE *pD3DSurf)
 }
 #endif
 
-int32_t CmSurface3DEmu::Create( uint32_t index, uint32_t arrayIndex, uint32_t width, uint32_t height, uint32_t depth, CM_SURFACE_FORMAT osApiSurfaceFmt, CmSurfaceFormatID surfFormat , bool isCmCreated, CmSurface3DEmu* &pSurface )
+int32_t CmSurface3DEmu::Create( uint32_t index, uint32_t arrayIndex, uint32_t width, uint32_t height, uint32_t depth, CM_SURFACE_FORMAT osApiSurfaceFmt, CmSurfaceFormatID surfFormat , bool isCmCreated, CmSurface3DEmu* &pSurface, CmSurfaceManagerEmu* surfaceManager )
 {
     int32_t result = CM_SUCCESS;
 
-    pSurface = new CmSurface3DEmu(width, height, depth, osApiSurfaceFmt, surfFormat, isCmCreated );
+    pSurface = new CmSurface3DEmu(width, height, depth, osApiSurfaceFmt, surfFormat, isCmCreated, surfaceManager );
     if( pSurface )
     {
         result = pSurface->Initialize(index, arrayIndex);
@@ -129,6 +134,11 @@ int32_t CmSurface3DEmu::Create( uint32_t index, uint32_t arrayIndex, uint32_t wi
 
 CM_RT_API int32_t CmSurface3DEmu::WriteSurface( const unsigned char* pSysMem, CmEvent* pEvent, uint64_t sysMemSize )
 {
+    if (pEvent)
+    {
+        pEvent->WaitForTaskFinished();
+    }
+
     if(pSysMem == nullptr)
     {
         GFX_EMU_ASSERT( 0 );
@@ -141,13 +151,18 @@ CM_RT_API int32_t CmSurface3DEmu::WriteSurface( const unsigned char* pSysMem, Cm
         return CM_INVALID_ARG_VALUE;
     }
 
-    CmFastMemCopyFromWC(this->m_buffer, pSysMem, this->m_height*this->m_width*m_depth, GetCpuInstructionLevel());
+    CmHostMemCopy(this->m_buffer, pSysMem, this->m_height*this->m_width*m_depth);
 
     return CM_SUCCESS;
 }
 
 CM_RT_API int32_t CmSurface3DEmu::ReadSurface( unsigned char* pSysMem , CmEvent* pEvent, uint64_t sysMemSize )
 {
+    if (pEvent)
+    {
+        pEvent->WaitForTaskFinished();
+    }
+
     if(pSysMem == nullptr)
     {
         GFX_EMU_ASSERT( 0 );
@@ -160,7 +175,7 @@ CM_RT_API int32_t CmSurface3DEmu::ReadSurface( unsigned char* pSysMem , CmEvent*
         return CM_INVALID_ARG_VALUE;
     }
 
-    CmFastMemCopyFromWC(pSysMem, this->m_buffer, this->m_height*this->m_width*m_depth, GetCpuInstructionLevel());
+    CmHostMemCopy(pSysMem, this->m_buffer, this->m_height*this->m_width*m_depth);
 
     return CM_SUCCESS;
 }
@@ -202,12 +217,17 @@ CmSurface3DEmu::~CmSurface3DEmu(){
     CM_unregister_buffer_emu(*pIndex,false);
     if(this->m_buffer != nullptr && this->alloc_dummy)
     {
-        free(this->m_buffer);
+        FreeBuffer();
     }
 }
 
 CM_RT_API int32_t CmSurface3DEmu::InitSurface(const uint32_t initValue, CmEvent* pEvent)
 {
-    CmDwordMemSet( m_buffer, initValue, m_height * m_width * m_depth );
+    if (pEvent)
+    {
+        pEvent->WaitForTaskFinished();
+    }
+
+    CmHostMemSet32( m_buffer, initValue, m_height * m_width * m_depth );
     return CM_SUCCESS;
 }
@@ -21,7 +21,7 @@ class CmSurfaceEmu;
 class CmSurface3DEmu :public CmSurfaceEmu, public CmSurface3D
 {
 public:
-    static int32_t Create( uint32_t index, uint32_t arrayIndex, uint32_t width, uint32_t height, uint32_t depth, CM_SURFACE_FORMAT osApiSurfaceFormat, CmSurfaceFormatID surfFormat , bool isCmCreated, CmSurface3DEmu* &pSurface );
+    static int32_t Create( uint32_t index, uint32_t arrayIndex, uint32_t width, uint32_t height, uint32_t depth, CM_SURFACE_FORMAT osApiSurfaceFormat, CmSurfaceFormatID surfFormat , bool isCmCreated, CmSurface3DEmu* &pSurface, CmSurfaceManagerEmu* surfaceManager = nullptr );
     CM_RT_API int32_t GetIndex(SurfaceIndex*& pIndex);
     CM_RT_API int32_t ReadSurface( unsigned char* pSysMem, CmEvent* pEvent, uint64_t sysMemSize = 0xFFFFFFFFFFFFFFFFULL );
     CM_RT_API int32_t WriteSurface( const unsigned char* pSysMem, CmEvent* pEvent, uint64_t sysMemSize = 0xFFFFFFFFFFFFFFFFULL );
@@ -40,7 +40,7 @@ public:
     void GetSurfaceFormat(CmSurfaceFormatID &surfFormat){ surfFormat =  m_surfFormat;}
 
 protected:
-    CmSurface3DEmu( uint32_t width, uint32_t height, uint32_t depth, CM_SURFACE_FORMAT osApiSurfaceFmt, CmSurfaceFormatID surfFormat, bool isCmCreated );
+    CmSurface3DEmu( uint32_t width, uint32_t height, uint32_t depth, CM_SURFACE_FORMAT osApiSurfaceFmt, CmSurfaceFormatID surfFormat, bool isCmCreated, CmSurfaceManagerEmu* surfaceManager );
     ~CmSurface3DEmu( void );
 
     int32_t Initialize( uint32_t index, uint32_t arrayIndex );
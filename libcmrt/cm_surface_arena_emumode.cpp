@@ -0,0 +1,249 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2021 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include <algorithm>
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#endif
+
+#include "cm_include.h"
+#include "cm_def.h"
+#include "cm_surface_arena_emumode.h"
+#include "cm_mem.h"
+#include "emu_log.h"
+#include "emu_cfg.h"
+
+namespace
+{
+const size_t kCacheLineSize = 64;
+const size_t kPageSize = 4096;
+const size_t kHugePageSize = 2 << 20;
+
+const char* const kPageKindNames[] = { "4KB", "2MB transparent", "2MB explicit" };
+}
+
+CmSurfaceArenaEmu::CmSurfaceArenaEmu( size_t retentionCap ):
+    m_RetentionCap( retentionCap ),
+    m_RetainedBytes( 0 ),
+    m_HugePages( PAGE_KIND_DEFAULT ),
+    m_HugePagesThreshold( std::max<size_t>( GfxEmu::Cfg::HugePagesThreshold().getInt(), kHugePageSize ) ),
+    m_PageKindBytes()
+{
+    const std::string& hugePages = GfxEmu::Cfg::HugePages().getStr();
+    if (hugePages == "transparent")
+    {
+        m_HugePages = PAGE_KIND_TRANSPARENT;
+    }
+    else if (hugePages == "explicit")
+    {
+        m_HugePages = PAGE_KIND_EXPLICIT;
+    }
+}
+
+CmSurfaceArenaEmu::~CmSurfaceArenaEmu( void )
+{
+    for (auto& freeList : m_FreeLists)
+    {
+        for (const Block& block : freeList.second)
+        {
+            FreeBlock( block, freeList.first );
+        }
+    }
+
+    if (m_HugePages != PAGE_KIND_DEFAULT)
+    {
+        GFX_EMU_MESSAGE( fStat, "surface memory allocated: %llu bytes in %s pages, %llu bytes in %s pages, %llu bytes in %s pages\n",
+            (unsigned long long)m_PageKindBytes[PAGE_KIND_DEFAULT], kPageKindNames[PAGE_KIND_DEFAULT],
+            (unsigned long long)m_PageKindBytes[PAGE_KIND_TRANSPARENT], kPageKindNames[PAGE_KIND_TRANSPARENT],
+            (unsigned long long)m_PageKindBytes[PAGE_KIND_EXPLICIT], kPageKindNames[PAGE_KIND_EXPLICIT] );
+    }
+}
+
+//*-----------------------------------------------------------------------------
+//| Purpose:    Size class of a block: powers of two from the cache line size to
+//|             the page size, then quarters of powers of two in whole pages, so
+//|             no more than a quarter of a block is wasted. Blocks for huge
+//|             pages are in whole huge pages.
+//| Returns:    Block size in bytes.
+//*-----------------------------------------------------------------------------
+size_t CmSurfaceArenaEmu::GetSizeClass( size_t size ) const
+{
+    if (size <= kPageSize)
+    {
+        size_t sizeClass = kCacheLineSize;
+        while (sizeClass < size)
+        {
+            sizeClass <<= 1;
+        }
+        return sizeClass;
+    }
+
+    size_t powerOfTwo = kPageSize;
+    while (powerOfTwo <= size / 2)
+    {
+        powerOfTwo <<= 1;
+    }
+    const size_t step = powerOfTwo / 4 > kPageSize ? powerOfTwo / 4 : kPageSize;
+    const size_t sizeClass = (size + step - 1) / step * step;
+
+    if (m_HugePages != PAGE_KIND_DEFAULT && sizeClass >= m_HugePagesThreshold)
+    {
+        return (sizeClass + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+    }
+    return sizeClass;
+}
+
+size_t CmSurfaceArenaEmu::GetAlignment( size_t sizeClass )
+{
+    return sizeClass >= kPageSize ? kPageSize : kCacheLineSize;
+}
+
+//*-----------------------------------------------------------------------------
+//| Purpose:    Allocates a new block, trying explicit then transparent huge
+//|             pages for large blocks as configured, then the heap.
+//| Returns:    The block, with nullptr if out of memory.
+//*-----------------------------------------------------------------------------
+CmSurfaceArenaEmu::Block CmSurfaceArenaEmu::AllocateBlock( size_t sizeClass )
+{
+    if (m_HugePages != PAGE_KIND_DEFAULT && sizeClass >= m_HugePagesThreshold)
+    {
+#if defined(_WIN32)
+        // Needs the "Lock pages in memory" privilege, there are no transparent huge pages.
+        const SIZE_T largePageSize = GetLargePageMinimum();
+        if (m_HugePages == PAGE_KIND_EXPLICIT && largePageSize && sizeClass % largePageSize == 0)
+        {
+            void* ptr = VirtualAlloc( nullptr, sizeClass, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE );
+            if (ptr != nullptr)
+            {
+                return { ptr, PAGE_KIND_EXPLICIT };
+            }
+        }
+#else
+        if (m_HugePages == PAGE_KIND_EXPLICIT)
+        {
+            void* ptr = mmap( nullptr, sizeClass, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+            if (ptr != MAP_FAILED)
+            {
+                return { ptr, PAGE_KIND_EXPLICIT };
+            }
+        }
+
+        // Transparent huge pages back 2MB aligned ranges only, so map with
+        // room for the alignment and unmap what is left around.
+        uint8_t* mapped = (uint8_t*)mmap( nullptr, sizeClass + kHugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+        if (mapped != MAP_FAILED)
+        {
+            const size_t head = (kHugePageSize - (uintptr_t)mapped % kHugePageSize) % kHugePageSize;
+            uint8_t* ptr = mapped + head;
+            if (head)
+            {
+                munmap( mapped, head );
+            }
+            if (kHugePageSize - head)
+            {
+                munmap( ptr + sizeClass, kHugePageSize - head );
+            }
+            if (madvise( ptr, sizeClass, MADV_HUGEPAGE ) == 0)
+            {
+                return { ptr, PAGE_KIND_TRANSPARENT };
+            }
+            munmap( ptr, sizeClass );
+        }
+#endif
+    }
+
+    return { _aligned_malloc( sizeClass, GetAlignment( sizeClass ) ), PAGE_KIND_DEFAULT };
+}
+
+void CmSurfaceArenaEmu::FreeBlock( const Block& block, size_t sizeClass )
+{
+    if (block.pageKind == PAGE_KIND_DEFAULT)
+    {
+        _aligned_free( block.ptr );
+        return;
+    }
+#if defined(_WIN32)
+    VirtualFree( block.ptr, 0, MEM_RELEASE );
+#else
+    munmap( block.ptr, sizeClass );
+#endif
+}
+
+//*-----------------------------------------------------------------------------
+//| Purpose:    Takes a block of the size class of size from its free list, or
+//|             allocates a new zero-filled one.
+//| Returns:    The block, nullptr if out of memory.
+//*-----------------------------------------------------------------------------
+void* CmSurfaceArenaEmu::Allocate( size_t size )
+{
+    const size_t sizeClass = GetSizeClass( size ? size : 1 );
+
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    Block block = { nullptr, PAGE_KIND_DEFAULT };
+    auto freeList = m_FreeLists.find( sizeClass );
+    if (freeList != m_FreeLists.end() && !freeList->second.empty())
+    {
+        block = freeList->second.back();
+        freeList->second.pop_back();
+        m_RetainedBytes -= sizeClass;
+    }
+    else
+    {
+        block = AllocateBlock( sizeClass );
+        if (block.ptr == nullptr)
+        {
+            return nullptr;
+        }
+        if (block.pageKind == PAGE_KIND_DEFAULT)
+        {
+            // Mapped huge pages come zero-filled.
+            CmSafeMemSet( block.ptr, 0, size );
+        }
+        m_PageKindBytes[block.pageKind] += sizeClass;
+        if (m_HugePages != PAGE_KIND_DEFAULT)
+        {
+            GFX_EMU_MESSAGE( fStat, "surface memory: %zu bytes at %p in %s pages\n",
+                sizeClass, block.ptr, kPageKindNames[block.pageKind] );
+        }
+    }
+
+    m_AllocatedBlocks[block.ptr] = { sizeClass, block.pageKind };
+    return block.ptr;
+}
+
+//*-----------------------------------------------------------------------------
+//| Purpose:    Puts a block back to its free list, or releases it when the
+//|             retention cap would be exceeded.
+//*-----------------------------------------------------------------------------
+void CmSurfaceArenaEmu::Free( void* ptr )
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    auto allocated = m_AllocatedBlocks.find( ptr );
+    if (allocated == m_AllocatedBlocks.end())
+    {
+        GFX_EMU_ASSERT( 0 );
+        return;
+    }
+    const size_t sizeClass = allocated->second.first;
+    const Block block = { ptr, allocated->second.second };
+    m_AllocatedBlocks.erase( allocated );
+
+    if (m_RetainedBytes + sizeClass > m_RetentionCap)
+    {
+        FreeBlock( block, sizeClass );
+        return;
+    }
+
+    m_FreeLists[sizeClass].push_back( block );
+    m_RetainedBytes += sizeClass;
+}
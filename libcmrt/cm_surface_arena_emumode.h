@@ -0,0 +1,65 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2021 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+//!
+//! Host memory of the surfaces created by a surface manager. Freed blocks are
+//! kept in per size class free lists, up to the retention cap in total, and
+//! handed out again for surfaces of the same size class. Blocks are cache
+//! line aligned, and page aligned from the page size on. With CM_RT_HUGE_PAGES
+//! blocks of CM_RT_HUGE_PAGES_THRESHOLD bytes and more are backed by 2MB
+//! pages when the system provides them.
+//!
+class CmSurfaceArenaEmu
+{
+public:
+    CmSurfaceArenaEmu( size_t retentionCap );
+    ~CmSurfaceArenaEmu( void );
+
+    // Returns a block of at least size bytes. A new block is zero-filled, a
+    // recycled one holds the content left by its last user.
+    void* Allocate( size_t size );
+    void Free( void* ptr );
+
+protected:
+    enum PageKind
+    {
+        PAGE_KIND_DEFAULT,     // Heap memory.
+        PAGE_KIND_TRANSPARENT, // Memory advised for transparent huge pages.
+        PAGE_KIND_EXPLICIT,    // Memory of reserved huge pages.
+        PAGE_KIND_COUNT
+    };
+
+    struct Block
+    {
+        void*    ptr;
+        PageKind pageKind;
+    };
+
+    size_t GetSizeClass( size_t size ) const;
+    static size_t GetAlignment( size_t sizeClass );
+    Block AllocateBlock( size_t sizeClass );
+    static void FreeBlock( const Block& block, size_t sizeClass );
+
+    std::mutex m_Mutex;
+    size_t m_RetentionCap;
+    size_t m_RetainedBytes;
+    std::unordered_map<size_t, std::vector<Block>> m_FreeLists;
+    std::unordered_map<void*, std::pair<size_t, PageKind>> m_AllocatedBlocks; // Block size classes and page kinds.
+
+    PageKind m_HugePages;       // Page kind to try first for large blocks.
+    size_t m_HugePagesThreshold;
+    uint64_t m_PageKindBytes[PAGE_KIND_COUNT]; // Bytes of new blocks of every page kind.
+};
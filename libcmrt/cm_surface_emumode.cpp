@@ -8,6 +8,7 @@ SPDX-License-Identifier: MIT
 
 #include "cm_include.h"
 #include "cm_surface_emumode.h"
+#include "cm_surface_manager_emumode.h"
 #include "cm.h"
 #include "cm_mem.h"
 
@@ -30,6 +31,8 @@ CmSurfaceEmu::CmSurfaceEmu( bool isCmCreated,
 
 CmSurfaceEmu::~CmSurfaceEmu( void )
 {
+    if (m_surfaceManager)
+        m_surfaceManager->RemoveFromSyncSurfaces(this);
     delete m_pIndex;
 }
 
@@ -73,6 +76,43 @@ void * CmSurfaceEmu::getBuffer()
 {
     return this->m_buffer;
 }
+
+//*-----------------------------------------------------------------------------
+//| Purpose:    Allocates the surface host memory from the surface manager arena.
+//|             Memory recycled from destroyed surfaces is not cleared.
+//| Returns:    The memory, nullptr if out of memory.
+//*-----------------------------------------------------------------------------
+void * CmSurfaceEmu::AllocBuffer(size_t size)
+{
+    if (m_surfaceManager == nullptr)
+    {
+        return calloc(size, 1);
+    }
+    return m_surfaceManager->GetSurfaceArena().Allocate(size);
+}
+
+//*-----------------------------------------------------------------------------
+//| Purpose:    Frees the surface host memory allocated by AllocBuffer.
+//*-----------------------------------------------------------------------------
+void CmSurfaceEmu::FreeBuffer()
+{
+    if (m_surfaceManager == nullptr)
+    {
+        free(m_buffer);
+    }
+    else
+    {
+        m_surfaceManager->GetSurfaceArena().Free(m_buffer);
+    }
+    m_buffer = nullptr;
+}
+
+void CmSurfaceEmu::setISSmUpSurface()
+{
+    m_SMUPSurface = true;
+    if (m_surfaceManager)
+        m_surfaceManager->AddToSyncSurfaces(this);
+}
 int32_t CmSurfaceEmu::CheckStatus(int buf_id)
 {
     cm_list<CmEmulSys::iobuffer>::iterator buff_iter;
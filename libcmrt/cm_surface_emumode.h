@@ -41,7 +41,9 @@ bool doD3DCopy=true
 );
     //emu mode
     void * getBuffer();
-    void setISSmUpSurface(){m_SMUPSurface = true;}
+    void * AllocBuffer(size_t size);
+    void FreeBuffer();
+    void setISSmUpSurface();
     bool getISSmUpSurface(){return m_SMUPSurface;}
     virtual uint32_t GetWidth() = 0;
     virtual uint32_t GetHeight() const = 0;
@@ -10,6 +10,7 @@ SPDX-License-Identifier: MIT
 
 #include "cm_buffer_emumode.h"
 #include "cm_surface_manager_emumode.h"
+#include "emu_cfg.h"
 #include "cm_surface_emumode.h"
 
 #include "cm_buffer_emumode.h"
@@ -409,7 +410,7 @@ int32_t CmSurfaceManagerEmu::CreateSurface3D(uint32_t width, uint32_t height, ui
     }
 
     // true indicates pD3DSurf is created by CM
-    int32_t result = CmSurface3DEmu::Create( index,index, width*sizePerPixel, height,depth, format, surfFormat, true, pCmSurface3D );
+    int32_t result = CmSurface3DEmu::Create( index,index, width*sizePerPixel, height,depth, format, surfFormat, true, pCmSurface3D, this );
 
     if( result != CM_SUCCESS )
     {
@@ -515,7 +516,7 @@ int32_t CmSurfaceManagerEmu::DestroySurface( CmBufferEmu* & pSurface1D )
     }
 
     GFX_EMU_ASSERT( m_SurfaceArray.GetElement( index ) == pSurface1D );
-    m_SurfaceArray.SetElement( index , nullptr );
+    ReleaseSurfaceIndex( index );
 
     std::vector<SurfaceIndex *> aliasIndices = pSurface1D->GetAliasIndices();
 
@@ -523,7 +524,7 @@ int32_t CmSurfaceManagerEmu::DestroySurface( CmBufferEmu* & pSurface1D )
         iter != aliasIndices.end();
         ++iter)
     {
-        m_SurfaceArray.SetElement((*iter)->get_data(), nullptr);
+        ReleaseSurfaceIndex( (*iter)->get_data() );
         RemoveFromAliasIndexTable((*iter)->get_data());
         CM_unregister_buffer_emu(*(*iter), false);
         delete *iter;
@@ -551,13 +552,13 @@ int32_t CmSurfaceManagerEmu::DestroySurface( CmSurface2DEmu* & pSurface2D )
     }
 
     GFX_EMU_ASSERT( m_SurfaceArray.GetElement( index ) == pSurface2D );
-    m_SurfaceArray.SetElement( index , nullptr);
+    ReleaseSurfaceIndex( index );
 
     if(m_SurfaceArray.GetElement( index+1 ) == m_pSurfaceDummy)
-        m_SurfaceArray.SetElement( index+1 , nullptr);
+        ReleaseSurfaceIndex( index+1 );
 
     if(m_SurfaceArray.GetElement( index+2 ) == m_pSurfaceDummy)
-        m_SurfaceArray.SetElement( index+2 , nullptr);
+        ReleaseSurfaceIndex( index+2 );
 
     std::vector<SurfaceIndex *> aliasIndices = pSurface2D->GetAliasIndices();
 
@@ -565,7 +566,7 @@ int32_t CmSurfaceManagerEmu::DestroySurface( CmSurface2DEmu* & pSurface2D )
         iter != aliasIndices.end();
         ++iter)
     {
-        m_SurfaceArray.SetElement((*iter)->get_data(), nullptr);
+        ReleaseSurfaceIndex( (*iter)->get_data() );
         RemoveFromAliasIndexTable((*iter)->get_data());
         CM_unregister_buffer_emu(*(*iter), false);
         if (m_SurfaceArray.GetElement((*iter)->get_data() + 1) == m_pSurfaceDummy)
@@ -573,7 +574,7 @@ int32_t CmSurfaceManagerEmu::DestroySurface( CmSurface2DEmu* & pSurface2D )
             SurfaceIndex* pIndexTemp = new SurfaceIndex((*iter)->get_data() + 1);
             CM_unregister_buffer_emu(*pIndexTemp, false);
             delete pIndexTemp;
-            m_SurfaceArray.SetElement(index + 1, nullptr);
+            ReleaseSurfaceIndex( index + 1 );
         }
 
         if (m_SurfaceArray.GetElement((*iter)->get_data() + 2) == m_pSurfaceDummy)
@@ -581,7 +582,7 @@ int32_t CmSurfaceManagerEmu::DestroySurface( CmSurface2DEmu* & pSurface2D )
             SurfaceIndex* pIndexTemp = new SurfaceIndex((*iter)->get_data() + 2);
             CM_unregister_buffer_emu(*pIndexTemp, false);
             delete pIndexTemp;
-            m_SurfaceArray.SetElement(index + 2, nullptr);
+            ReleaseSurfaceIndex( index + 2 );
         }
         delete *iter;
     }
@@ -599,7 +600,7 @@ int32_t CmSurfaceManagerEmu::DestroySurface( CmSurface3DEmu* & pSurface3D )
     pSurface3D->GetArrayIndex( index );
 
     GFX_EMU_ASSERT( m_SurfaceArray.GetElement( index ) == pSurface3D );
-    m_SurfaceArray.SetElement( index , nullptr);
+    ReleaseSurfaceIndex( index );
 
     CmSurfaceEmu* pSurface = pSurface3D;
     CmSurfaceEmu::Destroy( pSurface ) ;
@@ -655,7 +656,6 @@ int32_t CmSurfaceManagerEmu::MoveSurface( uint32_t src_index, uint32_t dst_index
         }
     }
 
-    SurfaceIndex * pdst_surf_index= new SurfaceIndex(dst_index);
     SurfaceIndex * psrc_surf_index= new SurfaceIndex(src_index);
 
     for( int i=0;i<=additional_increment;i++)
@@ -664,11 +664,16 @@ int32_t CmSurfaceManagerEmu::MoveSurface( uint32_t src_index, uint32_t dst_index
         CmSurfaceEmu *pCurSurface = nullptr;
         pCurSurface= (CmSurfaceEmu *)m_SurfaceArray.GetElement( src_index+i );
         m_SurfaceArray.SetElement(dst_index+i,pCurSurface);
-        m_SurfaceArray.SetElement(src_index+i,nullptr);
+        ReleaseSurfaceIndex( src_index+i );
 
-        //change in Surface itself
-        (*pdst_surf_index) = dst_index+i;
-        pCurSurface->SetIndex(pdst_surf_index);
+        //change in Surface itself; the index object is owned by the surface
+        //and handed out by GetIndex, so it is updated in place
+        if(pCurSurface != m_pSurfaceDummy)
+        {
+            SurfaceIndex *pCurIndex = nullptr;
+            pCurSurface->GetIndex(pCurIndex);
+            (*pCurIndex) = dst_index+i;
+        }
         pCurSurface->SetArrayIndex(dst_index+i);
 
         //change in iobuffers
@@ -677,7 +682,6 @@ int32_t CmSurfaceManagerEmu::MoveSurface( uint32_t src_index, uint32_t dst_index
         CM_modify_buffer_emu(*psrc_surf_index, type, dst_index+i);
     }
 
-    delete pdst_surf_index;
     delete psrc_surf_index;
 
     return CM_SUCCESS;
@@ -689,13 +693,13 @@ int32_t CmSurfaceManagerEmu::DestroySurface2DUP( CmSurface2DEmu* & pSurface2D )
     pSurface2D->GetArrayIndex( index );
 
     GFX_EMU_ASSERT( m_SurfaceArray.GetElement( index ) == pSurface2D );
-    m_SurfaceArray.SetElement( index , nullptr);
+    ReleaseSurfaceIndex( index );
 
     if(m_SurfaceArray.GetElement( index+1 ) == m_pSurfaceDummy)
-        m_SurfaceArray.SetElement( index+1 , nullptr);
+        ReleaseSurfaceIndex( index+1 );
 
     if(m_SurfaceArray.GetElement( index+2 ) == m_pSurfaceDummy)
-        m_SurfaceArray.SetElement( index+2 , nullptr);
+        ReleaseSurfaceIndex( index+2 );
 
     CmSurfaceEmu* pSurface = pSurface2D;
     CmSurfaceEmu::Destroy( pSurface ) ;
@@ -708,6 +712,7 @@ int32_t CmSurfaceManagerEmu::DestroySurface2DUP( CmSurface2DEmu* & pSurface2D )
 CmSurfaceManagerEmu::CmSurfaceManagerEmu()
 	:m_SurfaceArray(512),
 	m_bufferID(0),
+	m_freeIndexHint(0),
 	m_maxBufferCount(0),
 	m_bufferCount(0),
 	m_max2DSurfaceCount(0),
@@ -715,7 +720,8 @@ CmSurfaceManagerEmu::CmSurfaceManagerEmu()
 	m_max2DUPSurfaceCount(0),
 	m_2DUPSurfaceCount(0),
 	m_max3DSurfaceCount(0),
-	m_3DSurfaceCount(0)
+	m_3DSurfaceCount(0),
+	m_surfaceArena(GfxEmu::Cfg::SurfacePoolSize().getInt())
 {
     void *dummy = nullptr;
     CmSurface2DEmu::Create( -1,-1, 0, 0, CM_SURFACE_FORMAT_A8R8G8B8, R8G8B8A8_UNORM, true, this->m_pSurfaceDummy,dummy, true, this);
@@ -763,10 +769,30 @@ CmSurfaceManagerEmu::~CmSurfaceManagerEmu()
     m_SurfaceArray.Delete();
 }
 
+void CmSurfaceManagerEmu::ReleaseSurfaceIndex(uint32_t index)
+{
+    m_SurfaceArray.SetElement(index, nullptr);
+    if(index < m_freeIndexHint)
+    {
+        m_freeIndexHint = index;
+    }
+}
+
 int32_t CmSurfaceManagerEmu::findFreeIndex(uint32_t additional_increment, uint32_t &index)
 {
     bool skip_surface_index0 = getenv("SKIP_SURFACE_INDEX0");
-    for(uint32_t i = skip_surface_index0 ? 1 : 0; i + additional_increment < this->m_maxSurfaceCount; i++)
+    if(skip_surface_index0 && m_freeIndexHint == 0)
+    {
+        m_freeIndexHint = 1;
+    }
+    // Every index below the hint is taken, so the search can start there
+    // instead of walking all the surfaces created so far.
+    while(m_freeIndexHint < this->m_maxSurfaceCount &&
+          m_SurfaceArray.GetElement(m_freeIndexHint) != nullptr)
+    {
+        m_freeIndexHint++;
+    }
+    for(uint32_t i = m_freeIndexHint; i + additional_increment < this->m_maxSurfaceCount; i++)
     {
         switch(additional_increment)
         {
@@ -823,14 +849,17 @@ int32_t CmSurfaceManagerEmu::findFreeIndex(uint32_t additional_increment, uint32
     return CM_FAILURE;
 }
 
+//!
+//! Post-execution copies. Only SM/UP surfaces, surfaces with aliases
+//! having state params and D3D-backed surfaces have copies to do, so only
+//! the surfaces registered with AddToSyncSurfaces are visited. Host writes
+//! to a surface are copied right away by its Write/Init functions.
+//!
 int32_t CmSurfaceManagerEmu::DoCopyAll( )
 {
-
-    for(uint32_t i=0;i<m_SurfaceArray.GetSize();i++)
+    std::lock_guard<std::mutex> lock(m_syncSurfacesMutex);
+    for(auto surfTemp: m_syncSurfaces)
     {
-        CmSurfaceEmu * surfTemp = (CmSurfaceEmu *)m_SurfaceArray.GetElement(i);
-        if(surfTemp == nullptr)
-            continue;
         surfTemp->DoCopy();
     }
     return CM_SUCCESS;
@@ -839,11 +868,10 @@ int32_t CmSurfaceManagerEmu::DoCopyAll( )
 //DoGPUCopySelect
 int32_t CmSurfaceManagerEmu::DoGPUCopySelect( )
 {
-
-    for(uint32_t i=0;i<m_SurfaceArray.GetSize();i++)
+    std::lock_guard<std::mutex> lock(m_syncSurfacesMutex);
+    for(auto surfTemp: m_syncSurfaces)
     {
-        CmSurfaceEmu * surfTemp = (CmSurfaceEmu *)m_SurfaceArray.GetElement(i);
-        if(surfTemp == nullptr || !surfTemp->getISSmUpSurface())
+        if(!surfTemp->getISSmUpSurface())
             continue;
         surfTemp->DoGPUCopy();
     }
@@ -9,11 +9,13 @@ SPDX-License-Identifier: MIT
 #pragma once
 
 #include <vector>
+#include <mutex>
 #include "cm_array.h"
 #include "cm_def.h"
 #include "cm_surface_emumode.h"
 #include "cm_surface_2d_emumode.h"
 #include "cm_buffer_emumode.h"
+#include "cm_surface_arena_emumode.h"
 #include <set>
 
 class CmSurfaceEmu;
@@ -80,6 +82,7 @@ public:
     int32_t DoCopyAll( );
     int32_t DoGPUCopySelect();
     int32_t findFreeIndex(uint32_t additionalIncrement, uint32_t &index);
+    void ReleaseSurfaceIndex(uint32_t index);
 
     int getBytesPerPixel(CM_SURFACE_FORMAT format, uint32_t *additional_increment);
 
@@ -101,6 +104,20 @@ public:
         m_aliasIndexTable.push_back(index);
     }
 
+    // Surfaces with pre/post execution copies to do, the only ones visited
+    // by DoGPUCopySelect and DoCopyAll.
+    void AddToSyncSurfaces(CmSurfaceEmu* surface)
+    {
+        std::lock_guard<std::mutex> lock(m_syncSurfacesMutex);
+        m_syncSurfaces.insert(surface);
+    }
+
+    void RemoveFromSyncSurfaces(CmSurfaceEmu* surface)
+    {
+        std::lock_guard<std::mutex> lock(m_syncSurfacesMutex);
+        m_syncSurfaces.erase(surface);
+    }
+
     void RemoveFromAliasIndexTable(uint32_t index)
     {
         std::vector<uint32_t>::iterator iter = std::find(m_aliasIndexTable.begin(), m_aliasIndexTable.end(), index);
@@ -114,6 +131,8 @@ public:
 	std::set<CmSurfaceEmu *, CompareByGfxAddress> &
         GetStatelessSurfaceArray() { return m_statelessSurfaceArray; }
 
+    CmSurfaceArenaEmu& GetSurfaceArena() { return m_surfaceArena; }
+
 protected:
 
     CmSurfaceManagerEmu();
@@ -127,6 +146,7 @@ protected:
     CmDynamicArray m_SurfaceArray;
     uint32_t m_maxSurfaceCount;
     uint32_t m_bufferID;
+    uint32_t m_freeIndexHint; // lowest surface index that may be free
 
     CmSurface2DEmu* m_pSurfaceDummy;
 
@@ -144,5 +164,10 @@ protected:
 
     std::vector<uint32_t> m_aliasIndexTable;
 
+    CmSurfaceArenaEmu m_surfaceArena;
+
+    std::mutex m_syncSurfacesMutex;
+    std::set<CmSurfaceEmu *> m_syncSurfaces;
+
 	std::set<CmSurfaceEmu *, CompareByGfxAddress> m_statelessSurfaceArray;
 };
@@ -7,6 +7,9 @@ SPDX-License-Identifier: MIT
 ============================= end_copyright_notice ===========================*/
 
 #include <cmath>
+#include <map>
+#include <mutex>
+#include <tuple>
 
 #include "cm_include.h"
 #include "cm_thread_space_emumode.h"
@@ -53,6 +56,35 @@ int32_t CmThreadSpaceEmu::Destroy( CmThreadSpaceEmu* &pTS )
     return CM_SUCCESS;
 }
 
+//!
+//! Create a copy of the dependency board and the patterns of a thread space,
+//! for a task queued to run later. The copy is not affected by the changes
+//! the host makes to the thread space after enqueue, nor by its destruction.
+//!
+int32_t CmThreadSpaceEmu::CreateSnapshot( const CmThreadSpaceEmu& ts, CmThreadSpaceEmu* & pTS )
+{
+    int32_t result = Create( ts.m_pDevice, ts.m_Width, ts.m_Height, pTS );
+    if( result != CM_SUCCESS )
+    {
+        return result;
+    }
+
+    pTS->m_ColorCount = ts.m_ColorCount;
+    pTS->m_26ZIBlockWidth = ts.m_26ZIBlockWidth;
+    pTS->m_26ZIBlockHeight = ts.m_26ZIBlockHeight;
+    pTS->m_Mask = ts.m_Mask;
+    pTS->m_Dependency = ts.m_Dependency;
+    pTS->m_DependencyPatternType = ts.m_DependencyPatternType;
+    pTS->m_WalkingPattern = ts.m_WalkingPattern;
+    pTS->m_26ZIDispatchPattern = ts.m_26ZIDispatchPattern;
+    pTS->m_ThreadAssociated = ts.m_ThreadAssociated;
+    pTS->m_BoardOrder = ts.m_BoardOrder;
+    CmSafeMemCopy( pTS->m_pThreadSpaceUnit, ts.m_pThreadSpaceUnit,
+                   sizeof(CM_THREAD_SPACE_UNIT) * ts.m_Height * ts.m_Width );
+
+    return CM_SUCCESS;
+}
+
 CmThreadSpaceEmu::CmThreadSpaceEmu( CmDeviceEmu* pDevice ,uint32_t width, uint32_t height ):
     m_pDevice( pDevice ),
     m_Width( width ),
@@ -61,10 +93,8 @@ CmThreadSpaceEmu::CmThreadSpaceEmu( CmDeviceEmu* pDevice ,uint32_t width, uint32
     m_26ZIBlockWidth ( CM_26ZI_BLOCK_WIDTH ),
     m_26ZIBlockHeight ( CM_26ZI_BLOCK_HEIGHT ),
     m_DependencyPatternType(CM_NONE_DEPENDENCY),
-    m_CurrentDependencyPattern(CM_NONE_DEPENDENCY),
     m_WalkingPattern(CM_WALK_DEFAULT),
     m_26ZIDispatchPattern(VVERTICAL_HVERTICAL_26),
-    m_Current26ZIDispatchPattern(VVERTICAL_HVERTICAL_26),
     m_pBoardFlag( nullptr ),
     m_pBoardOrderList( nullptr ),
     m_threadGroupSpace_h( nullptr )
@@ -313,36 +343,6 @@ CM_RT_API int32_t CmThreadSpaceEmu::SelectThreadDependencyPattern ( CM_DEPENDENC
 {
     int result = CM_SUCCESS;
 
-    if( m_pBoardFlag == nullptr )
-    {
-        m_pBoardFlag = new uint32_t[m_Height * m_Width];
-        if ( m_pBoardFlag )
-        {
-            CmSafeMemSet(m_pBoardFlag, 0, sizeof(uint32_t) * m_Height * m_Width);
-        }
-        else
-        {
-            GFX_EMU_ASSERT( 0 );
-            return CM_OUT_OF_HOST_MEMORY;
-        }
-    }
-
-    if( m_pBoardOrderList == nullptr )
-    {
-        m_pBoardOrderList = new uint32_t[m_Height * m_Width];
-        if( m_pBoardOrderList )
-        {
-            CmSafeMemSet(m_pBoardOrderList, 0, sizeof(uint32_t) * m_Height * m_Width);
-        }
-        else
-        {
-            GFX_EMU_ASSERT( 0 );
-            if( m_pBoardFlag )
-                CmSafeDeleteArray(m_pBoardFlag);
-            return CM_OUT_OF_HOST_MEMORY;
-        }
-    }
-
     if( ( pattern != CM_NONE_DEPENDENCY) && (m_WalkingPattern != CM_WALK_DEFAULT) )
     {
         GFX_EMU_ASSERT( 0 );
@@ -542,12 +542,6 @@ bool CmThreadSpaceEmu::IntegrityCheck(CmKernelArrayEmu* pTask)
 //*--------------------------------------------------------------------------
 int32_t CmThreadSpaceEmu::Wavefront26ZSequence()
 {
-    if ( m_CurrentDependencyPattern == CM_WAVEFRONT26Z )
-    {
-        return CM_SUCCESS;
-    }
-    m_CurrentDependencyPattern = CM_WAVEFRONT26Z;
-
     if ( ( m_Height % 2 != 0 ) || ( m_Width % 2 != 0 ) )
     {
         return CM_INVALID_ARG_SIZE;
@@ -718,15 +712,6 @@ int32_t CmThreadSpaceEmu::Wavefront26ZSequence()
 
 int32_t CmThreadSpaceEmu::Wavefront26ZISeqVVHV26()
 {
-    if ( m_CurrentDependencyPattern == CM_WAVEFRONT26ZI &&
-        (m_Current26ZIDispatchPattern == VVERTICAL_HVERTICAL_26))
-    {
-        return CM_SUCCESS;
-    }
-
-    m_CurrentDependencyPattern = CM_WAVEFRONT26ZI;
-    m_Current26ZIDispatchPattern = VVERTICAL_HVERTICAL_26;
-
     CmSafeMemSet(m_pBoardFlag, WHITE, m_Width*m_Height*sizeof(uint32_t));
     m_IndexInList = 0;
 
@@ -803,15 +788,6 @@ int32_t CmThreadSpaceEmu::Wavefront26ZISeqVVHV26()
 
 int32_t CmThreadSpaceEmu::Wavefront26ZISeqVVHH26()
 {
-    if ( m_CurrentDependencyPattern == CM_WAVEFRONT26ZI &&
-        (m_Current26ZIDispatchPattern == VVERTICAL_HHORIZONTAL_26))
-    {
-        return CM_SUCCESS;
-    }
-
-    m_CurrentDependencyPattern = CM_WAVEFRONT26ZI;
-    m_Current26ZIDispatchPattern = VVERTICAL_HHORIZONTAL_26;
-
     CmSafeMemSet(m_pBoardFlag, WHITE, m_Width*m_Height*sizeof(uint32_t));
     m_IndexInList = 0;
 
@@ -889,15 +865,6 @@ int32_t CmThreadSpaceEmu::Wavefront26ZISeqVVHH26()
 
 int32_t CmThreadSpaceEmu::Wavefront26ZISeqVV26HH26()
 {
-    if( (m_CurrentDependencyPattern == CM_WAVEFRONT26ZI) &&
-        (m_Current26ZIDispatchPattern == VVERTICAL26_HHORIZONTAL26) )
-    {
-        return CM_SUCCESS;
-    }
-
-    m_CurrentDependencyPattern = CM_WAVEFRONT26ZI;
-    m_Current26ZIDispatchPattern = VVERTICAL26_HHORIZONTAL26;
-
     CmSafeMemSet(m_pBoardFlag, WHITE, m_Width*m_Height*sizeof(uint32_t));
     m_IndexInList = 0;
 
@@ -1012,15 +979,6 @@ int32_t CmThreadSpaceEmu::Wavefront26ZISeqVV26HH26()
 
 int32_t CmThreadSpaceEmu::Wavefront26ZISeqVV1x26HH1x26()
 {
-    if ( (m_CurrentDependencyPattern == CM_WAVEFRONT26ZI) &&
-        (m_Current26ZIDispatchPattern == VVERTICAL1X26_HHORIZONTAL1X26))
-    {
-        return CM_SUCCESS;
-    }
-
-    m_CurrentDependencyPattern = CM_WAVEFRONT26ZI;
-    m_Current26ZIDispatchPattern = VVERTICAL1X26_HHORIZONTAL1X26;
-
     CmSafeMemSet(m_pBoardFlag, WHITE, m_Width*m_Height*sizeof(uint32_t));
     m_IndexInList = 0;
 
@@ -1202,9 +1160,94 @@ int32_t CmThreadSpaceEmu::GetWalkingPattern(CM_WALKING_PATTERN &WalkingPattern)
     return CM_SUCCESS;
 }
 
-int32_t CmThreadSpaceEmu::GetBoardOrder(uint32_t *&pBoardOrder)
+namespace
+{
+// Board orders depend on the thread space geometry and the pattern only, so
+// they are generated once per process and shared by the thread spaces.
+using BoardOrderKey = std::tuple<uint32_t, uint32_t,  // Thread space width, height.
+                                 CM_DEPENDENCY_PATTERN, CM_26ZI_DISPATCH_PATTERN,
+                                 uint32_t, uint32_t>; // 26ZI macro-block width, height.
+
+std::mutex g_BoardOrderCacheMutex;
+std::map<BoardOrderKey, std::shared_ptr<const std::vector<uint32_t>>> g_BoardOrderCache;
+}
+
+//!
+//! Generate the dispatch order of the board for the wavefront 26Z or 26ZI
+//! dependency pattern selected, or take the one generated before for the
+//! same geometry and pattern.
+//! OUTPUT :
+//!     CM_SUCCESS if the board order is available through GetBoardOrder
+//!
+int32_t CmThreadSpaceEmu::GenerateBoardOrder()
+{
+    if( ( m_DependencyPatternType != CM_WAVEFRONT26Z ) && ( m_DependencyPatternType != CM_WAVEFRONT26ZI ) )
+    {
+        GFX_EMU_ASSERT( 0 );
+        return CM_FAILURE;
+    }
+
+    const bool is26ZI = m_DependencyPatternType == CM_WAVEFRONT26ZI;
+    const BoardOrderKey key {
+        m_Width, m_Height, m_DependencyPatternType,
+        is26ZI ? m_26ZIDispatchPattern : VVERTICAL_HVERTICAL_26,
+        is26ZI ? m_26ZIBlockWidth : 0,
+        is26ZI ? m_26ZIBlockHeight : 0 };
+
+    std::lock_guard<std::mutex> lock( g_BoardOrderCacheMutex );
+    auto &boardOrder = g_BoardOrderCache[ key ];
+    if( !boardOrder )
+    {
+        m_pBoardFlag = new uint32_t[m_Height * m_Width];
+        m_pBoardOrderList = new uint32_t[m_Height * m_Width];
+        CmSafeMemSet(m_pBoardOrderList, 0, sizeof(uint32_t) * m_Height * m_Width);
+
+        int32_t result = CM_SUCCESS;
+        if( !is26ZI )
+        {
+            result = Wavefront26ZSequence();
+        }
+        else
+        {
+            switch( m_26ZIDispatchPattern )
+            {
+            case VVERTICAL_HHORIZONTAL_26:
+                result = Wavefront26ZISeqVVHH26();
+                break;
+            case VVERTICAL26_HHORIZONTAL26:
+                result = Wavefront26ZISeqVV26HH26();
+                break;
+            case VVERTICAL1X26_HHORIZONTAL1X26:
+                result = Wavefront26ZISeqVV1x26HH1x26();
+                break;
+            default:
+                result = Wavefront26ZISeqVVHV26();
+                break;
+            }
+        }
+
+        if( result == CM_SUCCESS )
+        {
+            boardOrder = std::make_shared<const std::vector<uint32_t>>(
+                m_pBoardOrderList, m_pBoardOrderList + m_Height * m_Width );
+        }
+        CmSafeDeleteArray(m_pBoardFlag);
+        CmSafeDeleteArray(m_pBoardOrderList);
+
+        if( result != CM_SUCCESS )
+        {
+            g_BoardOrderCache.erase( key );
+            return result;
+        }
+    }
+
+    m_BoardOrder = boardOrder;
+    return CM_SUCCESS;
+}
+
+int32_t CmThreadSpaceEmu::GetBoardOrder(const uint32_t *&pBoardOrder)
 {
-    pBoardOrder = m_pBoardOrderList;
+    pBoardOrder = m_BoardOrder ? m_BoardOrder->data() : nullptr;
     return CM_SUCCESS;
 }
 
@@ -9,6 +9,8 @@ SPDX-License-Identifier: MIT
 #pragma once
 
 #include <cstdint>
+#include <memory>
+#include <vector>
 #include "cm_thread_space_base.h"
 #include "cm_def.h"
 #include "emu_log.h"
@@ -26,6 +28,7 @@ class CmThreadSpaceEmu : public CmThreadSpace
 public:
     static int32_t Create( CmDeviceEmu* pDevice, uint32_t width, uint32_t height, CmThreadSpaceEmu* & pTS );
     static int32_t Destroy( CmThreadSpaceEmu* & pTS );
+    static int32_t CreateSnapshot( const CmThreadSpaceEmu& ts, CmThreadSpaceEmu* & pTS );
 
     CM_RT_API int32_t AssociateThread( uint32_t x, uint32_t y, CmKernel* pKernel , uint32_t threadId );
     CM_RT_API int32_t SetThreadDependencyPattern( uint32_t count, int32_t *deltaX, int32_t *deltaY );
@@ -46,7 +49,8 @@ public:
     int32_t GetColorCount(uint32_t & colorCount);
     int32_t GetWalkingPattern(CM_WALKING_PATTERN &WalkingPattern);
     int32_t Get26ZIDispatchPattern( CM_26ZI_DISPATCH_PATTERN &pattern);
-    int32_t GetBoardOrder(uint32_t *&pBoardOrder);
+    int32_t GenerateBoardOrder();
+    int32_t GetBoardOrder(const uint32_t *&pBoardOrder);
     int32_t InitDependency();
     int32_t AssociateKernel(CmKernel* kernel);
     bool IsThreadAssociated();
@@ -80,18 +84,21 @@ protected:
 
     CM_DEPENDENCY m_Dependency;
     CM_DEPENDENCY_PATTERN m_DependencyPatternType;
-    CM_DEPENDENCY_PATTERN m_CurrentDependencyPattern;
     CM_WALKING_PATTERN m_WalkingPattern;
 
     CM_26ZI_DISPATCH_PATTERN m_26ZIDispatchPattern;
-    CM_26ZI_DISPATCH_PATTERN m_Current26ZIDispatchPattern;
 
     CM_THREAD_SPACE_UNIT *m_pThreadSpaceUnit;
     bool m_ThreadAssociated;
 
+    // Scratch of the Wavefront26Z* sequence generators.
     uint32_t *m_pBoardFlag;
     uint32_t *m_pBoardOrderList;
     uint32_t m_IndexInList;
 
+    // Board order of the current pattern, shared with the thread spaces of
+    // the same geometry and pattern.
+    std::shared_ptr<const std::vector<uint32_t>> m_BoardOrder;
+
     CmThreadGroupSpace *m_threadGroupSpace_h;
 };
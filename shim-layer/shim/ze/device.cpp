@@ -131,7 +131,7 @@ ZE_APIEXPORT ze_result_t ZE_APICALL SHIM_CALL(zeDeviceGetProperties)(
   pDeviceProperties->numSubslicesPerSlice = 1;
   pDeviceProperties->numSlices = 1;
 
-  pDeviceProperties->timerResolution = 1000;
+  pDeviceProperties->timerResolution = shim::ze::kTimerResolution;
   pDeviceProperties->timestampValidBits = 60;
   pDeviceProperties->kernelTimestampValidBits = 60;
 
@@ -11,6 +11,16 @@ SPDX-License-Identifier: MIT
 
 #include "ze.h"
 
+namespace shim {
+namespace ze {
+
+// Length of a device timer tick in nanoseconds, as reported in
+// ze_device_properties_t::timerResolution.
+constexpr uint64_t kTimerResolution = 1000;
+
+} // namespace ze
+} // namespace shim
+
 extern "C" {
 ZE_APIEXPORT ze_result_t ZE_APICALL
     SHIM_CALL(zeDeviceGet)(ze_driver_handle_t hDriver, uint32_t *pCount,
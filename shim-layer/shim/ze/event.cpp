@@ -7,6 +7,7 @@ SPDX-License-Identifier: MIT
 ============================= end_copyright_notice ===========================*/
 
 #include "event.h"
+#include "device.h"
 
 extern "C" {
 SHIM_EXPORT(zeEventPoolCreate);
@@ -235,10 +236,27 @@ ZE_APIEXPORT ze_result_t ZE_APICALL SHIM_CALL(zeEventQueryKernelTimestamp)(
   if (auto r = SHIM_CALL(zeEventQueryStatus)(hEvent)) {
     return r;
   }
-  dstptr->global.kernelStart = 0;
-  dstptr->global.kernelEnd = 100;
-  dstptr->context.kernelStart = 0;
-  dstptr->context.kernelEnd = 100;
+
+  shim::IntrusivePtr<shim::ze::Event> event(
+      reinterpret_cast<shim::ze::Event *>(hEvent));
+
+  // Events signalled from the host have no kernel execution to report.
+  uint64_t start = 0;
+  uint64_t end = 0;
+  if (event->event_) {
+    if (event->event_->GetProfilingInfo(CM_EVENT_PROFILING_HWSTART,
+                                        sizeof(start), nullptr, &start) !=
+            CM_SUCCESS ||
+        event->event_->GetProfilingInfo(CM_EVENT_PROFILING_HWEND, sizeof(end),
+                                        nullptr, &end) != CM_SUCCESS) {
+      return ZE_RESULT_NOT_READY;
+    }
+  }
+
+  dstptr->global.kernelStart = start / shim::ze::kTimerResolution;
+  dstptr->global.kernelEnd = end / shim::ze::kTimerResolution;
+  dstptr->context.kernelStart = dstptr->global.kernelStart;
+  dstptr->context.kernelEnd = dstptr->global.kernelEnd;
 
   return ZE_RESULT_SUCCESS;
 }
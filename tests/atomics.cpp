@@ -0,0 +1,172 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2026 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+// Checks values returned and left in memory by dataport atomics performed
+// through a compare-exchange loop, for 32-bit and 64-bit operands. Odd
+// lanes leave memory unchanged.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "cm.h"
+#include "cm_rt.h"
+
+static const int N = 8;
+
+// Memory layout in dwords, for each of N lanes.
+static const int CMPXCHG32 = 0;   // uint
+static const int CMPXCHG64 = 16;  // uint64_t, 2 dwords per lane
+static const int MAX64     = 32;  // uint64_t
+static const int MINSINT64 = 48;  // int64_t
+static const int FMAX32    = 64;  // float
+static const int DWORDS    = 72;
+
+static const uint64_t HIGH = 1ull << 40;
+
+_GENX_MAIN_ void atomic_kernel(SurfaceIndex mem, SurfaceIndex out)
+{
+    vector<uint, N> lane;
+    for (int i = 0; i < N; i++) {
+        lane(i) = i;
+    }
+    vector<uint, N> odd = lane & 1;
+
+    vector<uint, N> new32 = 100 + lane;
+    vector<uint, N> expected32 = 10 * lane + odd;
+    vector<uint, N> ret32;
+    write_atomic<ATOMIC_CMPXCHG, uint, N>(mem, CMPXCHG32 + lane, new32, expected32, ret32);
+    write(out, CMPXCHG32 * 4, ret32);
+
+    vector<uint64_t, N> new64, expected64, ret64;
+    for (int i = 0; i < N; i++) {
+        new64(i) = 3 * HIGH + i;
+        // Odd lanes differ in the upper dword only.
+        expected64(i) = HIGH + i + (odd(i) ? (1ull << 33) : 0);
+    }
+    write_atomic<ATOMIC_CMPXCHG, uint64_t, N>(mem, CMPXCHG64 + 2 * lane, new64, expected64, ret64);
+    write(out, CMPXCHG64 * 4, ret64);
+
+    vector<uint64_t, N> max64;
+    for (int i = 0; i < N; i++) {
+        max64(i) = odd(i) ? 7 : (2ull << 32);
+    }
+    write_atomic<ATOMIC_MAX, uint64_t, N>(mem, MAX64 + 2 * lane, max64, ret64);
+    write(out, MAX64 * 4, ret64);
+
+    vector<int64_t, N> min64, retS64;
+    for (int i = 0; i < N; i++) {
+        min64(i) = odd(i) ? 1 : -(int64_t)(2 * HIGH);
+    }
+    write_atomic<ATOMIC_MINSINT, int64_t, N>(mem, MINSINT64 + 2 * lane, min64, retS64);
+    write(out, MINSINT64 * 4, retS64);
+
+    vector<float, N> fmax, retF;
+    for (int i = 0; i < N; i++) {
+        fmax(i) = odd(i) ? 0.5f : 2.5f;
+    }
+    write_atomic<ATOMIC_FMAX, float, N>(mem, FMAX32 + lane, fmax, retF);
+    write(out, FMAX32 * 4, retF);
+}
+
+struct Memory
+{
+    uint32_t cmpxchg32[N];
+    uint32_t pad0[8];
+    uint64_t cmpxchg64[N];
+    uint64_t max64[N];
+    int64_t  minsint64[N];
+    float    fmax32[N];
+};
+static_assert(sizeof(Memory) == DWORDS * 4, "layout");
+
+static void init(Memory &m)
+{
+    std::memset(&m, 0, sizeof(m));
+    for (int i = 0; i < N; i++) {
+        m.cmpxchg32[i] = 10 * i;
+        m.cmpxchg64[i] = HIGH + i;
+        m.max64[i] = (1ull << 32) + 5;
+        m.minsint64[i] = -(int64_t)HIGH;
+        m.fmax32[i] = 1.5f;
+    }
+}
+
+int main()
+{
+    CmDevice *dev = nullptr;
+    UINT version = 0;
+    if (CreateCmDevice(dev, version) != CM_SUCCESS) {
+        std::printf("CreateCmDevice failed\n");
+        return 1;
+    }
+    CmQueue *queue = nullptr;
+    dev->CreateQueue(queue);
+    CmProgram *program = nullptr;
+    dev->LoadProgram(nullptr, 0, program);
+    CmKernel *kernel = nullptr;
+    dev->CreateKernel(program, CM_KERNEL_FUNCTION(atomic_kernel), kernel);
+
+    Memory initial, mem, old;
+    init(initial);
+    CmBuffer *mem_buf = nullptr, *out_buf = nullptr;
+    dev->CreateBuffer(sizeof(Memory), mem_buf);
+    dev->CreateBuffer(sizeof(Memory), out_buf);
+    mem_buf->WriteSurface(reinterpret_cast<unsigned char *>(&initial), nullptr);
+
+    SurfaceIndex *mem_idx = nullptr, *out_idx = nullptr;
+    mem_buf->GetIndex(mem_idx);
+    out_buf->GetIndex(out_idx);
+    kernel->SetThreadCount(1);
+    kernel->SetKernelArg(0, sizeof(SurfaceIndex), mem_idx);
+    kernel->SetKernelArg(1, sizeof(SurfaceIndex), out_idx);
+    CmTask *task = nullptr;
+    dev->CreateTask(task);
+    task->AddKernel(kernel);
+    CmEvent *event = nullptr;
+    if (queue->Enqueue(task, event) != CM_SUCCESS) {
+        std::printf("Enqueue failed\n");
+        return 1;
+    }
+    mem_buf->ReadSurface(reinterpret_cast<unsigned char *>(&mem), event);
+    out_buf->ReadSurface(reinterpret_cast<unsigned char *>(&old), event);
+
+    int failures = 0;
+    auto check = [&failures](const char *op, int lane, bool returned, bool stored) {
+        if (!returned || !stored) {
+            std::printf("%s lane %d:%s%s\n", op, lane,
+                returned ? "" : " wrong value returned", stored ? "" : " wrong value stored");
+            failures++;
+        }
+    };
+    for (int i = 0; i < N; i++) {
+        const bool odd = i & 1;
+        check("32-bit CMPXCHG", i, old.cmpxchg32[i] == initial.cmpxchg32[i],
+            mem.cmpxchg32[i] == (odd ? initial.cmpxchg32[i] : 100u + i));
+        check("64-bit CMPXCHG", i, old.cmpxchg64[i] == initial.cmpxchg64[i],
+            mem.cmpxchg64[i] == (odd ? initial.cmpxchg64[i] : 3 * HIGH + i));
+        check("64-bit MAX", i, old.max64[i] == initial.max64[i],
+            mem.max64[i] == (odd ? initial.max64[i] : 2ull << 32));
+        check("64-bit MINSINT", i, old.minsint64[i] == initial.minsint64[i],
+            mem.minsint64[i] == (odd ? initial.minsint64[i] : -(int64_t)(2 * HIGH)));
+        check("32-bit FMAX", i, old.fmax32[i] == initial.fmax32[i],
+            mem.fmax32[i] == (odd ? initial.fmax32[i] : 2.5f));
+    }
+
+    queue->DestroyEvent(event);
+    dev->DestroyTask(task);
+    dev->DestroySurface(mem_buf);
+    dev->DestroySurface(out_buf);
+    dev->DestroyKernel(kernel);
+    dev->DestroyProgram(program);
+    DestroyCmDevice(dev);
+
+    std::printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures != 0;
+}
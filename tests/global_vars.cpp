@@ -0,0 +1,92 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2026 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+// Checks that __GLOBAL variables do not carry state over from one kernel
+// launch to the next in the default threads scheduling mode.
+
+#include <cstdio>
+#include <vector>
+
+#include "cm.h"
+#include "cm_rt.h"
+
+static const int WIDTH = 16;
+static const int LAUNCHES = 4;
+
+__GLOBAL(int) g_calls = 0;
+
+_GENX_MAIN_ void count_kernel(SurfaceIndex out)
+{
+    uint x = get_thread_origin_x();
+    g_calls++;
+    vector<int, 4> v = g_calls;
+    write(out, x * 16, v);
+}
+
+int main()
+{
+    CmDevice *dev = nullptr;
+    UINT version = 0;
+    if (CreateCmDevice(dev, version) != CM_SUCCESS) {
+        std::printf("CreateCmDevice failed\n");
+        return 1;
+    }
+    CmQueue *queue = nullptr;
+    dev->CreateQueue(queue);
+    CmProgram *program = nullptr;
+    dev->LoadProgram(nullptr, 0, program);
+    CmKernel *kernel = nullptr;
+    dev->CreateKernel(program, CM_KERNEL_FUNCTION(count_kernel), kernel);
+
+    CmBuffer *out = nullptr;
+    dev->CreateBuffer(WIDTH * 16, out);
+    SurfaceIndex *out_idx = nullptr;
+    out->GetIndex(out_idx);
+    kernel->SetThreadCount(WIDTH);
+    kernel->SetKernelArg(0, sizeof(SurfaceIndex), out_idx);
+
+    CmThreadSpace *ts = nullptr;
+    dev->CreateThreadSpace(WIDTH, 1, ts);
+    CmTask *task = nullptr;
+    dev->CreateTask(task);
+    task->AddKernel(kernel);
+
+    int failures = 0;
+    std::vector<int> first;
+    for (int launch = 0; launch < LAUNCHES; launch++) {
+        CmEvent *event = nullptr;
+        if (queue->Enqueue(task, event, ts) != CM_SUCCESS) {
+            std::printf("Enqueue failed\n");
+            failures++;
+            break;
+        }
+        std::vector<int> result(WIDTH * 4, 0);
+        out->ReadSurface(reinterpret_cast<unsigned char *>(result.data()), event);
+        if (launch == 0) {
+            first = result;
+        }
+        for (int x = 0; x < WIDTH; x++) {
+            if (result[x * 4] != first[x * 4]) {
+                std::printf("launch %d, work-item %d: g_calls is %d, was %d in the first launch\n",
+                    launch, x, result[x * 4], first[x * 4]);
+                failures++;
+            }
+        }
+        queue->DestroyEvent(event);
+    }
+
+    dev->DestroyTask(task);
+    dev->DestroyThreadSpace(ts);
+    dev->DestroySurface(out);
+    dev->DestroyKernel(kernel);
+    dev->DestroyProgram(program);
+    DestroyCmDevice(dev);
+
+    std::printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures != 0;
+}
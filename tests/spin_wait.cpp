@@ -0,0 +1,104 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2026 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+// Checks that a work-item polling a flag set by a later work-item of its
+// group completes when work-items run as a parallel loop.
+
+#include <cstdio>
+#include <vector>
+
+#include "cm.h"
+#include "cm_rt.h"
+
+static const int GROUPS = 8;
+static const int GROUP_SIZE = 4;
+
+_GENX_MAIN_ void spin_kernel(SurfaceIndex flags, SurfaceIndex out)
+{
+    uint lid = cm_local_id(0);
+    uint gid = cm_group_id(0);
+    vector<ushort, 8> mask = 0;
+    mask(0) = 1;
+    vector<uint, 8> offset = gid * 4;
+    vector<uint, 8> ret;
+
+    if (lid == 0) {
+        // Adding zero changes nothing, so every poll yields.
+        vector<uint, 8> zero = 0;
+        do {
+            write_atomic<ATOMIC_ADD, uint, 8>(mask, flags, offset, zero, ret);
+        } while (ret(0) == 0);
+        vector<int, 4> v = gid + 1;
+        write(out, gid * 16, v);
+    } else if (lid == GROUP_SIZE - 1) {
+        vector<uint, 8> one = 1;
+        write_atomic<ATOMIC_ADD, uint, 8>(mask, flags, offset, one, ret);
+    }
+}
+
+int main()
+{
+    CmDevice *dev = nullptr;
+    UINT version = 0;
+    if (CreateCmDevice(dev, version) != CM_SUCCESS) {
+        std::printf("CreateCmDevice failed\n");
+        return 1;
+    }
+    CmQueue *queue = nullptr;
+    dev->CreateQueue(queue);
+    CmProgram *program = nullptr;
+    dev->LoadProgram(nullptr, 0, program);
+    CmKernel *kernel = nullptr;
+    dev->CreateKernel(program, CM_KERNEL_FUNCTION(spin_kernel), kernel);
+
+    CmBuffer *flags = nullptr, *out = nullptr;
+    dev->CreateBuffer(GROUPS * 16, flags);
+    dev->CreateBuffer(GROUPS * 16, out);
+    std::vector<int> zero(GROUPS * 4, 0);
+    flags->WriteSurface(reinterpret_cast<unsigned char *>(zero.data()), nullptr);
+
+    SurfaceIndex *flags_idx = nullptr, *out_idx = nullptr;
+    flags->GetIndex(flags_idx);
+    out->GetIndex(out_idx);
+    kernel->SetKernelArg(0, sizeof(SurfaceIndex), flags_idx);
+    kernel->SetKernelArg(1, sizeof(SurfaceIndex), out_idx);
+
+    CmThreadGroupSpace *tgs = nullptr;
+    dev->CreateThreadGroupSpace(GROUP_SIZE, 1, GROUPS, 1, tgs);
+    CmTask *task = nullptr;
+    dev->CreateTask(task);
+    task->AddKernel(kernel);
+
+    int failures = 0;
+    CmEvent *event = nullptr;
+    if (queue->EnqueueWithGroup(task, event, tgs) != CM_SUCCESS) {
+        std::printf("EnqueueWithGroup failed\n");
+        failures++;
+    } else {
+        std::vector<int> result(GROUPS * 4, 0);
+        out->ReadSurface(reinterpret_cast<unsigned char *>(result.data()), event);
+        for (int g = 0; g < GROUPS; g++) {
+            if (result[g * 4] != g + 1) {
+                std::printf("group %d: got %d, expected %d\n", g, result[g * 4], g + 1);
+                failures++;
+            }
+        }
+        queue->DestroyEvent(event);
+    }
+
+    dev->DestroyTask(task);
+    dev->DestroyThreadGroupSpace(tgs);
+    dev->DestroySurface(flags);
+    dev->DestroySurface(out);
+    dev->DestroyKernel(kernel);
+    dev->DestroyProgram(program);
+    DestroyCmDevice(dev);
+
+    std::printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures != 0;
+}
@@ -0,0 +1,160 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2026 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+// Checks surfaces with indices of 256 and more: buffers of a device with a
+// surface table larger than the hardware binding table, and buffers
+// registered directly across pages of the surface lookup table.
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "cm.h"
+#include "cm_rt.h"
+
+static const int BUFFERS = 600;
+
+_GENX_MAIN_ void copy_kernel(SurfaceIndex src, SurfaceIndex dst)
+{
+    vector<int, 4> v;
+    read(src, 0, v);
+    write(dst, 0, v);
+}
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    if (!(cond)) { \
+        std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    }
+
+static bool is_registered(uint32_t id)
+{
+    return CmEmulSys::search_buffer(id) != CmEmulSys::iobuffers.end();
+}
+
+static int read_through_kernel(CmDevice *dev, CmQueue *queue, CmKernel *kernel,
+                               CmBuffer *src, CmBuffer *dst)
+{
+    SurfaceIndex *src_idx = nullptr, *dst_idx = nullptr;
+    src->GetIndex(src_idx);
+    dst->GetIndex(dst_idx);
+    kernel->SetThreadCount(1);
+    kernel->SetKernelArg(0, sizeof(SurfaceIndex), src_idx);
+    kernel->SetKernelArg(1, sizeof(SurfaceIndex), dst_idx);
+
+    CmTask *task = nullptr;
+    dev->CreateTask(task);
+    task->AddKernel(kernel);
+    CmEvent *event = nullptr;
+    int value = -1;
+    if (queue->Enqueue(task, event) == CM_SUCCESS) {
+        std::vector<int> out(4, -1);
+        dst->ReadSurface(reinterpret_cast<unsigned char *>(out.data()), event);
+        value = out[0];
+        queue->DestroyEvent(event);
+    }
+    dev->DestroyTask(task);
+    return value;
+}
+
+static void check_device_buffers()
+{
+    CmDevice *dev = nullptr;
+    UINT version = 0;
+    if (CreateCmDevice(dev, version) != CM_SUCCESS) {
+        std::printf("CreateCmDevice failed\n");
+        failures++;
+        return;
+    }
+    CmQueue *queue = nullptr;
+    dev->CreateQueue(queue);
+    CmProgram *program = nullptr;
+    dev->LoadProgram(nullptr, 0, program);
+    CmKernel *kernel = nullptr;
+    dev->CreateKernel(program, CM_KERNEL_FUNCTION(copy_kernel), kernel);
+
+    CmBuffer *dst = nullptr;
+    dev->CreateBuffer(16, dst);
+
+    std::vector<CmBuffer *> buffers(BUFFERS, nullptr);
+    uint32_t max_id = 0;
+    for (int i = 0; i < BUFFERS; i++) {
+        CHECK(dev->CreateBuffer(16, buffers[i]) == CM_SUCCESS);
+        if (!buffers[i]) {
+            break;
+        }
+        std::vector<int> data(4, i);
+        buffers[i]->WriteSurface(reinterpret_cast<unsigned char *>(data.data()), nullptr);
+        SurfaceIndex *idx = nullptr;
+        buffers[i]->GetIndex(idx);
+        max_id = std::max(max_id, idx->get_data());
+    }
+    CHECK(max_id >= BUFFERS);
+
+    for (int i = 0; i < BUFFERS && buffers[i]; i += 37) {
+        CHECK(read_through_kernel(dev, queue, kernel, buffers[i], dst) == i);
+    }
+
+    // Destroyed buffers leave their indices unregistered until reused.
+    for (int i = 300; i < 320 && buffers[i]; i++) {
+        SurfaceIndex *idx = nullptr;
+        buffers[i]->GetIndex(idx);
+        uint32_t id = idx->get_data();
+        dev->DestroySurface(buffers[i]);
+        CHECK(!is_registered(id));
+    }
+    CmBuffer *reused = nullptr;
+    dev->CreateBuffer(16, reused);
+    std::vector<int> data(4, 12345);
+    reused->WriteSurface(reinterpret_cast<unsigned char *>(data.data()), nullptr);
+    CHECK(read_through_kernel(dev, queue, kernel, reused, dst) == 12345);
+    CHECK(read_through_kernel(dev, queue, kernel, buffers[BUFFERS - 1], dst) == BUFFERS - 1);
+
+    dev->DestroyKernel(kernel);
+    dev->DestroyProgram(program);
+    DestroyCmDevice(dev);
+}
+
+static void check_registry_pages()
+{
+    const uint32_t ids[] = {256, 1023, 1024, 5000, 70000, (1u << 20) - 1};
+    int data[sizeof(ids) / sizeof(ids[0])][4] = {};
+
+    for (size_t i = 0; i < sizeof(ids) / sizeof(ids[0]); i++) {
+        CHECK(!is_registered(ids[i]));
+        CM_register_buffer(SurfaceIndex(ids[i]), GEN4_INPUT_OUTPUT_BUFFER, data[i], sizeof(data[i]));
+    }
+    for (size_t i = 0; i < sizeof(ids) / sizeof(ids[0]); i++) {
+        auto it = CmEmulSys::search_buffer(ids[i]);
+        CHECK(it != CmEmulSys::iobuffers.end() && it->p == data[i]);
+    }
+
+    // Move to an index of another page.
+    CM_modify_buffer(SurfaceIndex(5000), GEN4_FIELD_SURFACE_ID, 9000);
+    CHECK(!is_registered(5000));
+    auto it = CmEmulSys::search_buffer(9000);
+    CHECK(it != CmEmulSys::iobuffers.end() && it->p == data[3]);
+    CM_modify_buffer(SurfaceIndex(9000), GEN4_FIELD_SURFACE_ID, 5000);
+
+    for (size_t i = 0; i < sizeof(ids) / sizeof(ids[0]); i++) {
+        CM_unregister_buffer(SurfaceIndex(ids[i]), false);
+        CHECK(!is_registered(ids[i]));
+    }
+    CHECK(!is_registered(9000));
+}
+
+int main()
+{
+    check_device_buffers();
+    check_registry_pages();
+
+    std::printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures != 0;
+}
@@ -0,0 +1,144 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2026 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+// Checks that surfaces are found by index through registration,
+// unregistration and moves to another binding table index.
+
+#include <cstdio>
+#include <vector>
+
+#include "cm.h"
+#include "cm_rt.h"
+
+static const int WIDTH = 16;
+
+void copy_kernel(SurfaceIndex src, SurfaceIndex dst)
+{
+    uint x = get_thread_origin_x();
+    vector<int, 4> v;
+    read(src, x * 16, v);
+    write(dst, x * 16, v);
+}
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    if (!(cond)) { \
+        std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    }
+
+static bool is_registered(uint32_t id)
+{
+    return CmEmulSys::search_buffer(id) != CmEmulSys::iobuffers.end();
+}
+
+static int run_copy(CmDevice *dev, CmQueue *queue, CmKernel *kernel,
+                    CmBuffer *src, CmBuffer *dst, int expected_base)
+{
+    SurfaceIndex *src_idx = nullptr, *dst_idx = nullptr;
+    src->GetIndex(src_idx);
+    dst->GetIndex(dst_idx);
+    kernel->SetThreadCount(WIDTH);
+    kernel->SetKernelArg(0, sizeof(SurfaceIndex), src_idx);
+    kernel->SetKernelArg(1, sizeof(SurfaceIndex), dst_idx);
+
+    CmThreadSpace *ts = nullptr;
+    dev->CreateThreadSpace(WIDTH, 1, ts);
+    CmTask *task = nullptr;
+    dev->CreateTask(task);
+    task->AddKernel(kernel);
+    CmEvent *event = nullptr;
+    int bad = 0;
+    if (queue->Enqueue(task, event, ts) != CM_SUCCESS) {
+        bad++;
+    } else {
+        std::vector<int> out(WIDTH * 4, -1);
+        dst->ReadSurface(reinterpret_cast<unsigned char *>(out.data()), event);
+        for (int i = 0; i < WIDTH * 4; i++) {
+            bad += out[i] != expected_base + i;
+        }
+        queue->DestroyEvent(event);
+    }
+    dev->DestroyTask(task);
+    dev->DestroyThreadSpace(ts);
+    return bad;
+}
+
+int main()
+{
+    CmDevice *dev = nullptr;
+    UINT version = 0;
+    if (CreateCmDevice(dev, version) != CM_SUCCESS) {
+        std::printf("CreateCmDevice failed\n");
+        return 1;
+    }
+    CmQueue *queue = nullptr;
+    dev->CreateQueue(queue);
+    CmProgram *program = nullptr;
+    dev->LoadProgram(nullptr, 0, program);
+    CmKernel *kernel = nullptr;
+    dev->CreateKernel(program, CM_KERNEL_FUNCTION(copy_kernel), kernel);
+
+    std::vector<int> data(WIDTH * 4);
+    for (int i = 0; i < WIDTH * 4; i++) {
+        data[i] = 1000 + i;
+    }
+    CmBuffer *src = nullptr, *dst = nullptr;
+    dev->CreateBuffer(WIDTH * 16, src);
+    dev->CreateBuffer(WIDTH * 16, dst);
+    src->WriteSurface(reinterpret_cast<unsigned char *>(data.data()), nullptr);
+
+    SurfaceIndex *src_idx = nullptr;
+    src->GetIndex(src_idx);
+    uint32_t old_id = src_idx->get_data();
+
+    // Register.
+    CHECK(is_registered(old_id));
+    CHECK(run_copy(dev, queue, kernel, src, dst, 1000) == 0);
+
+    // Move: the surface is found under its new index only.
+    uint32_t new_id = 200;
+    CHECK(kernel->SetSurfaceBTI(src_idx, new_id) == CM_SUCCESS);
+    src->GetIndex(src_idx);
+    CHECK(src_idx->get_data() == new_id);
+    CHECK(is_registered(new_id));
+    CHECK(!is_registered(old_id));
+    CHECK(run_copy(dev, queue, kernel, src, dst, 1000) == 0);
+
+    // Moving another surface onto an occupied index first moves the
+    // occupant away; both stay reachable.
+    CmBuffer *other = nullptr;
+    dev->CreateBuffer(WIDTH * 16, other);
+    for (int i = 0; i < WIDTH * 4; i++) {
+        data[i] = 5000 + i;
+    }
+    other->WriteSurface(reinterpret_cast<unsigned char *>(data.data()), nullptr);
+    SurfaceIndex *other_idx = nullptr;
+    other->GetIndex(other_idx);
+    CHECK(kernel->SetSurfaceBTI(other_idx, new_id) == CM_SUCCESS);
+    src->GetIndex(src_idx);
+    CHECK(src_idx->get_data() != new_id);
+    CHECK(run_copy(dev, queue, kernel, other, dst, 5000) == 0);
+    CHECK(run_copy(dev, queue, kernel, src, dst, 1000) == 0);
+
+    // Unregister.
+    uint32_t src_id = src_idx->get_data();
+    dev->DestroySurface(src);
+    CHECK(!is_registered(src_id));
+    CHECK(is_registered(new_id));
+
+    dev->DestroySurface(other);
+    dev->DestroySurface(dst);
+    dev->DestroyKernel(kernel);
+    dev->DestroyProgram(program);
+    DestroyCmDevice(dev);
+
+    std::printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures != 0;
+}